@@ -0,0 +1,182 @@
+#include "Report.h"
+#include <stdexcept>
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <cmath>
+
+// ================================================================================================
+// Escape a string for a quoted JSON or CSV field
+// ================================================================================================
+static std::string escape(const std::string& text, const char quote, const char prefix) {
+
+    std::string escaped;
+
+    for (const char character : text) {
+
+        if (character == quote || character == prefix) { escaped += prefix; }
+
+        escaped += character;
+
+    }
+
+    return escaped;
+
+}
+
+// ================================================================================================
+// Constructor
+// ================================================================================================
+Report::Report(
+    const std::string& format,
+    const std::string& path
+):
+    _format(format),
+    _path(path)
+{
+
+    if (_format != "text" && _format != "json" && _format != "csv") {
+
+        throw std::invalid_argument("Unknown report format!");
+
+    }
+
+}
+
+// ================================================================================================
+// Describe the conditions the results were measured under
+// ================================================================================================
+void Report::setContext(const std::string& key, const std::string& value) {
+
+    _context.emplace_back(key, value);
+
+    if (_format == "text") { std::cout << key << ": " << value << std::endl; }
+
+}
+
+// ================================================================================================
+// Add a result and print it right away, to the error stream when standard output gets the report
+// ================================================================================================
+void Report::add(const std::string& name, const std::string& parameters, const double value, const std::string& unit) {
+
+    _results.push_back({name, parameters, value, unit});
+
+    print(_format == "text" ? std::cout : std::cerr, _results.back());
+
+}
+
+// ================================================================================================
+// Write all results to the report file, or to standard output without one
+// ================================================================================================
+void Report::write() {
+
+    std::ofstream file;
+
+    if (!_path.empty()) {
+
+        file.open(_path);
+
+        if (!file) {
+
+            throw std::invalid_argument("Report file could not be opened!");
+
+        }
+
+    }
+
+    std::ostream& stream = _path.empty() ? std::cout : file;
+
+    // Text results were already printed while they were measured
+    if (_format == "text" && _path.empty()) { return; }
+
+    if (_format == "text") {
+
+        for (const auto& context : _context) {
+
+            stream << context.first << ": " << context.second << std::endl;
+
+        }
+
+        for (const auto& result : _results) {
+
+            print(stream, result);
+
+        }
+
+    }
+
+    if (_format == "json") { writeJSON(stream); }
+    if (_format == "csv") { writeCSV(stream); }
+
+}
+
+// ================================================================================================
+// Print a single result as a line of text
+// ================================================================================================
+void Report::print(std::ostream& stream, const Result& result) {
+
+    stream << result.name;
+
+    if (!result.parameters.empty()) { stream << " (" << result.parameters << ")"; }
+
+    stream << ": " << result.value;
+
+    if (!result.unit.empty()) { stream << " " << result.unit; }
+
+    stream << std::endl;
+
+}
+
+// ================================================================================================
+// Write the context and the results as a JSON document
+// ================================================================================================
+void Report::writeJSON(std::ostream& stream) {
+
+    stream << std::setprecision(10) << "{" << std::endl << "  \"context\": {";
+
+    for (std::size_t index = 0; index < _context.size(); index++) {
+
+        stream << (index == 0 ? "" : ",") << std::endl;
+        stream << "    \"" << escape(_context[index].first, '"', '\\') << "\": \"" << escape(_context[index].second, '"', '\\') << "\"";
+
+    }
+
+    stream << std::endl << "  }," << std::endl << "  \"benchmarks\": [";
+
+    for (std::size_t index = 0; index < _results.size(); index++) {
+
+        const Result& result = _results[index];
+
+        stream << (index == 0 ? "" : ",") << std::endl;
+        stream << "    {\"name\": \"" << escape(result.name, '"', '\\') << "\", ";
+        stream << "\"parameters\": \"" << escape(result.parameters, '"', '\\') << "\", ";
+
+        // JSON has no representation for infinities and NaN
+        if (std::isfinite(result.value)) { stream << "\"value\": " << result.value << ", "; }
+        else { stream << "\"value\": null, "; }
+
+        stream << "\"unit\": \"" << escape(result.unit, '"', '\\') << "\"}";
+
+    }
+
+    stream << std::endl << "  ]" << std::endl << "}" << std::endl;
+
+}
+
+// ================================================================================================
+// Write the results as CSV with a header row, every text field is quoted
+// ================================================================================================
+void Report::writeCSV(std::ostream& stream) {
+
+    stream << std::setprecision(10) << "name,parameters,value,unit" << std::endl;
+
+    for (const auto& result : _results) {
+
+        stream << "\"" << escape(result.name, '"', '"') << "\",";
+        stream << "\"" << escape(result.parameters, '"', '"') << "\",";
+        stream << result.value << ",";
+        stream << "\"" << escape(result.unit, '"', '"') << "\"" << std::endl;
+
+    }
+
+}
\ No newline at end of file
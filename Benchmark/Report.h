@@ -0,0 +1,47 @@
+#ifndef REPORT_H
+#define REPORT_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+#include <utility>
+#include <ostream>
+
+// Collects benchmark results and writes them as readable text or as JSON or CSV for comparisons
+// between commits
+class Report {
+
+    public:
+
+        Report(
+            const std::string& format,
+            const std::string& path
+        );
+
+        void setContext(const std::string& key, const std::string& value);
+        void add(const std::string& name, const std::string& parameters, const double value, const std::string& unit);
+        void write();
+
+    private:
+
+        struct Result {
+
+            std::string name;
+            std::string parameters;
+            double value;
+            std::string unit;
+
+        };
+
+        const std::string _format;
+        const std::string _path;
+        std::vector<std::pair<std::string, std::string>> _context;
+        std::vector<Result> _results;
+
+        void print(std::ostream& stream, const Result& result);
+        void writeJSON(std::ostream& stream);
+        void writeCSV(std::ostream& stream);
+
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,1036 @@
+#include "Network.h"
+#include "NetworkF32.h"
+#include "NetworkInt8.h"
+#include "NetworkMapped.h"
+#include "Dataset.h"
+#include "Trainer.h"
+#include "Evaluator.h"
+#include "RNG.h"
+#include "Kernels.h"
+#include "Report.h"
+#include "Checkpoint.h"
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <vector>
+#include <fstream>
+#include <string>
+#include <cstdio>
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <memory>
+#include <ctime>
+#include <thread>
+#include <limits>
+#include <tuple>
+#include <cmath>
+
+#define BENCHMARK_SAMPLES 1000
+#define BENCHMARK_SECONDS 2.0
+#define BENCHMARK_BATCH 32
+#define BENCHMARK_PARALLEL_BATCH 256
+#define BENCHMARK_EPOCHS 3
+#define BENCHMARK_NETWORK "benchmark.sn"
+#define BENCHMARK_LEGACY_NETWORK "benchmark_legacy.sn"
+#define BENCHMARK_CHECKPOINT "benchmark_checkpoint.sn"
+#define BENCHMARK_DATASET "benchmark.bin"
+#define BENCHMARK_LOADS 5
+#define BENCHMARK_SWEEP_WEIGHTS 10000000
+#define BENCHMARK_SWEEP_SAMPLES 16
+#define BENCHMARK_ALLOCATION_CALLS 100
+#define BENCHMARK_ACTIVATION_RATE 0.01
+#define BENCHMARK_ACTIVATION_ACCURACY 0.75
+#define BENCHMARK_ACTIVATION_EPOCHS 20
+#define BENCHMARK_SEED 1
+
+// Launch arguments, the report goes to standard output without an output file
+struct Arguments {
+
+    std::string format;
+    std::string output;
+    bool sweep;
+
+};
+
+// Every heap allocation of the benchmark goes through the counting operator new below
+static std::atomic<std::size_t> allocations(0);
+
+// ================================================================================================
+// Count a heap allocation
+// ================================================================================================
+void* operator new(const std::size_t size) {
+
+    allocations.fetch_add(1, std::memory_order_relaxed);
+
+    if (void* const pointer = std::malloc(size ? size : 1)) { return pointer; }
+
+    throw std::bad_alloc();
+
+}
+
+// ================================================================================================
+// Release a heap allocation
+// ================================================================================================
+void operator delete(void* const pointer) noexcept {
+
+    std::free(pointer);
+
+}
+
+// ================================================================================================
+// Release a heap allocation of a known size
+// ================================================================================================
+void operator delete(void* const pointer, const std::size_t) noexcept {
+
+    std::free(pointer);
+
+}
+
+// ================================================================================================
+// Create a set of random samples
+// ================================================================================================
+std::vector<std::vector<double>> getSamples(const std::size_t samples, const std::size_t points) {
+
+    std::vector<std::vector<double>> data(samples, std::vector<double>(points));
+
+    for (auto& values : data) {
+
+        for (auto& value : values) {
+
+            value = rng::range(0.0, 1.0);
+
+        }
+
+    }
+
+    return data;
+
+}
+
+// ================================================================================================
+// Create a set of one-hot targets that a random linear teacher assigns to the samples
+// ================================================================================================
+// The teacher sees every sample value minus an offset, an offset of 0.5 centres the random samples
+// so that the classes are about equally frequent
+std::vector<std::vector<double>> getTargets(const std::vector<std::vector<double>>& samples, const std::size_t points, const double offset) {
+
+    std::vector<std::vector<double>> teacher(points, std::vector<double>(samples.front().size()));
+    std::vector<std::vector<double>> data(samples.size(), std::vector<double>(points, 0.0));
+
+    for (auto& weights : teacher) {
+
+        for (auto& weight : weights) {
+
+            weight = rng::range(-1.0, 1.0);
+
+        }
+
+    }
+
+    for (std::size_t sample = 0; sample < samples.size(); sample++) {
+
+        std::size_t label = 0;
+        double maximum = 0.0;
+
+        for (std::size_t point = 0; point < points; point++) {
+
+            double value = 0.0;
+
+            for (std::size_t index = 0; index < samples[sample].size(); index++) {
+
+                value += teacher[point][index] * (samples[sample][index] - offset);
+
+            }
+
+            if (point == 0 || value > maximum) {
+
+                label = point;
+                maximum = value;
+
+            }
+
+        }
+
+        data[sample][label] = 1.0;
+
+    }
+
+    return data;
+
+}
+
+// ================================================================================================
+// Repeatedly run a function over all samples in steps and return the processed samples per second
+// ================================================================================================
+double measure(const std::size_t samples, const std::size_t step, const std::function<void(std::size_t)>& function) {
+
+    std::size_t processed = 0;
+
+    std::chrono::high_resolution_clock::time_point startTimestamp = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double> durationSeconds(0);
+
+    while (durationSeconds.count() < BENCHMARK_SECONDS) {
+
+        for (std::size_t sample = 0; sample < samples; sample += step) {
+
+            function(sample);
+
+        }
+
+        processed += samples;
+        durationSeconds = std::chrono::high_resolution_clock::now() - startTimestamp;
+
+    }
+
+    return processed / durationSeconds.count();
+
+}
+
+// ================================================================================================
+// Run a warmed up function repeatedly and report how many heap allocations it made per call
+// ================================================================================================
+bool measureAllocations(Report& report, const std::string& name, const std::function<void()>& function) {
+
+    function();
+
+    const std::size_t before = allocations.load();
+
+    for (std::size_t call = 0; call < BENCHMARK_ALLOCATION_CALLS; call++) {
+
+        function();
+
+    }
+
+    const double perCall = static_cast<double>(allocations.load() - before) / BENCHMARK_ALLOCATION_CALLS;
+
+    report.add("Allocations", name, perCall, "per call");
+
+    return perCall == 0.0;
+
+}
+
+// ================================================================================================
+// Get the name of a topology
+// ================================================================================================
+std::string getName(const std::vector<std::size_t>& topology) {
+
+    std::string name;
+
+    for (const std::size_t neurons : topology) {
+
+        name += (name.empty() ? "" : "-") + std::to_string(neurons);
+
+    }
+
+    return name;
+
+}
+
+// ================================================================================================
+// Run a function a few times and return its mean duration in milliseconds
+// ================================================================================================
+double measureTime(const std::function<void()>& function) {
+
+    std::chrono::high_resolution_clock::time_point startTimestamp = std::chrono::high_resolution_clock::now();
+
+    for (std::size_t iteration = 0; iteration < BENCHMARK_LOADS; iteration++) {
+
+        function();
+
+    }
+
+    std::chrono::duration<double, std::milli> durationMilliseconds = std::chrono::high_resolution_clock::now() - startTimestamp;
+
+    return durationMilliseconds.count() / BENCHMARK_LOADS;
+
+}
+
+// ================================================================================================
+// Save a network in the legacy and the mappable format and report the mean time of each saver
+// and loader
+// ================================================================================================
+void measureLoading(Report& report, Network& network, const std::string& name) {
+
+    const double legacySave = measureTime([&]() { std::ofstream file(BENCHMARK_LEGACY_NETWORK, std::ios::binary); network.saveLegacy(file); });
+    const double save = measureTime([&]() { std::ofstream file(BENCHMARK_NETWORK, std::ios::binary); network.save(file); });
+
+    const double legacyLoad = measureTime([]() { std::ifstream file(BENCHMARK_LEGACY_NETWORK, std::ios::binary); Network loaded(file, 0.1); });
+    const double load = measureTime([]() { std::ifstream file(BENCHMARK_NETWORK, std::ios::binary); Network loaded(file, 0.1); });
+    const double mappedLoad = measureTime([]() { NetworkMapped loaded(BENCHMARK_NETWORK); });
+
+    // Training only waits for the snapshot of a checkpoint, the write and sync to disk run in the background
+    Checkpoint checkpoint(&network, BENCHMARK_CHECKPOINT, 0, 0.0, 0);
+
+    // The first snapshot into each of the two buffers grows it, every later one reuses its memory
+    checkpoint.save(0, 0);
+    checkpoint.save(0, 0);
+    checkpoint.wait();
+
+    std::chrono::duration<double, std::milli> snapshot(0.0);
+
+    const double checkpointSave = measureTime([&]() {
+
+        const std::chrono::high_resolution_clock::time_point startTimestamp = std::chrono::high_resolution_clock::now();
+
+        checkpoint.save(0, 0);
+
+        snapshot += std::chrono::high_resolution_clock::now() - startTimestamp;
+
+        checkpoint.wait();
+
+    });
+
+    report.add("Save", name + ", legacy", legacySave, "ms");
+    report.add("Save", name + ", version 2", save, "ms");
+    report.add("Save", name + ", checkpoint snapshot", snapshot.count() / BENCHMARK_LOADS, "ms");
+    report.add("Save", name + ", checkpoint with sync", checkpointSave, "ms");
+    report.add("Load", name + ", legacy", legacyLoad, "ms");
+    report.add("Load", name + ", version 2", load, "ms");
+    report.add("Load", name + ", mapped", mappedLoad, "ms");
+
+    std::remove(BENCHMARK_LEGACY_NETWORK);
+    std::remove(BENCHMARK_CHECKPOINT);
+
+}
+
+// ================================================================================================
+// Check that a legacy network with a partially wired layer loads with the outputs it was saved with
+// ================================================================================================
+// Its second hidden neuron has no inputs, so the layer has to stay on the per-neuron path instead of
+// being read as a dense matrix with too few weights
+bool checkLegacyLoading() {
+
+    Network network(std::vector<std::size_t>{2}, 0.1);
+
+    network.createLayer(2);
+    network.createLayer(1);
+
+    network.getNeuron(2)->connect(network.getNeuron(0), 0.5);
+    network.getNeuron(2)->connect(network.getNeuron(1), -0.25);
+    network.getNeuron(4)->connect(network.getNeuron(2), 0.75);
+    network.getNeuron(4)->connect(network.getNeuron(3), -0.5);
+
+    std::ofstream outputFile(BENCHMARK_LEGACY_NETWORK, std::ios::binary);
+    network.saveLegacy(outputFile);
+    outputFile.close();
+
+    std::ifstream inputFile(BENCHMARK_LEGACY_NETWORK, std::ios::binary);
+    Network loaded(inputFile, 0.1);
+    inputFile.close();
+
+    std::remove(BENCHMARK_LEGACY_NETWORK);
+
+    const std::vector<double> inputs = {0.3, 0.7};
+
+    // The output layer does load as a dense matrix, whose kernels may round differently than the edges
+    const double expected = network.getOutputs(inputs).front();
+    const double output = loaded.getOutputs(inputs).front();
+
+    return !loaded.getLayer(1)->isDense() && std::abs(output - expected) < 1e-12;
+
+}
+
+// ================================================================================================
+// Check that vector outputs equal the scalar ones, or are within tolerance of them
+// ================================================================================================
+// Non-finite outputs have to match exactly, as a clamp or a reduction may otherwise hide them
+template <typename T>
+bool matchesScalar(const std::vector<T>& expected, const std::vector<T>& outputs, const double tolerance) {
+
+    for (std::size_t i = 0; i < expected.size(); i++) {
+
+        if (std::isnan(expected[i]) || std::isnan(outputs[i])) {
+
+            if (!std::isnan(expected[i]) || !std::isnan(outputs[i])) { return false; }
+
+        } else if (std::isinf(expected[i]) || std::isinf(outputs[i])) {
+
+            if (expected[i] != outputs[i]) { return false; }
+
+        } else if (std::abs(static_cast<double>(expected[i]) - static_cast<double>(outputs[i])) > tolerance) {
+
+            return false;
+
+        }
+
+    }
+
+    return true;
+
+}
+
+// ================================================================================================
+// Check that every available instruction set computes what the scalar kernels compute
+// ================================================================================================
+// Biases include NaN and infinities in rows at the start, middle and tail of the vector loops, so
+// every activation also sees them after the exponent clamp and inside the softmax sums
+bool checkKernels() {
+
+    const std::size_t rows = 37;
+    const std::size_t columns = 19;
+    const std::size_t samples = 5;
+
+    std::vector<double> weights(rows * columns);
+    std::vector<double> inputs(columns * samples);
+
+    // Values are not drawn from the seeded generator, so the measured samples stay the same
+    for (std::size_t i = 0; i < weights.size(); i++) { weights[i] = std::sin(i * 0.37); }
+    for (std::size_t i = 0; i < inputs.size(); i++) { inputs[i] = std::cos(i * 0.11); }
+
+    const std::vector<float> weightsF32(weights.begin(), weights.end());
+    const std::vector<float> inputsF32(inputs.begin(), inputs.begin() + columns);
+
+    const char* const instructionSet = kernels::getInstructionSet();
+    bool matches = true;
+
+    for (const double special : {std::numeric_limits<double>::quiet_NaN(), std::numeric_limits<double>::infinity(), -std::numeric_limits<double>::infinity()}) {
+
+        std::vector<double> biases(rows);
+
+        for (std::size_t i = 0; i < rows; i++) { biases[i] = std::sin(i * 1.3); }
+
+        biases[0] = special;
+        biases[rows / 2] = special;
+        biases[rows - 1] = special;
+
+        const std::vector<float> biasesF32(biases.begin(), biases.end());
+
+        for (std::size_t index = 0; index < activation::FUNCTION_COUNT; index++) {
+
+            const activation::Function function = static_cast<activation::Function>(index);
+
+            std::vector<double> expected(rows);
+            std::vector<double> expectedBatch(rows * samples);
+            std::vector<float> expectedF32(rows);
+
+            kernels::setInstructionSet("scalar");
+            kernels::infer(weights.data(), biases.data(), inputs.data(), expected.data(), rows, columns, function);
+            kernels::inferBatch(weights.data(), biases.data(), inputs.data(), expectedBatch.data(), samples, rows, columns, function);
+            kernels::infer(weightsF32.data(), biasesF32.data(), inputsF32.data(), expectedF32.data(), rows, columns, function);
+
+            for (const char* const name : {"sse2", "avx2", "avx512"}) {
+
+                if (!kernels::setInstructionSet(name)) { continue; }
+
+                std::vector<double> outputs(rows);
+                std::vector<double> outputsBatch(rows * samples);
+                std::vector<float> outputsF32(rows);
+
+                kernels::infer(weights.data(), biases.data(), inputs.data(), outputs.data(), rows, columns, function);
+                kernels::inferBatch(weights.data(), biases.data(), inputs.data(), outputsBatch.data(), samples, rows, columns, function);
+                kernels::infer(weightsF32.data(), biasesF32.data(), inputsF32.data(), outputsF32.data(), rows, columns, function);
+
+                matches = matches && matchesScalar(expected, outputs, 1e-12) && matchesScalar(expectedBatch, outputsBatch, 1e-12) && matchesScalar(expectedF32, outputsF32, 1e-5);
+
+            }
+
+        }
+
+    }
+
+    kernels::setInstructionSet(instructionSet);
+
+    return matches;
+
+}
+
+// ================================================================================================
+// Write samples as a dataset of doubles and as a dataset of scaled bytes and report how fast
+// each of them is opened and read back
+// ================================================================================================
+void measureDataset(Report& report, const std::size_t points) {
+
+    const std::vector<std::vector<double>> inputs = getSamples(BENCHMARK_SAMPLES, points);
+    const std::size_t entries = inputs.size();
+    const double scale = 1.0 / 255.0;
+
+    std::ofstream valueFile(BENCHMARK_DATASET, std::ios::binary);
+    valueFile.write(reinterpret_cast<const char*>(&entries), sizeof(entries));
+    valueFile.write(reinterpret_cast<const char*>(&points), sizeof(points));
+
+    for (const auto& values : inputs) {
+
+        valueFile.write(reinterpret_cast<const char*>(values.data()), values.size() * sizeof(double));
+
+    }
+
+    valueFile.close();
+
+    std::vector<double> samples(entries * points);
+
+    const double valueLoad = measureTime([&]() { Dataset dataset(BENCHMARK_DATASET); dataset.getSamples(0, dataset.getSize(), samples.data()); });
+
+    std::ofstream byteFile(BENCHMARK_DATASET, std::ios::binary);
+    byteFile.write("SNU8", 4);
+    byteFile.write(reinterpret_cast<const char*>(&entries), sizeof(entries));
+    byteFile.write(reinterpret_cast<const char*>(&points), sizeof(points));
+    byteFile.write(reinterpret_cast<const char*>(&scale), sizeof(scale));
+
+    for (const auto& values : inputs) {
+
+        for (const double value : values) {
+
+            byteFile.put(static_cast<char>(static_cast<std::uint8_t>(value * 255.0 + 0.5)));
+
+        }
+
+    }
+
+    byteFile.close();
+
+    const double byteLoad = measureTime([&]() { Dataset dataset(BENCHMARK_DATASET); dataset.getSamples(0, dataset.getSize(), samples.data()); });
+
+    report.add("Dataset load", std::to_string(points) + " points, double", entries * 1000.0 / valueLoad, "samples/s");
+    report.add("Dataset load", std::to_string(points) + " points, bytes", entries * 1000.0 / byteLoad, "samples/s");
+
+    std::remove(BENCHMARK_DATASET);
+
+}
+
+// ================================================================================================
+// Report the inference latency, the training and loss throughput and the file times of a topology
+// ================================================================================================
+void measureTopology(Report& report, const std::vector<std::size_t>& topology) {
+
+    const std::string name = getName(topology);
+
+    std::size_t weights = 0;
+
+    for (std::size_t layer = 1; layer < topology.size(); layer++) {
+
+        weights += topology[layer] * topology[layer - 1];
+
+    }
+
+    // Wide topologies run on fewer samples, so that a single pass over them stays short
+    const std::size_t samples = std::min<std::size_t>(BENCHMARK_SAMPLES, std::max<std::size_t>(BENCHMARK_SWEEP_SAMPLES, BENCHMARK_SWEEP_WEIGHTS / weights));
+
+    const std::vector<std::vector<double>> inputs = getSamples(samples, topology.front());
+    const std::vector<std::vector<double>> targets = getTargets(inputs, topology.back(), 0.0);
+
+    const double initialisation = measureTime([&]() { Network initialised(topology, 0.1); });
+
+    Network network(topology, 0.1);
+
+    const double inference = measure(inputs.size(), 1, [&](std::size_t sample) { network.getOutputs(inputs[sample]); });
+    const double training = measure(inputs.size(), 1, [&](std::size_t sample) { network.train(inputs[sample], targets[sample]); });
+    const double loss = measure(inputs.size(), 1, [&](std::size_t sample) { network.getLoss(inputs[sample], targets[sample]); });
+
+    report.add("Initialisation", name, initialisation, "ms");
+    report.add("Latency", name, 1000000.0 / inference, "us/sample");
+    report.add("Training", name, training, "samples/s");
+    report.add("Loss", name, loss, "samples/s");
+
+    measureLoading(report, network, name);
+
+}
+
+// ================================================================================================
+// Build a network out of individually connected neurons and report its construction, destruction
+// and epoch times
+// ================================================================================================
+void measureGraph(Report& report, const std::vector<std::vector<double>>& inputs, const std::vector<std::vector<double>>& targets) {
+
+    const std::size_t hidden = 128;
+    const std::size_t outputs = targets.front().size();
+
+    std::chrono::high_resolution_clock::time_point startTimestamp = std::chrono::high_resolution_clock::now();
+
+    std::unique_ptr<Network> network = std::make_unique<Network>(std::vector<std::size_t>{inputs.front().size()}, 0.1);
+
+    network->createLayer(hidden);
+    network->createLayer(outputs);
+
+    for (std::size_t layer = 1, first = 0; layer < network->getLayerCount(); layer++) {
+
+        const std::size_t sources = network->getLayer(layer - 1)->getNeuronCount();
+        const std::size_t neurons = network->getLayer(layer)->getNeuronCount();
+
+        for (std::size_t neuron = 0; neuron < neurons; neuron++) {
+
+            for (std::size_t source = 0; source < sources; source++) {
+
+                network->getNeuron(first + sources + neuron)->connect(network->getNeuron(first + source));
+
+            }
+
+        }
+
+        first += sources;
+
+    }
+
+    std::chrono::duration<double, std::milli> construction = std::chrono::high_resolution_clock::now() - startTimestamp;
+
+    startTimestamp = std::chrono::high_resolution_clock::now();
+
+    for (std::size_t sample = 0; sample < inputs.size(); sample++) {
+
+        network->train(inputs[sample], targets[sample]);
+
+    }
+
+    std::chrono::duration<double, std::milli> epoch = std::chrono::high_resolution_clock::now() - startTimestamp;
+
+    startTimestamp = std::chrono::high_resolution_clock::now();
+
+    network.reset();
+
+    std::chrono::duration<double, std::milli> destruction = std::chrono::high_resolution_clock::now() - startTimestamp;
+
+    const std::size_t edges = inputs.front().size() * hidden + hidden * outputs;
+
+    report.add("Graph construction", std::to_string(edges) + " edges", construction.count(), "ms");
+    report.add("Graph epoch", std::to_string(inputs.size()) + " samples", epoch.count(), "ms");
+    report.add("Graph destruction", std::to_string(edges) + " edges", destruction.count(), "ms");
+
+}
+
+// ================================================================================================
+// Prune copies of a network to increasing sparsity and report their inference throughput
+// ================================================================================================
+void measurePruning(Report& report, Network& network, const std::string& name, const std::vector<std::vector<double>>& inputs) {
+
+    std::ofstream file(BENCHMARK_NETWORK, std::ios::binary);
+    network.save(file);
+    file.close();
+
+    for (const double sparsity : {0.5, 0.7, 0.8, 0.9, 0.95, 0.98}) {
+
+        std::ifstream prunedFile(BENCHMARK_NETWORK, std::ios::binary);
+        Network prunedNetwork(prunedFile, 0.1);
+
+        prunedNetwork.prune(sparsity, false);
+
+        const double prunedInference = measure(inputs.size(), 1, [&](std::size_t sample) { prunedNetwork.getOutputs(inputs[sample]); });
+
+        report.add("Inference", name + ", sparsity " + std::to_string(sparsity).substr(0, 4), prunedInference, "samples/s");
+
+    }
+
+}
+
+// ================================================================================================
+// Train a fresh copy of the saved network for a few epochs and report throughput and final loss
+// ================================================================================================
+void converge(Report& report, const std::string& name, const std::vector<std::vector<double>>& inputs, const std::vector<std::vector<double>>& targets, const std::function<void(Network&)>& epoch) {
+
+    std::ifstream file(BENCHMARK_NETWORK, std::ios::binary);
+    Network network(file, 0.1);
+
+    std::chrono::high_resolution_clock::time_point startTimestamp = std::chrono::high_resolution_clock::now();
+
+    for (std::size_t iteration = 0; iteration < BENCHMARK_EPOCHS; iteration++) {
+
+        epoch(network);
+
+    }
+
+    std::chrono::duration<double> durationSeconds = std::chrono::high_resolution_clock::now() - startTimestamp;
+
+    double loss = 0.0;
+
+    for (std::size_t sample = 0; sample < inputs.size(); sample++) {
+
+        loss += network.getLoss(inputs[sample], targets[sample]);
+
+    }
+
+    report.add("Convergence", name, BENCHMARK_EPOCHS * inputs.size() / durationSeconds.count(), "samples/s");
+    report.add("Convergence loss", name, loss / inputs.size(), "");
+
+}
+
+// ================================================================================================
+// Measure the epochs and training time a network takes to reach a classification accuracy
+// ================================================================================================
+void measureAccuracy(
+    Report& report,
+    const std::string& name,
+    Network& network,
+    const std::vector<std::vector<double>>& inputs,
+    const std::vector<std::vector<double>>& targets,
+    const Dataset& inputData,
+    const Dataset& targetData
+) {
+
+    Evaluator evaluator(&network, 1, BENCHMARK_BATCH);
+
+    std::chrono::duration<double> duration(0.0);
+
+    double accuracy = 0.0;
+    double epochs = std::numeric_limits<double>::infinity();
+    double seconds = std::numeric_limits<double>::infinity();
+
+    for (std::size_t epoch = 1; epoch <= BENCHMARK_ACTIVATION_EPOCHS; epoch++) {
+
+        const std::chrono::high_resolution_clock::time_point startTimestamp = std::chrono::high_resolution_clock::now();
+
+        for (std::size_t sample = 0; sample < inputs.size(); sample++) {
+
+            network.train(inputs[sample], targets[sample]);
+
+        }
+
+        duration += std::chrono::high_resolution_clock::now() - startTimestamp;
+
+        const Evaluation evaluation = evaluator.evaluate(inputData, targetData);
+
+        accuracy = static_cast<double>(evaluation.correct) / evaluation.samples;
+
+        if (accuracy >= BENCHMARK_ACTIVATION_ACCURACY) {
+
+            epochs = epoch;
+            seconds = duration.count();
+            break;
+
+        }
+
+    }
+
+    report.add("Epochs to accuracy", name, epochs, "epochs");
+    report.add("Time to accuracy", name, seconds, "s");
+    report.add("Training accuracy", name, accuracy * 100.0, "%");
+
+}
+
+// ================================================================================================
+// Report the inference throughput of every activation function and how fast each one learns
+// ================================================================================================
+// Every network trains one sample at a time on balanced classes until it classifies a share of
+// its training samples correctly, networks that never get there report an infinite time
+void measureActivations(Report& report, const std::vector<std::size_t>& topology) {
+
+    const std::string topologyName = getName(topology);
+
+    const std::vector<std::vector<double>> inputs = getSamples(BENCHMARK_SAMPLES, topology.front());
+    const std::vector<std::vector<double>> targets = getTargets(inputs, topology.back(), 0.5);
+    const Dataset inputData(inputs);
+    const Dataset targetData(targets);
+
+    const std::vector<std::tuple<std::string, std::vector<activation::Function>, loss::Function>> configurations = {
+        {"sigmoid", {activation::SIGMOID, activation::SIGMOID, activation::SIGMOID}, loss::SQUARED_ERROR},
+        {"relu", {activation::RELU, activation::RELU, activation::SIGMOID}, loss::SQUARED_ERROR},
+        {"leaky-relu", {activation::LEAKY_RELU, activation::LEAKY_RELU, activation::SIGMOID}, loss::SQUARED_ERROR},
+        {"tanh", {activation::TANH, activation::TANH, activation::SIGMOID}, loss::SQUARED_ERROR},
+        {"relu, softmax", {activation::RELU, activation::RELU, activation::SOFTMAX}, loss::SQUARED_ERROR},
+        {"tanh, softmax", {activation::TANH, activation::TANH, activation::SOFTMAX}, loss::SQUARED_ERROR},
+        {"sigmoid, cross-entropy", {activation::SIGMOID, activation::SIGMOID, activation::SIGMOID}, loss::CROSS_ENTROPY},
+        {"relu, softmax, cross-entropy", {activation::RELU, activation::RELU, activation::SOFTMAX}, loss::CROSS_ENTROPY},
+        {"tanh, softmax, cross-entropy", {activation::TANH, activation::TANH, activation::SOFTMAX}, loss::CROSS_ENTROPY}
+    };
+
+    for (const auto& [name, activations, objective] : configurations) {
+
+        Network network(topology, activations, BENCHMARK_ACTIVATION_RATE);
+
+        network.setLossFunction(objective);
+
+        // The loss function only changes training, so inference is measured once per set of activations
+        if (objective == loss::SQUARED_ERROR) {
+
+            const double inference = measure(inputs.size(), 1, [&](std::size_t sample) { network.getOutputs(inputs[sample]); });
+
+            report.add("Inference", topologyName + ", " + name + ", " + kernels::getInstructionSet(), inference, "samples/s");
+
+        }
+
+        measureAccuracy(report, name, network, inputs, targets, inputData, targetData);
+
+    }
+
+}
+
+// ================================================================================================
+// Measure how quickly every optimizer trains a network to an accuracy
+// ================================================================================================
+// Every optimizer gets the largest rate of a 3x grid that still converged on this data
+void measureOptimizers(Report& report, const std::vector<std::size_t>& topology) {
+
+    const std::vector<std::vector<double>> inputs = getSamples(BENCHMARK_SAMPLES, topology.front());
+    const std::vector<std::vector<double>> targets = getTargets(inputs, topology.back(), 0.5);
+    const Dataset inputData(inputs);
+    const Dataset targetData(targets);
+
+    const std::vector<std::tuple<std::string, optimizer::Method, double>> configurations = {
+        {"sgd", optimizer::SGD, 0.01},
+        {"momentum", optimizer::MOMENTUM, 0.001},
+        {"nesterov", optimizer::NESTEROV, 0.001},
+        {"adam", optimizer::ADAM, 0.0003}
+    };
+
+    for (const auto& [name, method, rate] : configurations) {
+
+        Network network(topology, {activation::TANH, activation::TANH, activation::SOFTMAX}, rate);
+
+        network.setLossFunction(loss::CROSS_ENTROPY);
+        network.setOptimizer(optimizer::getSettings(method));
+
+        measureAccuracy(report, "tanh, softmax, cross-entropy, " + name, network, inputs, targets, inputData, targetData);
+
+        // Throughput is measured after the accuracy, so training it further does not skew the epochs
+        const double training = measure(inputs.size(), 1, [&](std::size_t sample) { network.train(inputs[sample], targets[sample]); });
+
+        const double batchTraining = measure(inputs.size(), BENCHMARK_BATCH, [&](std::size_t sample) { network.trainBatch(inputData, targetData, sample, BENCHMARK_BATCH); });
+
+        report.add("Training", getName(topology) + ", " + name, training, "samples/s");
+        report.add("Training", getName(topology) + ", batch " + std::to_string(BENCHMARK_BATCH) + ", " + name, batchTraining, "samples/s");
+
+    }
+
+}
+
+// ================================================================================================
+// Get launch arguments
+// ================================================================================================
+Arguments getArguments(int argc, char* argv[]) {
+
+    Arguments arguments = {"text", "", false};
+
+    for (int i = 1; i < argc; i++) {
+
+        std::string argument = argv[i];
+
+        if (argument == "--format") { arguments.format = argv[++i]; }
+        if (argument == "--output") { arguments.output = argv[++i]; }
+        if (argument == "--sweep") { arguments.sweep = true; }
+
+    }
+
+    return arguments;
+
+}
+
+// ================================================================================================
+// Main
+// ================================================================================================
+int main(int argc, char* argv[]) {
+
+    const Arguments arguments = getArguments(argc, argv);
+
+    Report report(arguments.format, arguments.output);
+
+    // Every run measures the same samples and initial weights, so epochs to an accuracy can be compared
+    rng::setSeed(BENCHMARK_SEED);
+
+    const std::time_t now = std::time(nullptr);
+    char date[32];
+
+    std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", std::localtime(&now));
+
+    report.setContext("date", date);
+    report.setContext("instruction set", kernels::getInstructionSet());
+    report.setContext("hardware threads", std::to_string(std::thread::hardware_concurrency()));
+    report.setContext("seconds per measurement", std::to_string(BENCHMARK_SECONDS));
+    report.setContext("seed", std::to_string(BENCHMARK_SEED));
+
+    if (!checkLegacyLoading()) {
+
+        std::cerr << "A partially wired legacy network did not load as it was saved!" << std::endl;
+        return 1;
+
+    }
+
+    if (!checkKernels()) {
+
+        std::cerr << "Vector kernels do not match the scalar kernels!" << std::endl;
+        return 1;
+
+    }
+
+    // From a network as small as XOR up to layers that no longer fit into the caches
+    for (const auto& sweep : std::vector<std::vector<std::size_t>>{{2, 2, 1}, {784, 128, 64, 10}, {784, 512, 512, 10}, {784, 1024, 1024, 10}, {784, 4096, 4096, 10}}) {
+
+        measureTopology(report, sweep);
+
+    }
+
+    measureDataset(report, 2);
+    measureDataset(report, 784);
+
+    if (arguments.sweep) {
+
+        std::remove(BENCHMARK_NETWORK);
+        report.write();
+        return 0;
+
+    }
+
+    const std::vector<std::size_t> topology = {784, 128, 64, 10};
+    const std::string topologyName = getName(topology);
+
+    const std::vector<std::vector<double>> inputs = getSamples(BENCHMARK_SAMPLES, topology.front());
+    const std::vector<std::vector<double>> targets = getTargets(inputs, topology.back(), 0.0);
+    const Dataset inputData(inputs);
+    const Dataset targetData(targets);
+
+    Network network(topology, 0.1);
+
+    const char* const instructionSet = kernels::getInstructionSet();
+
+    for (const char* const name : {"scalar", "sse2", "avx2", "avx512"}) {
+
+        if (!kernels::setInstructionSet(name)) { continue; }
+
+        const double vectorInference = measure(inputs.size(), 1, [&](std::size_t sample) { network.getOutputs(inputs[sample]); });
+
+        report.add("Inference", topologyName + ", " + name, vectorInference, "samples/s");
+
+    }
+
+    kernels::setInstructionSet(instructionSet);
+
+    std::vector<double> batchInputs(inputs.size() * topology.front());
+    std::vector<double> batchOutputs(BENCHMARK_BATCH * topology.back());
+
+    inputData.getSamples(0, inputs.size(), batchInputs.data());
+
+    const double batchInference = measure(inputs.size(), BENCHMARK_BATCH, [&](std::size_t sample) {
+
+        network.predictBatch(batchInputs.data() + sample * topology.front(), std::min<std::size_t>(BENCHMARK_BATCH, inputs.size() - sample), batchOutputs.data());
+
+    });
+    const double batchTraining = measure(inputs.size(), BENCHMARK_BATCH, [&](std::size_t sample) { network.trainBatch(inputData, targetData, sample, BENCHMARK_BATCH); });
+
+    report.add("Inference", topologyName + ", batch " + std::to_string(BENCHMARK_BATCH) + ", " + instructionSet, batchInference, "samples/s");
+    report.add("Training", topologyName + ", batch " + std::to_string(BENCHMARK_BATCH), batchTraining, "samples/s");
+
+    measurePruning(report, network, topologyName, inputs);
+
+    NetworkF32 singlePrecisionNetwork(&network);
+
+    std::vector<std::vector<float>> singlePrecisionInputs;
+    std::vector<std::vector<float>> singlePrecisionTargets;
+
+    for (std::size_t sample = 0; sample < inputs.size(); sample++) {
+
+        singlePrecisionInputs.emplace_back(inputs[sample].begin(), inputs[sample].end());
+        singlePrecisionTargets.emplace_back(targets[sample].begin(), targets[sample].end());
+
+    }
+
+    const double singlePrecisionInference = measure(inputs.size(), 1, [&](std::size_t sample) { singlePrecisionNetwork.getOutputs(singlePrecisionInputs[sample]); });
+    const double singlePrecisionTraining = measure(inputs.size(), 1, [&](std::size_t sample) { singlePrecisionNetwork.train(singlePrecisionInputs[sample], singlePrecisionTargets[sample]); });
+
+    NetworkInt8 quantizedNetwork(&network, inputData, inputData.getSize());
+
+    const double quantizedInference = measure(inputs.size(), 1, [&](std::size_t sample) { quantizedNetwork.getOutputs(singlePrecisionInputs[sample]); });
+
+    report.add("Inference", topologyName + ", float, " + instructionSet, singlePrecisionInference, "samples/s");
+    report.add("Inference", topologyName + ", int8, " + instructionSet, quantizedInference, "samples/s");
+    report.add("Training", topologyName + ", float", singlePrecisionTraining, "samples/s");
+
+    // Steady state inference and training reuse the buffers of the networks and trainers
+    Trainer allocationTrainer(&network, 2);
+    NetworkMapped mappedNetwork(BENCHMARK_NETWORK);
+    Network prunedNetwork(topology, 0.1);
+    Network softmaxNetwork(topology, {activation::RELU, activation::RELU, activation::SOFTMAX}, 0.1);
+
+    prunedNetwork.prune(0.9, false);
+
+    bool allocationFree = true;
+
+    allocationFree = measureAllocations(report, "inference", [&]() { network.getOutputs(inputs[0]); }) && allocationFree;
+    allocationFree = measureAllocations(report, "loss", [&]() { network.getLoss(inputs[0], targets[0]); }) && allocationFree;
+    allocationFree = measureAllocations(report, "training", [&]() { network.train(inputs[0], targets[0]); }) && allocationFree;
+    allocationFree = measureAllocations(report, "batch inference", [&]() { network.predictBatch(batchInputs.data(), BENCHMARK_BATCH, batchOutputs.data()); }) && allocationFree;
+    allocationFree = measureAllocations(report, "batch training", [&]() { network.trainBatch(inputData, targetData, 0, BENCHMARK_BATCH); }) && allocationFree;
+    allocationFree = measureAllocations(report, "parallel training", [&]() { allocationTrainer.train(inputData, targetData, 0, BENCHMARK_BATCH); }) && allocationFree;
+    allocationFree = measureAllocations(report, "async training", [&]() { allocationTrainer.trainAsync(inputData, targetData, 0, BENCHMARK_BATCH); }) && allocationFree;
+    allocationFree = measureAllocations(report, "pruned inference", [&]() { prunedNetwork.getOutputs(inputs[0]); }) && allocationFree;
+    allocationFree = measureAllocations(report, "pruned training", [&]() { prunedNetwork.train(inputs[0], targets[0]); }) && allocationFree;
+    allocationFree = measureAllocations(report, "softmax inference", [&]() { softmaxNetwork.getOutputs(inputs[0]); }) && allocationFree;
+    allocationFree = measureAllocations(report, "softmax batch training", [&]() { softmaxNetwork.trainBatch(inputData, targetData, 0, BENCHMARK_BATCH); }) && allocationFree;
+
+    softmaxNetwork.setLossFunction(loss::CROSS_ENTROPY);
+
+    allocationFree = measureAllocations(report, "cross-entropy training", [&]() { softmaxNetwork.train(inputs[0], targets[0]); }) && allocationFree;
+    allocationFree = measureAllocations(report, "cross-entropy batch training", [&]() { softmaxNetwork.trainBatch(inputData, targetData, 0, BENCHMARK_BATCH); }) && allocationFree;
+
+    Network adamNetwork(topology, 0.001);
+
+    adamNetwork.setOptimizer(optimizer::getSettings(optimizer::ADAM));
+
+    Trainer adamTrainer(&adamNetwork, 2);
+
+    allocationFree = measureAllocations(report, "adam training", [&]() { adamNetwork.train(inputs[0], targets[0]); }) && allocationFree;
+    allocationFree = measureAllocations(report, "adam batch training", [&]() { adamNetwork.trainBatch(inputData, targetData, 0, BENCHMARK_BATCH); }) && allocationFree;
+    allocationFree = measureAllocations(report, "adam parallel training", [&]() { adamTrainer.train(inputData, targetData, 0, BENCHMARK_BATCH); }) && allocationFree;
+
+    allocationFree = measureAllocations(report, "mapped inference", [&]() { mappedNetwork.getOutputs(inputs[0]); }) && allocationFree;
+    allocationFree = measureAllocations(report, "float inference", [&]() { singlePrecisionNetwork.getOutputs(singlePrecisionInputs[0]); }) && allocationFree;
+    allocationFree = measureAllocations(report, "float training", [&]() { singlePrecisionNetwork.train(singlePrecisionInputs[0], singlePrecisionTargets[0]); }) && allocationFree;
+    allocationFree = measureAllocations(report, "int8 inference", [&]() { quantizedNetwork.getOutputs(singlePrecisionInputs[0]); }) && allocationFree;
+
+    for (std::size_t threads : {1, 2, 4, 8, 16}) {
+
+        Trainer trainer(&network, threads);
+
+        const double parallelTraining = measure(inputs.size(), BENCHMARK_PARALLEL_BATCH, [&](std::size_t sample) { trainer.train(inputData, targetData, sample, BENCHMARK_PARALLEL_BATCH); });
+
+        report.add("Training", topologyName + ", batch " + std::to_string(BENCHMARK_PARALLEL_BATCH) + ", " + std::to_string(threads) + " threads", parallelTraining, "samples/s");
+
+    }
+
+    // Serial evaluation is the per-sample loss the test loop used before the evaluator
+    const double serialEvaluation = measure(inputs.size(), 1, [&](std::size_t sample) { network.getLoss(inputs[sample], targets[sample]); });
+
+    report.add("Evaluation", topologyName + ", serial", serialEvaluation, "samples/s");
+
+    for (std::size_t threads : {1, 2, 4, 8, 16}) {
+
+        Evaluator evaluator(&network, threads, BENCHMARK_BATCH);
+
+        const double evaluation = measure(inputs.size(), inputs.size(), [&](std::size_t) { evaluator.evaluate(inputData, targetData); });
+
+        report.add("Evaluation", topologyName + ", batch " + std::to_string(BENCHMARK_BATCH) + ", " + std::to_string(threads) + " threads", evaluation, "samples/s");
+
+    }
+
+    measureGraph(report, inputs, targets);
+    measureActivations(report, topology);
+    measureOptimizers(report, topology);
+
+    std::ofstream file(BENCHMARK_NETWORK, std::ios::binary);
+    Network(topology, 0.1).save(file);
+    file.close();
+
+    converge(report, "serial", inputs, targets, [&](Network& network) {
+
+        for (std::size_t sample = 0; sample < inputs.size(); sample++) {
+
+            network.train(inputs[sample], targets[sample]);
+
+        }
+
+    });
+
+    for (std::size_t threads : {1, 2, 4, 8}) {
+
+        converge(report, "async, " + std::to_string(threads) + " threads", inputs, targets, [&](Network& network) {
+
+            Trainer trainer(&network, threads);
+            trainer.trainAsync(inputData, targetData, 0, inputData.getSize());
+
+        });
+
+    }
+
+    std::remove(BENCHMARK_NETWORK);
+
+    report.write();
+
+    if (!allocationFree) {
+
+        std::cerr << "Steady state inference or training allocated memory!" << std::endl;
+        return 1;
+
+    }
+
+    return 0;
+
+}
\ No newline at end of file
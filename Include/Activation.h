@@ -0,0 +1,86 @@
+#ifndef ACTIVATION_H
+#define ACTIVATION_H
+
+#include <cstddef>
+#include <cmath>
+#include <string>
+
+namespace activation {
+
+    // Values are stored in network files, so new functions can only be added at the end
+    enum Function {
+
+        SIGMOID,
+        RELU,
+        LEAKY_RELU,
+        TANH,
+        SOFTMAX,
+        FUNCTION_COUNT
+
+    };
+
+    // Slope of the leaky ReLU for negative inputs
+    constexpr double LEAKY_SLOPE = 0.01;
+
+    const char* getName(const Function function);
+    Function getFunction(const std::string& name);
+
+    // Apply an elementwise function, softmax depends on every output of a layer and has its own kernels
+    template <Function F, typename T>
+    inline T apply(const T x) {
+
+        static_assert(F != SOFTMAX, "Softmax is not an elementwise function");
+
+        if constexpr (F == SIGMOID) { return T(1) / (T(1) + std::exp(-x)); }
+        else if constexpr (F == RELU) { return x > T(0) ? x : T(0); }
+        else if constexpr (F == LEAKY_RELU) { return x > T(0) ? x : T(LEAKY_SLOPE) * x; }
+        else { return std::tanh(x); }
+
+    }
+
+    // Get the derivative of an elementwise function from its output, which is all training keeps
+    template <Function F, typename T>
+    inline T derivative(const T y) {
+
+        static_assert(F != SOFTMAX, "Softmax is not an elementwise function");
+
+        if constexpr (F == SIGMOID) { return y * (T(1) - y); }
+        else if constexpr (F == RELU) { return y > T(0) ? T(1) : T(0); }
+        else if constexpr (F == LEAKY_RELU) { return y > T(0) ? T(1) : T(LEAKY_SLOPE); }
+        else { return T(1) - y * y; }
+
+    }
+
+    // Apply an elementwise function chosen at runtime to a single value, for the neuron by neuron paths
+    template <typename T>
+    inline T apply(const Function function, const T x) {
+
+        switch (function) {
+
+            case RELU: return apply<RELU>(x);
+            case LEAKY_RELU: return apply<LEAKY_RELU>(x);
+            case TANH: return apply<TANH>(x);
+            default: return apply<SIGMOID>(x);
+
+        }
+
+    }
+
+    // Get the derivative of an elementwise function chosen at runtime from its output
+    template <typename T>
+    inline T derivative(const Function function, const T y) {
+
+        switch (function) {
+
+            case RELU: return derivative<RELU>(y);
+            case LEAKY_RELU: return derivative<LEAKY_RELU>(y);
+            case TANH: return derivative<TANH>(y);
+            default: return derivative<SIGMOID>(y);
+
+        }
+
+    }
+
+};
+
+#endif
\ No newline at end of file
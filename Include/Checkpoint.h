@@ -0,0 +1,57 @@
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <future>
+#include <chrono>
+#include "NetworkFormat.h"
+
+class Network;
+
+// Saves a network with its training progress every number of samples or seconds, snapshotting it into one of
+// two buffers while a background thread writes the other to a temporary file that then replaces the network
+// file, so training does not wait for the disk and a crash never leaves a partly written network behind
+class Checkpoint {
+
+    public:
+
+        Checkpoint(
+            Network* const network,
+            const std::string& path,
+            const std::size_t samples,
+            const double interval,
+            const std::uint64_t seed
+        );
+
+        ~Checkpoint();
+
+        void update(const std::size_t iteration, const std::size_t sample);
+        void save(const std::size_t iteration, const std::size_t sample);
+        void wait();
+
+        static bool getProgress(std::ifstream& file, format::ProgressEntry& progress);
+        static void replace(Network* const network, const std::string& path);
+
+    private:
+
+        Network* const _network;
+        const std::string _path;
+        const std::size_t _samples;
+        const double _interval;
+        const std::uint64_t _seed;
+        std::chrono::steady_clock::time_point _saved;
+        std::size_t _savedSamples;
+        std::vector<char> _buffers[2];
+        std::size_t _buffer;
+        std::future<void> _writing;
+
+        void write(const std::size_t buffer);
+
+        static void replace(const std::string& path, const std::vector<char>& data);
+
+};
+
+#endif
\ No newline at end of file
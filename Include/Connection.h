@@ -19,7 +19,8 @@ class Connection {
         Connection(
             Network* const network,
             Neuron* const source,
-            std::ifstream& file
+            Neuron* const target,
+            const double weight
         );
 
         Neuron* getSource();
@@ -0,0 +1,55 @@
+#ifndef DATASET_H
+#define DATASET_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class Dataset {
+
+    public:
+
+        explicit Dataset(
+            const std::string& path
+        );
+
+        explicit Dataset(
+            const std::vector<std::vector<double>>& data
+        );
+
+        Dataset(
+            std::vector<double>&& values,
+            const std::size_t points
+        );
+
+        ~Dataset();
+
+        Dataset(const Dataset&) = delete;
+        Dataset& operator=(const Dataset&) = delete;
+
+        std::size_t getSize() const;
+        std::size_t getPoints() const;
+        const double* getData(const std::size_t index) const;
+        void getSample(const std::size_t index, double* const destination) const;
+        void getSamples(const std::size_t first, const std::size_t count, double* const destination) const;
+        void release(const std::size_t first, const std::size_t count) const;
+
+    private:
+
+        void* _mapping;
+        std::size_t _length;
+        std::vector<double> _storage;
+        const double* _data;
+        const std::uint8_t* _bytes;
+        double _scale;
+        bool _labels;
+        std::size_t _entries;
+        std::size_t _points;
+
+        void map(const std::size_t header);
+        void readSample(const std::size_t index, double* const destination) const;
+
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,62 @@
+#ifndef DATASET_STREAM_H
+#define DATASET_STREAM_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <memory>
+#include <future>
+#include "Dataset.h"
+
+class DatasetStream {
+
+    public:
+
+        DatasetStream(
+            const Dataset& inputs,
+            const Dataset& targets,
+            const std::size_t chunkSize,
+            const bool shuffle,
+            const std::uint64_t seed
+        );
+
+        ~DatasetStream();
+
+        std::size_t getSize();
+        std::size_t getChunkCount();
+        void reset(const std::uint64_t epoch, const std::size_t sample);
+        bool next();
+        std::size_t getOffset();
+        const Dataset& getInputs();
+        const Dataset& getTargets();
+
+    private:
+
+        struct Chunk {
+
+            std::unique_ptr<Dataset> inputs;
+            std::unique_ptr<Dataset> targets;
+
+        };
+
+        const Dataset& _inputs;
+        const Dataset& _targets;
+        const std::size_t _chunkSize;
+        const bool _shuffle;
+        const std::uint64_t _seed;
+        std::uint64_t _epoch;
+        std::vector<std::size_t> _order;
+        std::size_t _position;
+        std::size_t _skip;
+        std::size_t _offset;
+        bool _started;
+        Chunk _current;
+        std::future<Chunk> _next;
+
+        void prefetch();
+        std::size_t getChunkSize(const std::size_t chunk);
+        Chunk load(const std::uint64_t epoch, const std::size_t chunk);
+
+};
+
+#endif
\ No newline at end of file
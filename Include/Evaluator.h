@@ -0,0 +1,84 @@
+#ifndef EVALUATOR_H
+#define EVALUATOR_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "ThreadPool.h"
+#include "Dataset.h"
+#include "Activation.h"
+#include "Loss.h"
+
+class Network;
+class NetworkMapped;
+
+// The loss and argmax accuracy of a network over a dataset, with a confusion matrix whose rows are
+// the target classes and whose columns are the predicted classes
+struct Evaluation {
+
+    std::size_t samples;
+    std::size_t correct;
+    double loss;
+    std::vector<std::size_t> confusion;
+
+};
+
+class Evaluator {
+
+    public:
+
+        Evaluator(
+            Network* const network,
+            const std::size_t threads,
+            const std::size_t batchSize
+        );
+
+        Evaluator(
+            NetworkMapped* const network,
+            const loss::Function objective,
+            const std::size_t threads,
+            const std::size_t batchSize
+        );
+
+        static bool isSupported(Network* const network);
+        Evaluation evaluate(const Dataset& inputs, const Dataset& targets);
+        std::size_t getThreadCount();
+
+    private:
+
+        // The weights of a layer as the kernels read them, rows and columns are only set for pruned layers
+        struct View {
+
+            const double* weights;
+            const double* biases;
+            const std::uint64_t* rows;
+            const std::uint32_t* columns;
+            std::size_t neurons;
+            activation::Function activation;
+
+        };
+
+        struct Worker {
+
+            std::vector<std::vector<double>> activations;
+            std::vector<double> targets;
+            Evaluation evaluation;
+
+        };
+
+        Network* const _network;
+        NetworkMapped* const _mapped;
+        loss::Function _objective;
+        const std::size_t _batchSize;
+        ThreadPool _pool;
+        std::vector<Worker> _workers;
+        std::vector<View> _layers;
+
+        void setLayers();
+        void allocate();
+        void evaluateRange(Worker& worker, const Dataset& inputs, const Dataset& targets, const std::size_t first, const std::size_t last);
+        void evaluateBatch(Worker& worker, const Dataset& inputs, const Dataset& targets, const std::size_t offset, const std::size_t samples);
+
+};
+
+#endif
\ No newline at end of file
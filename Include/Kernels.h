@@ -0,0 +1,230 @@
+#ifndef KERNELS_H
+#define KERNELS_H
+
+#include "Activation.h"
+#include "Loss.h"
+#include "Optimizer.h"
+#include <cstddef>
+#include <cmath>
+#include <cstdint>
+
+namespace kernels {
+
+    template <typename T>
+    void activate(
+        T* const values,
+        const std::size_t rows,
+        const activation::Function function
+    );
+
+    template <typename T>
+    void forward(
+        const T* const weights,
+        const T* const biases,
+        const T* const inputs,
+        T* const outputs,
+        const std::size_t rows,
+        const std::size_t columns,
+        const activation::Function function
+    );
+
+    void forward(
+        const std::int8_t* const weights,
+        const float* const scales,
+        const float* const biases,
+        const std::int8_t* const inputs,
+        float* const outputs,
+        const std::size_t rows,
+        const std::size_t columns
+    );
+
+    void infer(
+        const double* const weights,
+        const double* const biases,
+        const double* const inputs,
+        double* const outputs,
+        const std::size_t rows,
+        const std::size_t columns,
+        const activation::Function function
+    );
+
+    void infer(
+        const float* const weights,
+        const float* const biases,
+        const float* const inputs,
+        float* const outputs,
+        const std::size_t rows,
+        const std::size_t columns,
+        const activation::Function function
+    );
+
+    void infer(
+        const std::int8_t* const weights,
+        const float* const scales,
+        const float* const biases,
+        const std::int8_t* const inputs,
+        float* const outputs,
+        const std::size_t rows,
+        const std::size_t columns
+    );
+
+    void inferBatch(
+        const double* const weights,
+        const double* const biases,
+        const double* const inputs,
+        double* const outputs,
+        const std::size_t samples,
+        const std::size_t rows,
+        const std::size_t columns,
+        const activation::Function function
+    );
+
+    void forwardSparse(
+        const std::uint64_t* const offsets,
+        const std::uint32_t* const indices,
+        const double* const values,
+        const double* const biases,
+        const double* const inputs,
+        double* const outputs,
+        const std::size_t rows,
+        const activation::Function function
+    );
+
+    void inferSparse(
+        const std::uint64_t* const offsets,
+        const std::uint32_t* const indices,
+        const double* const values,
+        const double* const biases,
+        const double* const inputs,
+        double* const outputs,
+        const std::size_t rows,
+        const activation::Function function
+    );
+
+    const char* getInstructionSet();
+    bool setInstructionSet(const char* const name);
+
+    template <typename T>
+    T error(
+        const T* const outputs,
+        const T* const targets,
+        T* const deltas,
+        const std::size_t rows,
+        const activation::Function function,
+        const loss::Function objective
+    );
+
+    template <typename T>
+    void backward(
+        T* const weights,
+        const T* const inputs,
+        const T* const deltas,
+        T* const inputDeltas,
+        const std::size_t rows,
+        const std::size_t columns,
+        const T rate
+    );
+
+    void backwardSparse(
+        const std::uint64_t* const offsets,
+        const std::uint32_t* const indices,
+        double* const values,
+        const double* const inputs,
+        const double* const deltas,
+        double* const inputDeltas,
+        const std::size_t rows,
+        const double rate
+    );
+
+    template <typename T>
+    void derivative(
+        const T* const activations,
+        T* const deltas,
+        const std::size_t rows,
+        const activation::Function function
+    );
+
+    template <typename T>
+    void update(
+        T* const biases,
+        const T* const deltas,
+        const std::size_t rows,
+        const T rate
+    );
+
+    void forwardBatch(
+        const double* const weights,
+        const double* const biases,
+        const double* const inputs,
+        double* const outputs,
+        const std::size_t samples,
+        const std::size_t rows,
+        const std::size_t columns,
+        const activation::Function function
+    );
+
+    void backwardBatch(
+        const double* const weights,
+        const double* const deltas,
+        double* const inputDeltas,
+        const std::size_t samples,
+        const std::size_t rows,
+        const std::size_t columns
+    );
+
+    void accumulateBatch(
+        double* const weights,
+        const double* const inputs,
+        const double* const deltas,
+        const std::size_t samples,
+        const std::size_t rows,
+        const std::size_t columns,
+        const double rate
+    );
+
+    void updateBatch(
+        double* const biases,
+        const double* const deltas,
+        const std::size_t samples,
+        const std::size_t rows,
+        const double rate
+    );
+
+    void optimize(
+        double* const parameters,
+        const double* const gradients,
+        double* const state,
+        const std::size_t stride,
+        const std::size_t count,
+        const double scale,
+        const optimizer::Step& step
+    );
+
+    void optimizeOuter(
+        double* const weights,
+        const double* const inputs,
+        const double* const deltas,
+        double* const state,
+        const std::size_t rows,
+        const std::size_t columns,
+        const optimizer::Step& step
+    );
+
+    template <typename T>
+    T loss(
+        const T* const outputs,
+        const T* const targets,
+        const std::size_t rows,
+        const activation::Function function,
+        const loss::Function objective
+    );
+
+    double dot(
+        const double* const left,
+        const double* const right,
+        const std::size_t rows
+    );
+
+};
+
+#endif
\ No newline at end of file
@@ -2,14 +2,20 @@
 #define LAYER_H
 
 #include <cstddef>
+#include <cstdint>
 #include <vector>
 #include "Neuron.h"
+#include "Dataset.h"
+#include "NetworkFormat.h"
+#include "Activation.h"
 #include <fstream>
 
 class Network;
 
 class Layer {
 
+    friend class Neuron;
+
     public:
 
         Layer(
@@ -19,22 +25,75 @@ class Layer {
 
         Layer(
             Network* const network,
+            Layer* const layer,
             std::ifstream& file
         );
 
         void connect(Layer* const layer);
-        void setActivations(const std::vector<double>& activations);
+        void load(Layer* const layer, std::ifstream& file, const std::size_t weights, const std::size_t biases);
+        void load(Layer* const layer, std::ifstream& file, const format::SparseEntry& sparse, const std::size_t biases);
+        void addConnection();
+        void setActivation(const activation::Function function);
+        activation::Function getActivation();
+        void setActivations(const double* const activations, const std::size_t count);
         void activate();
-        std::vector<double> getActivations();
-        void setTargets(const std::vector<double>& targets);
+        void infer();
+        const std::vector<double>& getActivations();
+        void getActivations(double* const activations);
+        void setTargets(const double* const targets, const std::size_t count);
+        double getLoss();
         void train();
+        void setBatchActivations(const Dataset& activations, const std::size_t offset, const std::size_t samples);
+        void setBatchActivations(const double* const activations, const std::size_t samples);
+        void activateBatch(const std::size_t samples);
+        void inferBatch(const std::size_t samples);
+        void getBatchActivations(double* const activations, const std::size_t samples);
+        void setBatchTargets(const Dataset& targets, const std::size_t offset, const std::size_t samples);
+        void trainBatch(const std::size_t samples);
+        void prune(const double threshold);
+        bool isDense();
+        bool isPruned();
+        bool hasWeights();
+        format::Edges getEdges();
+        double* getWeights();
+        std::size_t getWeightCount();
+        double getWeightNorm();
+        double getGradientNorm(const std::size_t samples);
+        std::uint64_t* getRows();
+        std::uint32_t* getColumns();
+        double* getBiases();
+        void resetOptimizerState(const std::size_t values);
+        double* getWeightState();
+        double* getBiasState();
         std::size_t getNeuronCount();
         void save(std::ofstream& file);
 
     private:
 
         Network* const _network;
+        Layer* _inputs;
+        Layer* _outputs;
         std::vector<Neuron*> _neurons;
+        std::vector<double> _weights;
+        std::vector<std::uint64_t> _rows;
+        std::vector<std::uint32_t> _columns;
+        std::vector<double> _biases;
+        std::vector<double> _activations;
+        std::vector<double> _deltas;
+        std::vector<double> _batchActivations;
+        std::vector<double> _batchTargets;
+        std::vector<double> _batchDeltas;
+        std::vector<double> _weightGradients;
+        std::vector<double> _biasGradients;
+        std::vector<double> _weightState;
+        std::vector<double> _biasState;
+        std::size_t _connections;
+        activation::Function _activation;
+        double _loss;
+
+        std::size_t getIndex();
+        void updateWeights(const double* const inputs, const double* const deltas, const std::size_t samples);
+        void updateBiases(const double* const deltas, const std::size_t samples);
 
 };
 
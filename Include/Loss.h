@@ -0,0 +1,31 @@
+#ifndef LOSS_H
+#define LOSS_H
+
+#include <string>
+#include "Activation.h"
+
+namespace loss {
+
+    // Loss functions the output layer can be trained on
+    enum Function {
+
+        SQUARED_ERROR,
+        CROSS_ENTROPY,
+        FUNCTION_COUNT
+
+    };
+
+    const char* getName(const Function function);
+    Function getFunction(const std::string& name);
+
+    // Cross-entropy is only paired with the output functions whose gradient it cancels down to p - y, which
+    // is binary cross-entropy for sigmoid outputs and categorical cross-entropy for softmax outputs
+    inline bool isSupported(const Function function, const activation::Function output) {
+
+        return function != CROSS_ENTROPY || output == activation::SIGMOID || output == activation::SOFTMAX;
+
+    }
+
+};
+
+#endif
\ No newline at end of file
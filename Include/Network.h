@@ -3,10 +3,17 @@
 
 #include <vector>
 #include <cstddef>
+#include <cstdint>
 #include <memory>
 #include "Layer.h"
 #include "Neuron.h"
 #include "Connection.h"
+#include "Pool.h"
+#include "Dataset.h"
+#include "NetworkFormat.h"
+#include "Activation.h"
+#include "Loss.h"
+#include "Optimizer.h"
 #include <fstream>
 
 class Network {
@@ -18,31 +25,68 @@ class Network {
             const double learningRate
         );
 
+        Network(
+            const std::vector<std::size_t>& topology,
+            const std::vector<activation::Function>& activations,
+            const double learningRate
+        );
+
         Network(
             std::ifstream& file,
             const double learningRate
         );
 
         Layer* createLayer(const std::size_t neurons);
-        Neuron* createNeuron();
+        Neuron* createNeuron(Layer* const layer);
         Connection* createConnection(Neuron* const source, Neuron* const target);
+        Connection* createConnection(Neuron* const source, Neuron* const target, const double weight);
+        std::size_t getLayerCount();
+        Layer* getLayer(const std::size_t index);
         std::size_t getNeuronCount();
         Neuron* getNeuron(const std::size_t id);
         double getLearningRate();
-        std::vector<double> getOutputs(const std::vector<double>& inputs);
+        void setLossFunction(const loss::Function function);
+        loss::Function getLossFunction();
+        void setOptimizer(const optimizer::Settings& settings);
+        const optimizer::Settings& getOptimizer();
+        const optimizer::Step& getStep();
+        std::uint64_t getStepCount();
+        void addSteps(const std::uint64_t steps);
+        const std::vector<double>& getOutputs(const std::vector<double>& inputs);
+        const std::vector<double>& getOutputs(const double* const inputs, const std::size_t inputCount);
+        void predictBatch(const double* const inputs, const std::size_t samples, double* const outputs);
         void train(const std::vector<double>& inputs, const std::vector<double>& targets);
+        void train(const double* const inputs, const std::size_t inputCount, const double* const targets, const std::size_t targetCount);
+        void trainBatch(const Dataset& inputs, const Dataset& targets, const std::size_t batchSize);
+        void trainBatch(const Dataset& inputs, const Dataset& targets, const std::size_t offset, const std::size_t batchSize);
         double getLoss(const std::vector<double>& inputs, const std::vector<double>& targets);
-        void save(std::ofstream& file);
+        double getLoss(const double* const inputs, const std::size_t inputCount, const double* const targets, const std::size_t targetCount);
+        void addTrainingLoss(const double loss, const std::size_t samples);
+        double getTrainingLoss();
+        std::size_t getTrainingSamples();
+        double getWeightNorm(const std::size_t layer);
+        double getGradientNorm(const std::size_t layer);
+        void prune(const double sparsity, const bool global);
+        double getSparsity();
+        void save(std::ostream& file);
+        void saveLegacy(std::ofstream& file);
         Layer* loadLayer(std::ifstream& file);
-        Neuron* loadNeuron(std::ifstream& file);
-        Connection* loadConnection(Neuron* const source, std::ifstream& file);
 
     private:
 
         const double _learningRate;
+        loss::Function _lossFunction;
+        optimizer::Settings _optimizer;
+        optimizer::Step _step;
+        std::uint64_t _steps;
+        double _trainingLoss;
+        std::size_t _trainingSamples;
+        std::size_t _batchSamples;
         std::vector<std::unique_ptr<Layer>> _layers;
-        std::vector<std::unique_ptr<Neuron>> _neurons;
-        std::vector<std::unique_ptr<Connection>> _connections;
+        Pool<Neuron> _neurons;
+        Pool<Connection> _connections;
+
+        void load(std::ifstream& file, const format::Header& header);
 
 };
 
@@ -0,0 +1,57 @@
+#ifndef NETWORK_F32_H
+#define NETWORK_F32_H
+
+#include <cstddef>
+#include <vector>
+#include <fstream>
+#include "Activation.h"
+#include "Loss.h"
+
+class Network;
+
+class NetworkF32 {
+
+    public:
+
+        NetworkF32(
+            Network* const network
+        );
+
+        NetworkF32(
+            std::ifstream& file,
+            const float learningRate
+        );
+
+        std::size_t getLayerCount();
+        std::size_t getNeuronCount(const std::size_t layer);
+        float getLearningRate();
+        const std::vector<float>& getOutputs(const std::vector<float>& inputs);
+        const std::vector<float>& getOutputs(const double* const inputs, const std::size_t inputCount);
+        void train(const std::vector<float>& inputs, const std::vector<float>& targets);
+        float getLoss(const std::vector<float>& inputs, const std::vector<float>& targets);
+        void save(std::ofstream& file);
+
+    private:
+
+        struct DenseLayer {
+
+            std::vector<float> weights;
+            std::vector<float> biases;
+            std::vector<float> activations;
+            std::vector<float> deltas;
+            activation::Function activation;
+
+        };
+
+        const float _learningRate;
+        loss::Function _lossFunction;
+        std::vector<DenseLayer> _layers;
+
+        void convert(Network* const network);
+        void setActivations(const float* const inputs, const std::size_t inputCount);
+        void setActivations(const double* const inputs, const std::size_t inputCount);
+        const std::vector<float>& infer();
+
+};
+
+#endif
\ No newline at end of file
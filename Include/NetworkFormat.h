@@ -0,0 +1,336 @@
+#ifndef NETWORK_FORMAT_H
+#define NETWORK_FORMAT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#include "Activation.h"
+#include "Optimizer.h"
+
+#define NETWORK_FORMAT_MAGIC "SNV2"
+#define NETWORK_FORMAT_VERSION 2
+#define NETWORK_FORMAT_BYTE_ORDER 0x01020304
+#define NETWORK_FORMAT_ALIGNMENT 64
+#define NETWORK_FORMAT_EDGES 1
+#define NETWORK_FORMAT_PRUNED 2
+#define NETWORK_FORMAT_ACTIVATIONS 4
+#define NETWORK_FORMAT_OPTIMIZER 8
+#define NETWORK_FORMAT_PROGRESS_MAGIC "SNCP"
+
+namespace format {
+
+    // Fixed size file header, followed by one layer entry per layer
+    struct Header {
+
+        char magic[4];
+        std::uint32_t version;
+        std::uint32_t byteOrder;
+        std::uint32_t flags;
+        std::uint64_t layers;
+
+    };
+
+    // Byte offsets of the row-major weights and the biases of a layer from the start of the file
+    struct LayerEntry {
+
+        std::uint64_t neurons;
+        std::uint64_t weights;
+        std::uint64_t biases;
+
+    };
+
+    // Number and byte offset of the explicit connections of a layer, only present with the edges flag
+    struct EdgeEntry {
+
+        std::uint64_t edges;
+        std::uint64_t offset;
+
+    };
+
+    // Number of remaining weights and byte offset of the compressed rows of a pruned layer, only present
+    // with the pruned flag
+    struct SparseEntry {
+
+        std::uint64_t nonzeros;
+        std::uint64_t offset;
+
+    };
+
+    // Activation function of a layer as an activation::Function value, only present with the activations
+    // flag, which networks of sigmoid layers leave out
+    struct ActivationEntry {
+
+        std::uint64_t function;
+
+    };
+
+    // Optimizer and learning rate schedule settings with the number of steps taken, only present with the
+    // optimizer flag, which networks trained with plain SGD at a constant rate leave out
+    struct OptimizerEntry {
+
+        std::uint64_t method;
+        std::uint64_t schedule;
+        std::uint64_t warmup;
+        std::uint64_t period;
+        std::uint64_t steps;
+        double decay;
+        double momentum;
+        double beta1;
+        double beta2;
+        double epsilon;
+
+    };
+
+    // Byte offset of the optimizer state of a layer, one entry per layer after the optimizer entry, where the
+    // state holds every state value of the weights as a block of the weight matrix size and then the same for
+    // the biases
+    struct StateEntry {
+
+        std::uint64_t offset;
+
+    };
+
+    // Training progress of a checkpoint, appended after the last block of a network file so loaders that follow
+    // the offsets never see it, with the magic last so it can be found from the end of the file
+    struct ProgressEntry {
+
+        std::uint64_t iteration;
+        std::uint64_t sample;
+        std::uint64_t seed;
+        std::uint64_t samples;
+        double loss;
+        char magic[4];
+        std::uint32_t version;
+
+    };
+
+    // Compressed rows of the explicit connections of a layer, where the connections of neuron n are the
+    // targets and weights between rows[n] and rows[n + 1] and targets are IDs of neurons in earlier layers
+    struct Edges {
+
+        std::vector<std::uint64_t> rows;
+        std::vector<std::uint64_t> targets;
+        std::vector<double> weights;
+
+    };
+
+    inline std::uint64_t getEdgesSize(const std::uint64_t neurons, const std::uint64_t edges) {
+
+        return (neurons + 1) * sizeof(std::uint64_t) + edges * (sizeof(std::uint64_t) + sizeof(double));
+
+    }
+
+    // A pruned layer stores its row offsets, then its weights and then the input index of every weight
+    inline std::uint64_t getSparseSize(const std::uint64_t neurons, const std::uint64_t nonzeros) {
+
+        return (neurons + 1) * sizeof(std::uint64_t) + nonzeros * (sizeof(double) + sizeof(std::uint32_t));
+
+    }
+
+    // The rows of a pruned layer have to cover its weights in order and only refer to existing inputs
+    inline bool isValid(const std::uint64_t* const rows, const std::uint32_t* const columns, const std::uint64_t neurons, const std::uint64_t inputs, const std::uint64_t nonzeros) {
+
+        if (rows[0] != 0 || rows[neurons] != nonzeros) { return false; }
+
+        for (std::uint64_t neuron = 0; neuron < neurons; neuron++) {
+
+            if (rows[neuron] > rows[neuron + 1]) { return false; }
+
+        }
+
+        for (std::uint64_t entry = 0; entry < nonzeros; entry++) {
+
+            if (columns[entry] >= inputs) { return false; }
+
+        }
+
+        return true;
+
+    }
+
+    // Optimizer state is kept for every weight of a dense layer and every bias
+    inline std::uint64_t getStateSize(const std::uint64_t neurons, const std::uint64_t inputs, const std::uint64_t values) {
+
+        return values * (neurons * inputs + neurons) * sizeof(double);
+
+    }
+
+    inline OptimizerEntry getEntry(const optimizer::Settings& settings, const std::uint64_t steps) {
+
+        return {
+            settings.method,
+            settings.schedule,
+            settings.warmup,
+            settings.period,
+            steps,
+            settings.decay,
+            settings.momentum,
+            settings.beta1,
+            settings.beta2,
+            settings.epsilon
+        };
+
+    }
+
+    // The enumerations of an entry have to be in range before it is turned into settings
+    inline bool isValid(const OptimizerEntry& entry) {
+
+        return entry.method < optimizer::METHOD_COUNT && entry.schedule < optimizer::SCHEDULE_COUNT;
+
+    }
+
+    inline optimizer::Settings getSettings(const OptimizerEntry& entry) {
+
+        return {
+            static_cast<optimizer::Method>(entry.method),
+            static_cast<optimizer::Schedule>(entry.schedule),
+            entry.warmup,
+            entry.period,
+            entry.decay,
+            entry.momentum,
+            entry.beta1,
+            entry.beta2,
+            entry.epsilon
+        };
+
+    }
+
+    inline std::uint64_t align(const std::uint64_t offset) {
+
+        return (offset + NETWORK_FORMAT_ALIGNMENT - 1) / NETWORK_FORMAT_ALIGNMENT * NETWORK_FORMAT_ALIGNMENT;
+
+    }
+
+    inline bool isHeader(const Header& header) {
+
+        return std::memcmp(header.magic, NETWORK_FORMAT_MAGIC, sizeof(header.magic)) == 0;
+
+    }
+
+    inline Header getHeader(const std::size_t layers, const std::uint32_t flags) {
+
+        Header header = {{}, NETWORK_FORMAT_VERSION, NETWORK_FORMAT_BYTE_ORDER, flags, layers};
+
+        std::memcpy(header.magic, NETWORK_FORMAT_MAGIC, sizeof(header.magic));
+
+        return header;
+
+    }
+
+    // Place the blocks of every layer at the next aligned offset after the tables and return the file size,
+    // a layer only gets a weight or a sparse block if its weight or sparse offset is non-zero before the call
+    // and a state block if there is a state table and the optimizer keeps state values
+    inline std::uint64_t setLayout(std::vector<LayerEntry>& layers, std::vector<EdgeEntry>& edges, std::vector<SparseEntry>& sparse, const std::vector<ActivationEntry>& activations, std::vector<StateEntry>& states, const std::uint64_t values) {
+
+        std::uint64_t offset = sizeof(Header) + layers.size() * sizeof(LayerEntry) + edges.size() * sizeof(EdgeEntry) + sparse.size() * sizeof(SparseEntry);
+
+        offset += activations.size() * sizeof(ActivationEntry);
+        offset += states.empty() ? 0 : sizeof(OptimizerEntry) + states.size() * sizeof(StateEntry);
+
+        for (std::size_t layer = 1; layer < layers.size(); layer++) {
+
+            if (layers[layer].weights != 0) {
+
+                layers[layer].weights = align(offset);
+                offset = layers[layer].weights + layers[layer].neurons * layers[layer - 1].neurons * sizeof(double);
+
+            }
+
+            if (!sparse.empty() && sparse[layer].offset != 0) {
+
+                sparse[layer].offset = align(offset);
+                offset = sparse[layer].offset + getSparseSize(layers[layer].neurons, sparse[layer].nonzeros);
+
+            }
+
+            layers[layer].biases = align(offset);
+            offset = layers[layer].biases + layers[layer].neurons * sizeof(double);
+
+            if (!states.empty() && values > 0) {
+
+                states[layer].offset = align(offset);
+                offset = states[layer].offset + getStateSize(layers[layer].neurons, layers[layer - 1].neurons, values);
+
+            } else if (!states.empty()) {
+
+                states[layer].offset = 0;
+
+            }
+
+            if (!edges.empty() && edges[layer].edges != 0) {
+
+                edges[layer].offset = align(offset);
+                offset = edges[layer].offset + getEdgesSize(layers[layer].neurons, edges[layer].edges);
+
+            }
+
+        }
+
+        return offset;
+
+    }
+
+    // A layout is only valid if it is exactly the one the writer would produce for its layers, state values
+    // are only kept for networks of dense layers
+    inline bool isValid(const std::vector<LayerEntry>& layers, const std::vector<EdgeEntry>& edges, const std::vector<SparseEntry>& sparse, const std::vector<ActivationEntry>& activations, const std::vector<StateEntry>& states, const std::uint64_t values, const std::uint64_t length) {
+
+        if (layers.size() < 2 || (!edges.empty() && edges.size() != layers.size()) || (!sparse.empty() && sparse.size() != layers.size())) { return false; }
+
+        if (!activations.empty() && (activations.size() != layers.size() || activations[0].function != activation::SIGMOID)) { return false; }
+
+        if (!states.empty() && (states.size() != layers.size() || states[0].offset != 0 || (values > 0 && (!edges.empty() || !sparse.empty())))) { return false; }
+
+        std::vector<LayerEntry> layerLayout = layers;
+        std::vector<EdgeEntry> edgeLayout = edges;
+        std::vector<SparseEntry> sparseLayout = sparse;
+        std::vector<StateEntry> stateLayout = states;
+
+        for (std::size_t layer = 0; layer < layers.size(); layer++) {
+
+            if (layers[layer].neurons == 0 || (layer == 0 && (layers[layer].weights != 0 || layers[layer].biases != 0))) { return false; }
+
+            if (!edges.empty() && layer == 0 && edges[layer].edges != 0) { return false; }
+
+            const bool pruned = !sparse.empty() && sparse[layer].offset != 0;
+
+            if (!sparse.empty() && ((layer == 0 && pruned) || (!pruned && sparse[layer].nonzeros != 0))) { return false; }
+
+            // A layer is either dense or pruned, and without the edges flag every layer after the first is one of them
+            if ((pruned && layers[layer].weights != 0) || (edges.empty() && layer > 0 && layers[layer].weights == 0 && !pruned)) { return false; }
+
+            // Counts are bounded by the file length first so the layout below can not overflow
+            if (layers[layer].neurons > length / sizeof(double) || (!edges.empty() && edges[layer].edges > length / sizeof(double))) { return false; }
+
+            if (!sparse.empty() && sparse[layer].nonzeros > length / sizeof(double)) { return false; }
+
+            // Softmax is limited to an output layer without explicit connections
+            if (!activations.empty() && activations[layer].function >= activation::FUNCTION_COUNT) { return false; }
+
+            const bool softmax = !activations.empty() && activations[layer].function == activation::SOFTMAX;
+
+            if (softmax && (layer + 1 != layers.size() || (!edges.empty() && edges[layer].edges != 0))) { return false; }
+
+        }
+
+        if (setLayout(layerLayout, edgeLayout, sparseLayout, activations, stateLayout, values) > length) { return false; }
+
+        for (std::size_t layer = 0; layer < layers.size(); layer++) {
+
+            if (layerLayout[layer].weights != layers[layer].weights || layerLayout[layer].biases != layers[layer].biases) { return false; }
+
+            if (!edges.empty() && edgeLayout[layer].offset != edges[layer].offset) { return false; }
+
+            if (!sparse.empty() && sparseLayout[layer].offset != sparse[layer].offset) { return false; }
+
+            if (!states.empty() && stateLayout[layer].offset != states[layer].offset) { return false; }
+
+        }
+
+        return true;
+
+    }
+
+};
+
+#endif
\ No newline at end of file
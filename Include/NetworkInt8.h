@@ -0,0 +1,56 @@
+#ifndef NETWORK_INT8_H
+#define NETWORK_INT8_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <fstream>
+#include "Dataset.h"
+
+class Network;
+
+class NetworkInt8 {
+
+    public:
+
+        NetworkInt8(
+            Network* const network,
+            const Dataset& calibration,
+            const std::size_t samples
+        );
+
+        NetworkInt8(
+            std::ifstream& file
+        );
+
+        static bool isQuantized(std::ifstream& file);
+
+        std::size_t getLayerCount();
+        std::size_t getNeuronCount(const std::size_t layer);
+        const std::vector<float>& getOutputs(const std::vector<float>& inputs);
+        const std::vector<float>& getOutputs(const double* const inputs, const std::size_t inputCount);
+        void save(std::ofstream& file);
+
+    private:
+
+        struct DenseLayer {
+
+            std::vector<std::int8_t> weights;
+            std::vector<float> scales;
+            std::vector<float> biases;
+            std::vector<float> activations;
+            std::vector<std::int8_t> quantized;
+            float scale;
+
+        };
+
+        std::vector<DenseLayer> _layers;
+
+        void setActivations(const float* const inputs, const std::size_t inputCount);
+        void setActivations(const double* const inputs, const std::size_t inputCount);
+        const std::vector<float>& infer();
+        void quantize(DenseLayer& layer);
+
+};
+
+#endif
\ No newline at end of file
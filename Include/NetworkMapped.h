@@ -0,0 +1,55 @@
+#ifndef NETWORK_MAPPED_H
+#define NETWORK_MAPPED_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <string>
+#include <fstream>
+#include "Activation.h"
+
+class NetworkMapped {
+
+    public:
+
+        explicit NetworkMapped(
+            const std::string& path
+        );
+
+        ~NetworkMapped();
+
+        NetworkMapped(const NetworkMapped&) = delete;
+        NetworkMapped& operator=(const NetworkMapped&) = delete;
+
+        static bool isMappable(std::ifstream& file);
+
+        std::size_t getLayerCount();
+        std::size_t getNeuronCount(const std::size_t layer);
+        activation::Function getActivation(const std::size_t layer);
+        const double* getWeights(const std::size_t layer);
+        const double* getBiases(const std::size_t layer);
+        const std::uint64_t* getRows(const std::size_t layer);
+        const std::uint32_t* getColumns(const std::size_t layer);
+        const std::vector<double>& getOutputs(const std::vector<double>& inputs);
+        const std::vector<double>& getOutputs(const double* const inputs, const std::size_t inputCount);
+
+    private:
+
+        struct MappedLayer {
+
+            const double* weights;
+            const double* biases;
+            const std::uint64_t* rows;
+            const std::uint32_t* columns;
+            std::vector<double> activations;
+            activation::Function activation;
+
+        };
+
+        void* _mapping;
+        std::size_t _length;
+        std::vector<MappedLayer> _layers;
+
+};
+
+#endif
\ No newline at end of file
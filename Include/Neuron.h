@@ -4,39 +4,38 @@
 #include <cstddef>
 #include <vector>
 #include "Connection.h"
+#include "NetworkFormat.h"
 #include <fstream>
 
 class Network;
+class Layer;
 
 class Neuron {
 
     public:
 
-        Neuron(
-            Network* const network
-        );
-
         Neuron(
             Network* const network,
-            std::ifstream& file
+            Layer* const layer
         );
 
         void connect(Neuron* const neuron);
+        void connect(Neuron* const neuron, const double weight);
         void setActivation(const double activation);
         void activate();
         double getActivation();
         void setTarget(const double target);
         void train();
         std::size_t getID();
+        void getEdges(format::Edges& edges);
         void save(std::ofstream& file);
 
     private:
 
         Network* const _network;
+        Layer* const _layer;
+        const std::size_t _index;
         const std::size_t _id;
-        double _bias;
-        double _activation;
-        double _delta;
         std::vector<Connection*> _inputs;
         std::vector<Connection*> _outputs;
 
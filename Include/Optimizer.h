@@ -0,0 +1,73 @@
+#ifndef OPTIMIZER_H
+#define OPTIMIZER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace optimizer {
+
+    // Values are stored in network files, so new methods can only be added at the end
+    enum Method {
+
+        SGD,
+        MOMENTUM,
+        NESTEROV,
+        ADAM,
+        METHOD_COUNT
+
+    };
+
+    // Shape of the learning rate over the steps after the warmup, also stored in network files
+    enum Schedule {
+
+        CONSTANT,
+        STEP,
+        COSINE,
+        SCHEDULE_COUNT
+
+    };
+
+    // Hyperparameters of an optimizer and its learning rate schedule, where the rate ramps up linearly over
+    // the warmup steps, step schedules multiply it by the decay every period steps and cosine schedules
+    // anneal it to zero over period steps
+    struct Settings {
+
+        Method method;
+        Schedule schedule;
+        std::uint64_t warmup;
+        std::uint64_t period;
+        double decay;
+        double momentum;
+        double beta1;
+        double beta2;
+        double epsilon;
+
+    };
+
+    // Parameters of a single update, derived from the settings and the number of steps taken before it
+    struct Step {
+
+        Method method;
+        double rate;
+        double momentum;
+        double beta1;
+        double beta2;
+        double epsilon;
+        double correction1;
+        double correction2;
+
+    };
+
+    const char* getName(const Method method);
+    const char* getName(const Schedule schedule);
+    Method getMethod(const std::string& name);
+    Schedule getSchedule(const std::string& name);
+    Settings getSettings(const Method method);
+    bool isValid(const Settings& settings);
+    std::size_t getStateCount(const Method method);
+    Step getStep(const Settings& settings, const double rate, const std::uint64_t steps);
+
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,97 @@
+#ifndef POOL_H
+#define POOL_H
+
+#include <cstddef>
+#include <vector>
+#include <memory>
+#include <new>
+#include <utility>
+#include <type_traits>
+
+// Objects are constructed back to back in fixed size blocks, so they keep their address for the
+// lifetime of the pool, sit next to the objects created just before them and are released together
+template <typename Type, std::size_t Capacity = 1024>
+class Pool {
+
+    public:
+
+        Pool():
+            _size(0)
+        {}
+
+        ~Pool() {
+
+            clear();
+
+        }
+
+        Pool(const Pool&) = delete;
+        Pool& operator=(const Pool&) = delete;
+
+        template <typename... Arguments>
+        Type* create(Arguments&&... arguments) {
+
+            if (_size == _blocks.size() * Capacity) {
+
+                _blocks.emplace_back(new Block);
+
+            }
+
+            Type* const object = new (getSlot(_size)) Type(std::forward<Arguments>(arguments)...);
+
+            _size++;
+
+            return object;
+
+        }
+
+        Type& operator[](const std::size_t index) {
+
+            return *std::launder(reinterpret_cast<Type*>(getSlot(index)));
+
+        }
+
+        std::size_t getSize() const {
+
+            return _size;
+
+        }
+
+        // Objects are destroyed in reverse order of creation, and not at all when there is nothing to destroy
+        void clear() {
+
+            if (!std::is_trivially_destructible<Type>::value) {
+
+                while (_size > 0) {
+
+                    (*this)[--_size].~Type();
+
+                }
+
+            }
+
+            _size = 0;
+            _blocks.clear();
+
+        }
+
+    private:
+
+        struct Block {
+
+            alignas(Type) unsigned char data[Capacity * sizeof(Type)];
+
+        };
+
+        std::vector<std::unique_ptr<Block>> _blocks;
+        std::size_t _size;
+
+        unsigned char* getSlot(const std::size_t index) {
+
+            return _blocks[index / Capacity]->data + (index % Capacity) * sizeof(Type);
+
+        }
+
+};
+
+#endif
\ No newline at end of file
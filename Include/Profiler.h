@@ -0,0 +1,70 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <ostream>
+
+namespace profiler {
+
+    // Scopes that do not belong to a single layer, such as reading files
+    constexpr std::size_t NO_LAYER = static_cast<std::size_t>(-1);
+
+    // Backward and update scopes belong to the layer that receives the deltas of the layer above
+    // it. Single sample training updates the weights in between inside the backward kernel, so
+    // only batched training has update scopes of its own.
+    enum Phase {
+
+        PHASE_FORWARD,
+        PHASE_OUTPUT_DELTA,
+        PHASE_BACKWARD,
+        PHASE_UPDATE,
+        PHASE_IO,
+        PHASE_COUNT
+
+    };
+
+    void enable();
+    bool isEnabled();
+    bool isAvailable();
+    std::uint64_t getTime();
+    void record(const Phase phase, const std::size_t layer, const std::uint64_t start, const std::uint64_t end);
+    void printReport(std::ostream& stream);
+    void saveTrace(const std::string& path);
+
+    // Records the time between its construction and destruction while the profiler is enabled
+    class Scope {
+
+        public:
+
+            Scope(
+                const Phase phase,
+                const std::size_t layer
+            );
+
+            ~Scope();
+
+            Scope(const Scope&) = delete;
+            Scope& operator=(const Scope&) = delete;
+
+        private:
+
+            const Phase _phase;
+            const std::size_t _layer;
+            const std::uint64_t _start;
+
+    };
+
+};
+
+// Scopes only exist in builds with PROFILING defined, everywhere else they compile to nothing
+#ifdef PROFILING
+#define PROFILE_NAME(line) profileScope##line
+#define PROFILE_LINE(line) PROFILE_NAME(line)
+#define PROFILE_SCOPE(phase, layer) const profiler::Scope PROFILE_LINE(__LINE__)(profiler::phase, layer)
+#else
+#define PROFILE_SCOPE(phase, layer)
+#endif
+
+#endif
\ No newline at end of file
@@ -1,30 +1,96 @@
 #ifndef RNG_H
 #define RNG_H
 
-#include <random>
+#include <cstddef>
+#include <cstdint>
 #include <type_traits>
 
 namespace rng {
 
+    // Counter based generator, where value n of a stream is a SplitMix64 hash of the key of the stream plus n
+    // times a fixed odd constant. Any position can be reached without producing the values before it, so a
+    // block of values is the same no matter which thread draws it or what was drawn before.
+    class Generator {
+
+        public:
+
+            Generator(
+                const std::uint64_t seed,
+                const std::uint64_t stream
+            );
+
+            std::uint64_t next();
+            double getUniform();
+            void jump(const std::uint64_t count);
+            Generator split(const std::uint64_t stream) const;
+            void fill(double* const values, const std::size_t count, const double minimum, const double maximum);
+
+            template <typename T>
+            T range(const T minimum, const T maximum);
+
+        private:
+
+            std::uint64_t _key;
+            std::uint64_t _counter;
+
+            std::uint64_t getBounded(const std::uint64_t bound);
+
+    };
+
+    constexpr std::uint64_t GAMMA = 0x9e3779b97f4a7c15;
+
+    // Finalizer of SplitMix64, a bijection that spreads every bit of a counter across the whole value
+    inline std::uint64_t mix(std::uint64_t value) {
+
+        value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9;
+        value = (value ^ (value >> 27)) * 0x94d049bb133111eb;
+
+        return value ^ (value >> 31);
+
+    }
+
+    void setSeed(const std::uint64_t seed);
+    std::uint64_t getSeed();
+    Generator& getGenerator();
+
     template <typename T>
-    T range(T minimum, T maximum) {
+    T range(const T minimum, const T maximum) {
+
+        return getGenerator().range(minimum, maximum);
+
+    }
+
+    inline std::uint64_t Generator::next() {
+
+        return mix(_key + ++_counter * GAMMA);
+
+    }
 
-        static thread_local std::random_device device;
-        static thread_local std::mt19937 generator(device());
+    // The top 53 bits fill the mantissa of a double in [0, 1)
+    inline double Generator::getUniform() {
+
+        return static_cast<double>(next() >> 11) * 0x1.0p-53;
+
+    }
+
+    // Values in [minimum, maximum] for integers and [minimum, maximum) for floating point types, the same
+    // ranges the standard distributions use
+    template <typename T>
+    T Generator::range(const T minimum, const T maximum) {
 
         if constexpr (std::is_integral<T>::value) {
 
-            std::uniform_int_distribution<T> distribution(minimum, maximum);
-            return distribution(generator);
+            const std::uint64_t span = static_cast<std::uint64_t>(maximum) - static_cast<std::uint64_t>(minimum);
+
+            if (span == UINT64_MAX) { return static_cast<T>(next()); }
 
-        } else if constexpr (std::is_floating_point<T>::value) {
+            return static_cast<T>(static_cast<std::uint64_t>(minimum) + getBounded(span + 1));
 
-            std::uniform_real_distribution<T> distribution(minimum, maximum);
-            return distribution(generator);
-        
         } else {
 
-            static_assert(std::is_arithmetic<T>::value, "Type must be numeric");
+            static_assert(std::is_floating_point<T>::value, "Type must be numeric");
+
+            return minimum + static_cast<T>(getUniform() * (maximum - minimum));
 
         }
 
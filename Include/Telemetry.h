@@ -0,0 +1,48 @@
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <cstddef>
+#include <string>
+#include <fstream>
+#include <chrono>
+
+class Network;
+class Trainer;
+
+// Streams training statistics to a file as JSON lines, or as CSV for paths ending in .csv, so runs
+// can be plotted and compared while they are still training
+class Telemetry {
+
+    public:
+
+        Telemetry(
+            Network* const network,
+            Trainer* const trainer,
+            const std::string& path,
+            const double interval
+        );
+
+        void update();
+        void write();
+
+    private:
+
+        Network* const _network;
+        Trainer* const _trainer;
+        std::ofstream _file;
+        const bool _csv;
+        const double _interval;
+        const std::chrono::steady_clock::time_point _start;
+        std::chrono::steady_clock::time_point _recorded;
+        std::size_t _steps;
+        std::size_t _samples;
+        double _loss;
+        std::size_t _recordedSamples;
+        double _recordedLoss;
+        double _average;
+
+        double getGradientNorm(const std::size_t layer);
+
+};
+
+#endif
\ No newline at end of file
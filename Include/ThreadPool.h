@@ -0,0 +1,47 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <cstddef>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+
+class ThreadPool {
+
+    public:
+
+        ThreadPool(
+            const std::size_t threads
+        );
+
+        ~ThreadPool();
+
+        void run(const std::function<void(const std::size_t thread)>& task);
+        std::size_t getThreadCount();
+
+        // Tasks are wrapped by reference, which std::function stores without allocating a copy of them
+        template <typename Task>
+        void run(const Task& task) {
+
+            run(std::function<void(const std::size_t thread)>(std::cref(task)));
+
+        }
+
+    private:
+
+        std::vector<std::thread> _threads;
+        std::mutex _mutex;
+        std::condition_variable _start;
+        std::condition_variable _finish;
+        const std::function<void(const std::size_t thread)>* _task;
+        std::size_t _generation;
+        std::size_t _pending;
+        bool _stop;
+
+        void work(const std::size_t thread);
+
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,52 @@
+#ifndef TRAINER_H
+#define TRAINER_H
+
+#include <cstddef>
+#include <vector>
+#include "ThreadPool.h"
+#include "Dataset.h"
+#include "Optimizer.h"
+
+class Network;
+
+class Trainer {
+
+    public:
+
+        Trainer(
+            Network* const network,
+            const std::size_t threads
+        );
+
+        void train(const Dataset& inputs, const Dataset& targets, const std::size_t offset, const std::size_t batchSize);
+        void trainAsync(const Dataset& inputs, const Dataset& targets, const std::size_t offset, const std::size_t count);
+        std::size_t getThreadCount();
+        double getGradientNorm(const std::size_t layer);
+
+    private:
+
+        struct Worker {
+
+            std::vector<std::vector<double>> activations;
+            std::vector<std::vector<double>> deltas;
+            std::vector<double> targets;
+            std::vector<std::vector<double>> weightGradients;
+            std::vector<std::vector<double>> biasGradients;
+            double loss;
+
+        };
+
+        Network* const _network;
+        ThreadPool _pool;
+        std::vector<Worker> _workers;
+        std::size_t _samples;
+
+        std::size_t getSampleCount(const Dataset& inputs, const Dataset& targets, const std::size_t offset, const std::size_t count);
+        void trainSample(Worker& worker, const Dataset& inputs, const Dataset& targets, const std::size_t sample);
+        void computeGradients(Worker& worker, const Dataset& inputs, const Dataset& targets, const std::size_t first, const std::size_t last);
+        void reduceGradients(Worker& worker, const Worker& other);
+        void applyGradients(const Worker& worker, const std::size_t thread, const std::size_t samples, const optimizer::Step& step);
+
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,529 @@
+#include "Network.h"
+#include "Dataset.h"
+#include "RNG.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include <cerrno>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#define SERVER_SOCKET "spaghetti_neurons.sock"
+#define SERVER_BATCH 32
+#define SERVER_LATENCY 1000
+#define SERVER_REQUESTS 10000
+#define SERVER_BACKLOG 128
+
+struct Arguments {
+
+    std::string network;
+    std::string socket;
+    std::string images;
+    std::size_t batch;
+    std::size_t latency;
+    std::size_t clients;
+    std::size_t requests;
+
+};
+
+// A request waits in the queue until the batching thread has written its outputs
+struct Request {
+
+    const double* inputs;
+    double* outputs;
+    std::chrono::steady_clock::time_point arrival;
+    bool done;
+
+};
+
+// Requests of all connections in arrival order, shared by the connection threads and the batching thread,
+// with the number of connections that are still being served
+struct Queue {
+
+    std::mutex mutex;
+    std::condition_variable pending;
+    std::condition_variable completed;
+    std::condition_variable closed;
+    std::vector<Request*> requests;
+    std::size_t batches;
+    std::size_t samples;
+    std::size_t connections;
+    bool stopped;
+
+};
+
+// Sizes a client reads once after connecting, every request and response is a plain array of doubles
+struct Header {
+
+    std::uint64_t inputs;
+    std::uint64_t outputs;
+
+};
+
+// ================================================================================================
+// Get launch arguments
+// ================================================================================================
+Arguments getArguments(int argc, char* argv[]) {
+
+    Arguments arguments = {"", SERVER_SOCKET, "", SERVER_BATCH, SERVER_LATENCY, 0, SERVER_REQUESTS};
+
+    for (int i = 1; i < argc; i++) {
+
+        std::string argument = argv[i];
+
+        if (argument == "--network") { arguments.network = argv[++i]; }
+        if (argument == "--socket") { arguments.socket = argv[++i]; }
+        if (argument == "--images") { arguments.images = argv[++i]; }
+        if (argument == "--batch") { arguments.batch = std::stoull(argv[++i]); }
+        if (argument == "--latency") { arguments.latency = std::stoull(argv[++i]); }
+        if (argument == "--clients") { arguments.clients = std::stoull(argv[++i]); }
+        if (argument == "--requests") { arguments.requests = std::stoull(argv[++i]); }
+
+    }
+
+    if (arguments.network.empty() && arguments.clients == 0) {
+
+        std::cerr << "Missing input arguments!" << std::endl;
+        std::exit(1);
+
+    }
+
+    if (arguments.batch == 0) {
+
+        std::cerr << "Invalid batch size!" << std::endl;
+        std::exit(1);
+
+    }
+
+    if (arguments.socket.size() >= sizeof(sockaddr_un::sun_path)) {
+
+        std::cerr << "Socket path is too long!" << std::endl;
+        std::exit(1);
+
+    }
+
+    return arguments;
+
+}
+
+// ================================================================================================
+// Get the address of a Unix domain socket
+// ================================================================================================
+sockaddr_un getAddress(const std::string& path) {
+
+    sockaddr_un address = {};
+
+    address.sun_family = AF_UNIX;
+    std::strncpy(address.sun_path, path.c_str(), sizeof(address.sun_path) - 1);
+
+    return address;
+
+}
+
+// ================================================================================================
+// Read an exact number of bytes from a socket, returning false once the peer has closed it
+// ================================================================================================
+bool readAll(const int socket, void* const data, const std::size_t size) {
+
+    char* const bytes = static_cast<char*>(data);
+
+    for (std::size_t offset = 0; offset < size;) {
+
+        const ssize_t count = recv(socket, bytes + offset, size - offset, 0);
+
+        if (count < 0 && errno == EINTR) { continue; }
+        if (count <= 0) { return false; }
+
+        offset += count;
+
+    }
+
+    return true;
+
+}
+
+// ================================================================================================
+// Write an exact number of bytes to a socket, returning false once the peer has closed it
+// ================================================================================================
+bool writeAll(const int socket, const void* const data, const std::size_t size) {
+
+    const char* const bytes = static_cast<const char*>(data);
+
+    for (std::size_t offset = 0; offset < size;) {
+
+        const ssize_t count = send(socket, bytes + offset, size - offset, MSG_NOSIGNAL);
+
+        if (count < 0 && errno == EINTR) { continue; }
+        if (count <= 0) { return false; }
+
+        offset += count;
+
+    }
+
+    return true;
+
+}
+
+// ================================================================================================
+// Answer the requests of a single client, each one is queued and answered before the next is read
+// ================================================================================================
+// The batching thread answers every queued request before it stops, so a request is always waited for
+// until it is done and its buffers are never released while outputs are still being written to them
+void serveConnection(const int connection, Queue& queue, const Header header) {
+
+    std::vector<double> inputs(header.inputs);
+    std::vector<double> outputs(header.outputs);
+
+    Request request = {inputs.data(), outputs.data(), {}, false};
+
+    if (writeAll(connection, &header, sizeof(header))) {
+
+        while (readAll(connection, inputs.data(), inputs.size() * sizeof(double))) {
+
+            std::unique_lock<std::mutex> lock(queue.mutex);
+
+            if (queue.stopped) { break; }
+
+            request.arrival = std::chrono::steady_clock::now();
+            request.done = false;
+
+            queue.requests.push_back(&request);
+            queue.pending.notify_one();
+
+            queue.completed.wait(lock, [&]() { return request.done; });
+
+            lock.unlock();
+
+            if (!writeAll(connection, outputs.data(), outputs.size() * sizeof(double))) { break; }
+
+        }
+
+    }
+
+    close(connection);
+
+    // The queue belongs to the main thread, which waits for this before it goes away
+    std::lock_guard<std::mutex> lock(queue.mutex);
+
+    queue.connections--;
+    queue.closed.notify_all();
+
+}
+
+// ================================================================================================
+// Coalesce queued requests until a batch is full or the oldest request reaches its deadline
+// ================================================================================================
+void serveBatches(Network& network, Queue& queue, const std::size_t batch, const std::chrono::microseconds latency) {
+
+    const std::size_t inputCount = network.getLayer(0)->getNeuronCount();
+    const std::size_t outputCount = network.getLayer(network.getLayerCount() - 1)->getNeuronCount();
+
+    // All buffers are sized for a full batch up front, so serving does not allocate
+    std::vector<double> inputs(batch * inputCount);
+    std::vector<double> outputs(batch * outputCount);
+    std::vector<Request*> requests;
+
+    requests.reserve(batch);
+
+    while (true) {
+
+        std::unique_lock<std::mutex> lock(queue.mutex);
+
+        queue.pending.wait(lock, [&]() { return queue.stopped || !queue.requests.empty(); });
+
+        // Requests that were queued before stopping are still answered, their connections wait for them
+        if (queue.requests.empty()) { break; }
+
+        const std::chrono::steady_clock::time_point deadline = queue.requests.front()->arrival + latency;
+
+        queue.pending.wait_until(lock, deadline, [&]() { return queue.stopped || queue.requests.size() >= batch; });
+
+        const std::size_t samples = std::min(batch, queue.requests.size());
+
+        requests.assign(queue.requests.begin(), queue.requests.begin() + samples);
+        queue.requests.erase(queue.requests.begin(), queue.requests.begin() + samples);
+
+        lock.unlock();
+
+        // Clients wait for their own request, so their buffers stay untouched until it is done
+        for (std::size_t sample = 0; sample < samples; sample++) {
+
+            std::copy(requests[sample]->inputs, requests[sample]->inputs + inputCount, inputs.begin() + sample * inputCount);
+
+        }
+
+        network.predictBatch(inputs.data(), samples, outputs.data());
+
+        for (std::size_t sample = 0; sample < samples; sample++) {
+
+            std::copy(outputs.begin() + sample * outputCount, outputs.begin() + (sample + 1) * outputCount, requests[sample]->outputs);
+
+        }
+
+        lock.lock();
+
+        for (Request* const request : requests) {
+
+            request->done = true;
+
+        }
+
+        queue.batches++;
+        queue.samples += samples;
+        queue.completed.notify_all();
+
+    }
+
+}
+
+// ================================================================================================
+// Accept clients on a listening socket until it is shut down
+// ================================================================================================
+// Connection threads are detached so a long running server does not keep the threads of every client it
+// has served, the count of open connections tells when all of them are finished instead
+void acceptConnections(const int listener, Queue& queue, const Header header) {
+
+    while (true) {
+
+        const int connection = accept(listener, nullptr, nullptr);
+
+        if (connection < 0 && errno == EINTR) { continue; }
+        if (connection < 0) { break; }
+
+        {
+
+            std::lock_guard<std::mutex> lock(queue.mutex);
+
+            queue.connections++;
+
+        }
+
+        std::thread(serveConnection, connection, std::ref(queue), header).detach();
+
+    }
+
+}
+
+// ================================================================================================
+// Send requests from concurrent clients to a server and report latency percentiles and throughput
+// ================================================================================================
+void generateLoad(const Arguments& arguments) {
+
+    std::unique_ptr<Dataset> images;
+
+    if (!arguments.images.empty()) {
+
+        images = std::make_unique<Dataset>(arguments.images);
+
+    }
+
+    const sockaddr_un address = getAddress(arguments.socket);
+    const std::size_t requests = arguments.requests / arguments.clients;
+
+    std::vector<std::vector<double>> latencies(arguments.clients, std::vector<double>(requests));
+    std::atomic<bool> failed(false);
+    std::vector<std::thread> clients;
+
+    std::chrono::steady_clock::time_point startTimestamp = std::chrono::steady_clock::now();
+
+    for (std::size_t client = 0; client < arguments.clients; client++) {
+
+        clients.emplace_back([&, client]() {
+
+            const int connection = socket(AF_UNIX, SOCK_STREAM, 0);
+
+            Header header;
+
+            if (connection < 0 || connect(connection, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0 || !readAll(connection, &header, sizeof(header))) {
+
+                if (connection >= 0) { close(connection); }
+
+                failed = true;
+                return;
+
+            }
+
+            std::vector<double> inputs(header.inputs);
+            std::vector<double> outputs(header.outputs);
+
+            for (std::size_t request = 0; request < requests; request++) {
+
+                // Clients walk through the dataset from different offsets, or send random inputs without one
+                if (images && images->getPoints() == inputs.size()) {
+
+                    images->getSample((client * requests + request) % images->getSize(), inputs.data());
+
+                } else {
+
+                    for (auto& input : inputs) {
+
+                        input = rng::range(0.0, 1.0);
+
+                    }
+
+                }
+
+                std::chrono::steady_clock::time_point requestTimestamp = std::chrono::steady_clock::now();
+
+                if (!writeAll(connection, inputs.data(), inputs.size() * sizeof(double)) || !readAll(connection, outputs.data(), outputs.size() * sizeof(double))) {
+
+                    failed = true;
+                    break;
+
+                }
+
+                std::chrono::duration<double, std::micro> durationMicroseconds = std::chrono::steady_clock::now() - requestTimestamp;
+
+                latencies[client][request] = durationMicroseconds.count();
+
+            }
+
+            close(connection);
+
+        });
+
+    }
+
+    for (auto& client : clients) {
+
+        client.join();
+
+    }
+
+    std::chrono::duration<double> durationSeconds = std::chrono::steady_clock::now() - startTimestamp;
+
+    if (failed || requests == 0) {
+
+        std::cerr << "Load generation failed!" << std::endl;
+        std::exit(1);
+
+    }
+
+    std::vector<double> merged;
+
+    for (const auto& latency : latencies) {
+
+        merged.insert(merged.end(), latency.begin(), latency.end());
+
+    }
+
+    std::sort(merged.begin(), merged.end());
+
+    std::cout << "Requests: " << merged.size() << " from " << arguments.clients << " clients" << std::endl;
+    std::cout << "Throughput: " << merged.size() / durationSeconds.count() << " requests/s" << std::endl;
+    std::cout << "Latency p50: " << merged[merged.size() / 2] << " us" << std::endl;
+    std::cout << "Latency p99: " << merged[merged.size() * 99 / 100] << " us" << std::endl;
+
+}
+
+// ================================================================================================
+// Main
+// ================================================================================================
+int main(int argc, char* argv[]) {
+
+    Arguments arguments = getArguments(argc, argv);
+
+    // Without a network the load generator targets a server that is already running
+    if (arguments.network.empty()) {
+
+        generateLoad(arguments);
+
+        return 0;
+
+    }
+
+    std::ifstream networkFile(arguments.network, std::ios::binary);
+
+    if (!networkFile) {
+
+        std::cerr << "Network file could not be opened!" << std::endl;
+        std::exit(1);
+
+    }
+
+    Network network(networkFile, 0.0);
+
+    const Header header = {network.getLayer(0)->getNeuronCount(), network.getLayer(network.getLayerCount() - 1)->getNeuronCount()};
+    const sockaddr_un address = getAddress(arguments.socket);
+    const int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+
+    unlink(arguments.socket.c_str());
+
+    if (listener < 0 || bind(listener, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0 || listen(listener, SERVER_BACKLOG) != 0) {
+
+        std::cerr << "Socket could not be opened!" << std::endl;
+        std::exit(1);
+
+    }
+
+    Queue queue;
+
+    queue.batches = 0;
+    queue.samples = 0;
+    queue.connections = 0;
+    queue.stopped = false;
+
+    std::thread batcher(serveBatches, std::ref(network), std::ref(queue), arguments.batch, std::chrono::microseconds(arguments.latency));
+    std::thread acceptor(acceptConnections, listener, std::ref(queue), header);
+
+    std::cout << "Serving " << arguments.network << " on " << arguments.socket << " (batch " << arguments.batch << ", latency " << arguments.latency << " us)" << std::endl;
+
+    if (arguments.clients == 0) {
+
+        acceptor.join();
+
+    } else {
+
+        generateLoad(arguments);
+
+        shutdown(listener, SHUT_RDWR);
+        acceptor.join();
+
+    }
+
+    {
+
+        std::lock_guard<std::mutex> lock(queue.mutex);
+
+        queue.stopped = true;
+        queue.pending.notify_all();
+        queue.completed.notify_all();
+
+    }
+
+    batcher.join();
+
+    {
+
+        std::unique_lock<std::mutex> lock(queue.mutex);
+
+        queue.closed.wait(lock, [&]() { return queue.connections == 0; });
+
+    }
+
+    close(listener);
+    unlink(arguments.socket.c_str());
+
+    if (queue.batches > 0) {
+
+        std::cout << "Mean batch size: " << static_cast<double>(queue.samples) / queue.batches << std::endl;
+
+    }
+
+    return 0;
+
+}
\ No newline at end of file
@@ -0,0 +1,32 @@
+#include "Activation.h"
+#include <stdexcept>
+
+static const char* const FUNCTION_NAMES[] = {"sigmoid", "relu", "leaky-relu", "tanh", "softmax"};
+
+// ================================================================================================
+// Get the name of an activation function as used on the command line
+// ================================================================================================
+const char* activation::getName(const Function function) {
+
+    return function < FUNCTION_COUNT ? FUNCTION_NAMES[function] : "unknown";
+
+}
+
+// ================================================================================================
+// Get an activation function by its name
+// ================================================================================================
+activation::Function activation::getFunction(const std::string& name) {
+
+    for (std::size_t function = 0; function < FUNCTION_COUNT; function++) {
+
+        if (name == FUNCTION_NAMES[function]) {
+
+            return static_cast<Function>(function);
+
+        }
+
+    }
+
+    throw std::invalid_argument("Unknown activation function!");
+
+}
\ No newline at end of file
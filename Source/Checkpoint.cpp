@@ -0,0 +1,289 @@
+#include "Checkpoint.h"
+#include "Network.h"
+#include "Profiler.h"
+#include <stdexcept>
+#include <streambuf>
+#include <ostream>
+#include <fstream>
+#include <cstring>
+#include <cstdio>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+
+// Output buffer that appends to a vector, which keeps its capacity from one snapshot to the next
+class SnapshotBuffer : public std::streambuf {
+
+    public:
+
+        SnapshotBuffer(std::vector<char>& data): _data(data) {
+
+            _data.clear();
+
+        }
+
+    protected:
+
+        std::streamsize xsputn(const char* const data, const std::streamsize size) override {
+
+            _data.insert(_data.end(), data, data + size);
+
+            return size;
+
+        }
+
+        int_type overflow(const int_type character) override {
+
+            if (!traits_type::eq_int_type(character, traits_type::eof())) {
+
+                _data.push_back(traits_type::to_char_type(character));
+
+            }
+
+            return traits_type::not_eof(character);
+
+        }
+
+        // Networks only ask for the current position, to pad their blocks up to the offsets of the layout
+        pos_type seekoff(const off_type offset, const std::ios_base::seekdir direction, const std::ios_base::openmode mode) override {
+
+            if (offset != 0 || direction != std::ios_base::cur || !(mode & std::ios_base::out)) {
+
+                return pos_type(off_type(-1));
+
+            }
+
+            return pos_type(static_cast<off_type>(_data.size()));
+
+        }
+
+    private:
+
+        std::vector<char>& _data;
+
+};
+
+// ================================================================================================
+// Constructor
+// ================================================================================================
+Checkpoint::Checkpoint(
+    Network* const network,
+    const std::string& path,
+    const std::size_t samples,
+    const double interval,
+    const std::uint64_t seed
+):
+    _network(network),
+    _path(path),
+    _samples(samples),
+    _interval(interval),
+    _seed(seed),
+    _saved(std::chrono::steady_clock::now()),
+    _savedSamples(network->getTrainingSamples()),
+    _buffer(0)
+{
+
+    if (!(_interval >= 0.0)) {
+
+        throw std::invalid_argument("Invalid checkpoint interval!");
+
+    }
+
+}
+
+// ================================================================================================
+// Destructor
+// ================================================================================================
+Checkpoint::~Checkpoint() {
+
+    // The write thread reads from the buffers, so it has to finish before they can go away
+    if (_writing.valid()) {
+
+        _writing.wait();
+
+    }
+
+}
+
+// ================================================================================================
+// Save a checkpoint once enough samples were trained or enough time passed since the last one
+// ================================================================================================
+// The iteration and sample are where training continues on resume, so they have to be after the last step
+void Checkpoint::update(const std::size_t iteration, const std::size_t sample) {
+
+    const bool samplesPassed = _samples > 0 && _network->getTrainingSamples() - _savedSamples >= _samples;
+    const bool intervalPassed = _interval > 0.0 && std::chrono::duration<double>(std::chrono::steady_clock::now() - _saved).count() >= _interval;
+
+    if (samplesPassed || intervalPassed) {
+
+        save(iteration, sample);
+
+    }
+
+}
+
+// ================================================================================================
+// Snapshot the network with its training progress and write it to disk in the background
+// ================================================================================================
+// The snapshot goes into the buffer that is not being written, so only writing it waits for an earlier
+// checkpoint, which keeps the checkpoints on disk in order. Only the snapshot and that wait hold up training.
+void Checkpoint::save(const std::size_t iteration, const std::size_t sample) {
+
+    PROFILE_SCOPE(PHASE_IO, profiler::NO_LAYER);
+
+    format::ProgressEntry progress = {iteration, sample, _seed, _network->getTrainingSamples(), _network->getTrainingLoss(), {}, NETWORK_FORMAT_VERSION};
+
+    std::memcpy(progress.magic, NETWORK_FORMAT_PROGRESS_MAGIC, sizeof(progress.magic));
+
+    SnapshotBuffer buffer(_buffers[_buffer]);
+    std::ostream stream(&buffer);
+
+    _network->save(stream);
+
+    stream.write(reinterpret_cast<const char*>(&progress), sizeof(progress));
+
+    if (!stream) {
+
+        throw std::invalid_argument("Checkpoint could not be saved!");
+
+    }
+
+    wait();
+
+    _writing = std::async(std::launch::async, &Checkpoint::write, this, _buffer);
+    _buffer = 1 - _buffer;
+    _saved = std::chrono::steady_clock::now();
+    _savedSamples = _network->getTrainingSamples();
+
+}
+
+// ================================================================================================
+// Wait until the last checkpoint is on disk and report if it failed
+// ================================================================================================
+void Checkpoint::wait() {
+
+    if (_writing.valid()) {
+
+        _writing.get();
+
+    }
+
+}
+
+// ================================================================================================
+// Read the training progress from the end of a checkpoint without consuming the file, false without one
+// ================================================================================================
+bool Checkpoint::getProgress(std::ifstream& file, format::ProgressEntry& progress) {
+
+    const std::streampos position = file.tellg();
+
+    file.seekg(0, std::ios::end);
+
+    const std::streamoff length = file.tellg();
+
+    if (length >= static_cast<std::streamoff>(sizeof(format::Header) + sizeof(progress))) {
+
+        file.seekg(length - static_cast<std::streamoff>(sizeof(progress)));
+        file.read(reinterpret_cast<char*>(&progress), sizeof(progress));
+
+    }
+
+    const bool found = file && length >= static_cast<std::streamoff>(sizeof(format::Header) + sizeof(progress)) &&
+                       std::memcmp(progress.magic, NETWORK_FORMAT_PROGRESS_MAGIC, sizeof(progress.magic)) == 0 &&
+                       progress.version == NETWORK_FORMAT_VERSION;
+
+    file.clear();
+    file.seekg(position);
+
+    return found;
+
+}
+
+// ================================================================================================
+// Save a network without training progress, replacing its file only once the new one is complete
+// ================================================================================================
+void Checkpoint::replace(Network* const network, const std::string& path) {
+
+    PROFILE_SCOPE(PHASE_IO, profiler::NO_LAYER);
+
+    std::vector<char> data;
+
+    SnapshotBuffer buffer(data);
+    std::ostream stream(&buffer);
+
+    network->save(stream);
+
+    if (!stream) {
+
+        throw std::invalid_argument("Checkpoint could not be saved!");
+
+    }
+
+    replace(path, data);
+
+}
+
+// ================================================================================================
+// Write a snapshot to disk in the background
+// ================================================================================================
+void Checkpoint::write(const std::size_t buffer) {
+
+    replace(_path, _buffers[buffer]);
+
+}
+
+// ================================================================================================
+// Write data to a temporary file and move it over a file once it is complete
+// ================================================================================================
+// Renaming within a directory is atomic, so the file is always either the old or the new data. The rename
+// itself is only on disk once the directory is synced as well.
+void Checkpoint::replace(const std::string& path, const std::vector<char>& data) {
+
+    const std::string temporary = path + ".tmp";
+    const std::size_t separator = path.find_last_of('/');
+    const std::string directory = separator == std::string::npos ? "." : path.substr(0, separator + 1);
+
+    const int file = open(temporary.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+
+    if (file < 0) {
+
+        throw std::invalid_argument("Checkpoint file could not be opened!");
+
+    }
+
+    std::size_t written = 0;
+
+    while (written < data.size()) {
+
+        const ssize_t result = ::write(file, data.data() + written, data.size() - written);
+
+        if (result < 0 && errno == EINTR) { continue; }
+        if (result <= 0) { break; }
+
+        written += result;
+
+    }
+
+    // The data has to be on disk before the rename makes it the network file
+    const bool synced = written == data.size() && fsync(file) == 0;
+
+    if (close(file) != 0 || !synced || std::rename(temporary.c_str(), path.c_str()) != 0) {
+
+        std::remove(temporary.c_str());
+
+        throw std::invalid_argument("Checkpoint file could not be written!");
+
+    }
+
+    const int parent = open(directory.c_str(), O_RDONLY | O_DIRECTORY);
+    const bool durable = parent >= 0 && fsync(parent) == 0;
+
+    if (parent >= 0) { close(parent); }
+
+    if (!durable) {
+
+        throw std::invalid_argument("Checkpoint file could not be written!");
+
+    }
+
+}
\ No newline at end of file
@@ -18,17 +18,18 @@ Connection::Connection(
 {}
 
 // ================================================================================================
-// Construct a connection from disk
+// Construct a connection with a known weight
 // ================================================================================================
 Connection::Connection(
     Network* const network,
     Neuron* const source,
-    std::ifstream& file
+    Neuron* const target,
+    const double weight
 ):
     _network(network),
     _source(source),
-    _target([&network, &file]{ std::size_t id; file.read(reinterpret_cast<char*>(&id), sizeof(id)); return network->getNeuron(id); }()),
-    _weight([&file]{ double weight; file.read(reinterpret_cast<char*>(&weight), sizeof(weight)); return weight; }())
+    _target(target),
+    _weight(weight)
 {}
 
 // ================================================================================================
@@ -0,0 +1,320 @@
+#include "Dataset.h"
+#include "Profiler.h"
+#include <stdexcept>
+#include <algorithm>
+#include <cstring>
+#include <utility>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Compact files store uint8 values with a scale or one class index per sample after their magic
+#define DATASET_BYTES_MAGIC "SNU8"
+#define DATASET_LABELS_MAGIC "SNCL"
+#define DATASET_MAGIC_SIZE 4
+
+// ================================================================================================
+// Map a dataset file into memory without copying its samples
+// ================================================================================================
+Dataset::Dataset(
+    const std::string& path
+):
+    _mapping(nullptr),
+    _length(0),
+    _data(nullptr),
+    _bytes(nullptr),
+    _scale(1.0),
+    _labels(false),
+    _entries(0),
+    _points(0)
+{
+
+    PROFILE_SCOPE(PHASE_IO, profiler::NO_LAYER);
+
+    const int file = open(path.c_str(), O_RDONLY);
+
+    if (file < 0) {
+
+        throw std::invalid_argument("Dataset file could not be opened!");
+
+    }
+
+    struct stat status;
+
+    if (fstat(file, &status) != 0 || static_cast<std::size_t>(status.st_size) < 2 * sizeof(std::size_t)) {
+
+        close(file);
+        throw std::invalid_argument("Invalid dataset file!");
+
+    }
+
+    _length = status.st_size;
+    _mapping = mmap(nullptr, _length, PROT_READ, MAP_PRIVATE, file, 0);
+
+    // The mapping stays valid after the file descriptor is closed
+    close(file);
+
+    if (_mapping == MAP_FAILED) {
+
+        _mapping = nullptr;
+        throw std::invalid_argument("Dataset file could not be mapped!");
+
+    }
+
+    const char* const bytes = static_cast<const char*>(_mapping);
+
+    if (std::memcmp(bytes, DATASET_BYTES_MAGIC, DATASET_MAGIC_SIZE) == 0) {
+
+        map(DATASET_MAGIC_SIZE + 2 * sizeof(std::size_t) + sizeof(double));
+
+    } else if (std::memcmp(bytes, DATASET_LABELS_MAGIC, DATASET_MAGIC_SIZE) == 0) {
+
+        _labels = true;
+        map(DATASET_MAGIC_SIZE + 2 * sizeof(std::size_t));
+
+    } else {
+
+        map(2 * sizeof(std::size_t));
+
+    }
+
+    // Samples are mostly read front to back, so the kernel can read ahead aggressively
+    madvise(_mapping, _length, MADV_SEQUENTIAL);
+
+}
+
+// ================================================================================================
+// Construct a dataset that owns a contiguous copy of a set of samples
+// ================================================================================================
+Dataset::Dataset(
+    const std::vector<std::vector<double>>& data
+):
+    _mapping(nullptr),
+    _length(0),
+    _data(nullptr),
+    _bytes(nullptr),
+    _scale(1.0),
+    _labels(false),
+    _entries(data.size()),
+    _points(data.empty() ? 0 : data.front().size())
+{
+
+    _storage.reserve(_entries * _points);
+
+    for (const auto& values : data) {
+
+        if (values.size() != _points) {
+
+            throw std::invalid_argument("Invalid number of points!");
+
+        }
+
+        _storage.insert(_storage.end(), values.begin(), values.end());
+
+    }
+
+    _data = _storage.data();
+
+}
+
+// ================================================================================================
+// Construct a dataset that takes ownership of contiguous sample values
+// ================================================================================================
+Dataset::Dataset(
+    std::vector<double>&& values,
+    const std::size_t points
+):
+    _mapping(nullptr),
+    _length(0),
+    _storage(std::move(values)),
+    _data(_storage.data()),
+    _bytes(nullptr),
+    _scale(1.0),
+    _labels(false),
+    _entries(points == 0 ? 0 : _storage.size() / points),
+    _points(points)
+{
+
+    if (points == 0 || _storage.size() % points != 0) {
+
+        throw std::invalid_argument("Invalid number of points!");
+
+    }
+
+}
+
+// ================================================================================================
+// Destructor
+// ================================================================================================
+Dataset::~Dataset() {
+
+    if (_mapping) {
+
+        munmap(_mapping, _length);
+
+    }
+
+}
+
+// ================================================================================================
+// Get the number of samples in the dataset
+// ================================================================================================
+std::size_t Dataset::getSize() const {
+
+    return _entries;
+
+}
+
+// ================================================================================================
+// Get the number of points per sample
+// ================================================================================================
+std::size_t Dataset::getPoints() const {
+
+    return _points;
+
+}
+
+// ================================================================================================
+// Get a pointer to the points of a sample without copying them, nullptr for compact datasets
+// ================================================================================================
+const double* Dataset::getData(const std::size_t index) const {
+
+    return _data ? _data + index * _points : nullptr;
+
+}
+
+// ================================================================================================
+// Copy the points of a sample to a buffer, expanding compact samples on the fly
+// ================================================================================================
+void Dataset::getSample(const std::size_t index, double* const destination) const {
+
+    PROFILE_SCOPE(PHASE_IO, profiler::NO_LAYER);
+
+    readSample(index, destination);
+
+}
+
+// ================================================================================================
+// Copy the points of a range of consecutive samples to a buffer, one sample after another
+// ================================================================================================
+void Dataset::getSamples(const std::size_t first, const std::size_t count, double* const destination) const {
+
+    PROFILE_SCOPE(PHASE_IO, profiler::NO_LAYER);
+
+    for (std::size_t sample = 0; sample < count; sample++) {
+
+        readSample(first + sample, destination + sample * _points);
+
+    }
+
+}
+
+// ================================================================================================
+// Copy the points of a sample to a buffer without recording the access
+// ================================================================================================
+void Dataset::readSample(const std::size_t index, double* const destination) const {
+
+    if (_data) {
+
+        std::copy(_data + index * _points, _data + (index + 1) * _points, destination);
+
+    } else if (_labels) {
+
+        std::fill(destination, destination + _points, 0.0);
+        destination[_bytes[index]] = 1.0;
+
+    } else {
+
+        const std::uint8_t* const values = _bytes + index * _points;
+
+        for (std::size_t point = 0; point < _points; point++) {
+
+            destination[point] = values[point] * _scale;
+
+        }
+
+    }
+
+}
+
+// ================================================================================================
+// Drop the mapped pages of a range of samples that will not be read again soon
+// ================================================================================================
+void Dataset::release(const std::size_t first, const std::size_t count) const {
+
+    if (!_mapping) { return; }
+
+    const std::size_t stride = _data ? _points * sizeof(double) : (_labels ? 1 : _points);
+    const char* const samples = _data ? reinterpret_cast<const char*>(_data) : reinterpret_cast<const char*>(_bytes);
+    const std::uintptr_t page = sysconf(_SC_PAGESIZE);
+
+    // Only whole pages inside the range can be dropped without touching neighbouring samples
+    const std::uintptr_t start = (reinterpret_cast<std::uintptr_t>(samples + first * stride) + page - 1) / page * page;
+    const std::uintptr_t end = reinterpret_cast<std::uintptr_t>(samples + (first + count) * stride) / page * page;
+
+    if (end > start) {
+
+        madvise(reinterpret_cast<void*>(start), end - start, MADV_DONTNEED);
+
+    }
+
+}
+
+// ================================================================================================
+// Read the header of a mapped file and validate the size of its payload
+// ================================================================================================
+void Dataset::map(const std::size_t header) {
+
+    const char* const bytes = static_cast<const char*>(_mapping);
+
+    if (_length < header) {
+
+        munmap(_mapping, _length);
+        throw std::invalid_argument("Invalid dataset file!");
+
+    }
+
+    // Compact headers are not aligned, so the fields are copied out instead of read in place
+    const std::size_t offset = header == 2 * sizeof(std::size_t) ? 0 : DATASET_MAGIC_SIZE;
+
+    std::memcpy(&_entries, bytes + offset, sizeof(_entries));
+    std::memcpy(&_points, bytes + offset + sizeof(_entries), sizeof(_points));
+
+    const std::size_t payload = _length - header;
+
+    bool valid = _points != 0;
+
+    if (_labels) {
+
+        _bytes = reinterpret_cast<const std::uint8_t*>(bytes + header);
+        valid = valid && payload >= _entries && _points <= 256;
+
+        for (std::size_t entry = 0; valid && entry < _entries; entry++) {
+
+            valid = _bytes[entry] < _points;
+
+        }
+
+    } else if (offset > 0) {
+
+        std::memcpy(&_scale, bytes + offset + sizeof(_entries) + sizeof(_points), sizeof(_scale));
+
+        _bytes = reinterpret_cast<const std::uint8_t*>(bytes + header);
+        valid = valid && payload / _points >= _entries;
+
+    } else {
+
+        _data = reinterpret_cast<const double*>(bytes + header);
+        valid = valid && payload / sizeof(double) / _points >= _entries;
+
+    }
+
+    if (!valid) {
+
+        munmap(_mapping, _length);
+        throw std::invalid_argument("Invalid dataset file!");
+
+    }
+
+}
\ No newline at end of file
@@ -0,0 +1,283 @@
+#include "DatasetStream.h"
+#include "RNG.h"
+#include "Profiler.h"
+#include <stdexcept>
+#include <algorithm>
+#include <utility>
+
+// ================================================================================================
+// Shuffle a list of indices with a generator that only depends on the seed of a stream, an epoch and a chunk
+// ================================================================================================
+// Orders can be reproduced on resume this way, no matter which thread shuffles them or what it shuffled before
+static void shuffle(std::vector<std::size_t>& indices, const std::uint64_t seed, const std::uint64_t epoch, const std::uint64_t chunk) {
+
+    rng::Generator generator = rng::Generator(seed, epoch).split(chunk);
+
+    for (std::size_t index = indices.size(); index > 1; index--) {
+
+        std::swap(indices[index - 1], indices[generator.range<std::size_t>(0, index - 1)]);
+
+    }
+
+}
+
+// ================================================================================================
+// Constructor
+// ================================================================================================
+DatasetStream::DatasetStream(
+    const Dataset& inputs,
+    const Dataset& targets,
+    const std::size_t chunkSize,
+    const bool shuffle,
+    const std::uint64_t seed
+):
+    _inputs(inputs),
+    _targets(targets),
+    _chunkSize(chunkSize),
+    _shuffle(shuffle),
+    _seed(seed),
+    _epoch(0),
+    _position(0),
+    _skip(0),
+    _offset(0),
+    _started(false)
+{
+
+    if (_inputs.getSize() != _targets.getSize()) {
+
+        throw std::invalid_argument("Number of inputs and targets do not match!");
+
+    }
+
+    if (_shuffle && _chunkSize == 0) {
+
+        throw std::invalid_argument("Shuffling requires a chunk size!");
+
+    }
+
+    // Without a chunk size the whole dataset is a single chunk that is used in place
+    const std::size_t chunks = _chunkSize == 0 ? 1 : (_inputs.getSize() + _chunkSize - 1) / _chunkSize;
+
+    for (std::size_t chunk = 0; chunk < chunks; chunk++) {
+
+        _order.push_back(chunk);
+
+    }
+
+}
+
+// ================================================================================================
+// Destructor
+// ================================================================================================
+DatasetStream::~DatasetStream() {
+
+    // The prefetch thread reads from the datasets, so it has to finish before they can go away
+    if (_next.valid()) {
+
+        _next.wait();
+
+    }
+
+}
+
+// ================================================================================================
+// Get the number of samples in one epoch
+// ================================================================================================
+std::size_t DatasetStream::getSize() {
+
+    return _inputs.getSize();
+
+}
+
+// ================================================================================================
+// Get the number of chunks in one epoch
+// ================================================================================================
+std::size_t DatasetStream::getChunkCount() {
+
+    return _order.size();
+
+}
+
+// ================================================================================================
+// Start an epoch at one of its samples, optionally in its own chunk order, and begin loading its first chunk
+// ================================================================================================
+// Chunks before the sample are skipped without being loaded, the offset of the sample in its chunk is
+// left for the caller to skip
+void DatasetStream::reset(const std::uint64_t epoch, const std::size_t sample) {
+
+    if (_next.valid()) {
+
+        _next.get();
+
+    }
+
+    if (sample > getSize()) {
+
+        throw std::invalid_argument("Sample is outside of the epoch!");
+
+    }
+
+    for (std::size_t index = 0; index < _order.size(); index++) {
+
+        _order[index] = index;
+
+    }
+
+    if (_shuffle) {
+
+        shuffle(_order, _seed, epoch, 0);
+
+    }
+
+    _epoch = epoch;
+    _position = 0;
+    _skip = sample;
+    _offset = 0;
+    _started = true;
+    _current = Chunk();
+
+    while (_position < _order.size() && _skip >= getChunkSize(_order[_position])) {
+
+        _skip -= getChunkSize(_order[_position]);
+        _position++;
+
+    }
+
+    prefetch();
+
+}
+
+// ================================================================================================
+// Advance to the next chunk and begin loading the one after it, false at the end of the epoch
+// ================================================================================================
+bool DatasetStream::next() {
+
+    // Waiting for a chunk that is still being prefetched counts as reading
+    PROFILE_SCOPE(PHASE_IO, profiler::NO_LAYER);
+
+    if (!_started) {
+
+        throw std::logic_error("Stream has to be reset before the first chunk!");
+
+    }
+
+    if (_position == _order.size()) {
+
+        _current = Chunk();
+        return false;
+
+    }
+
+    if (_chunkSize != 0) {
+
+        _current = _next.get();
+
+    }
+
+    _position++;
+    _offset = _skip;
+    _skip = 0;
+
+    prefetch();
+
+    return true;
+
+}
+
+// ================================================================================================
+// Get the number of samples at the start of the current chunk that an earlier run already trained on
+// ================================================================================================
+std::size_t DatasetStream::getOffset() {
+
+    return _offset;
+
+}
+
+// ================================================================================================
+// Get the inputs of the current chunk
+// ================================================================================================
+const Dataset& DatasetStream::getInputs() {
+
+    return _current.inputs ? *_current.inputs : _inputs;
+
+}
+
+// ================================================================================================
+// Get the targets of the current chunk
+// ================================================================================================
+const Dataset& DatasetStream::getTargets() {
+
+    return _current.targets ? *_current.targets : _targets;
+
+}
+
+// ================================================================================================
+// Load the next chunk in the background while the current one is used
+// ================================================================================================
+void DatasetStream::prefetch() {
+
+    if (_chunkSize == 0 || _position == _order.size()) { return; }
+
+    _next = std::async(std::launch::async, &DatasetStream::load, this, _epoch, _order[_position]);
+
+}
+
+// ================================================================================================
+// Get the number of samples in a chunk, which is only smaller than the chunk size for the last one
+// ================================================================================================
+std::size_t DatasetStream::getChunkSize(const std::size_t chunk) {
+
+    if (_chunkSize == 0) { return _inputs.getSize(); }
+
+    return std::min(_chunkSize, _inputs.getSize() - chunk * _chunkSize);
+
+}
+
+// ================================================================================================
+// Copy a chunk of samples out of the datasets, optionally in a random order
+// ================================================================================================
+DatasetStream::Chunk DatasetStream::load(const std::uint64_t epoch, const std::size_t chunk) {
+
+    const std::size_t first = chunk * _chunkSize;
+    const std::size_t samples = getChunkSize(chunk);
+    const std::size_t inputPoints = _inputs.getPoints();
+    const std::size_t targetPoints = _targets.getPoints();
+
+    std::vector<std::size_t> positions(samples);
+
+    for (std::size_t sample = 0; sample < samples; sample++) {
+
+        positions[sample] = sample;
+
+    }
+
+    // The chunk order of an epoch is shuffled with chunk 0, so the samples of a chunk use the one after it
+    if (_shuffle) {
+
+        shuffle(positions, _seed, epoch, chunk + 1);
+
+    }
+
+    std::vector<double> inputs(samples * inputPoints);
+    std::vector<double> targets(samples * targetPoints);
+
+    // The files are read front to back and the samples are scattered to their shuffled positions
+    for (std::size_t sample = 0; sample < samples; sample++) {
+
+        _inputs.getSample(first + sample, inputs.data() + positions[sample] * inputPoints);
+        _targets.getSample(first + sample, targets.data() + positions[sample] * targetPoints);
+
+    }
+
+    // Read chunks are not needed again until the next epoch, so their pages can be reclaimed early
+    _inputs.release(first, samples);
+    _targets.release(first, samples);
+
+    Chunk result;
+
+    result.inputs = std::make_unique<Dataset>(std::move(inputs), inputPoints);
+    result.targets = std::make_unique<Dataset>(std::move(targets), targetPoints);
+
+    return result;
+
+}
\ No newline at end of file
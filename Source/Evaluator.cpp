@@ -0,0 +1,314 @@
+#include "Evaluator.h"
+#include "Network.h"
+#include "NetworkMapped.h"
+#include "Kernels.h"
+#include "Profiler.h"
+#include <stdexcept>
+#include <algorithm>
+
+// ================================================================================================
+// Constructor
+// ================================================================================================
+Evaluator::Evaluator(
+    Network* const network,
+    const std::size_t threads,
+    const std::size_t batchSize
+):
+    _network(network),
+    _mapped(nullptr),
+    _objective(network->getLossFunction()),
+    _batchSize(batchSize),
+    _pool(threads),
+    _workers(_pool.getThreadCount()),
+    _layers(network->getLayerCount())
+{
+
+    if (!isSupported(_network)) {
+
+        throw std::logic_error("Evaluation requires densely connected or pruned layers!");
+
+    }
+
+    allocate();
+
+}
+
+// ================================================================================================
+// Construct an evaluator for a network that is mapped from its file, which keeps no loss function
+// ================================================================================================
+Evaluator::Evaluator(
+    NetworkMapped* const network,
+    const loss::Function objective,
+    const std::size_t threads,
+    const std::size_t batchSize
+):
+    _network(nullptr),
+    _mapped(network),
+    _objective(objective),
+    _batchSize(batchSize),
+    _pool(threads),
+    _workers(_pool.getThreadCount()),
+    _layers(network->getLayerCount())
+{
+
+    allocate();
+
+}
+
+// ================================================================================================
+// Check if every layer of a network is connected through a dense or pruned weight matrix
+// ================================================================================================
+bool Evaluator::isSupported(Network* const network) {
+
+    for (std::size_t layer = 1; layer < network->getLayerCount(); layer++) {
+
+        if (!network->getLayer(layer)->isDense() && !network->getLayer(layer)->isPruned()) {
+
+            return false;
+
+        }
+
+    }
+
+    return true;
+
+}
+
+// ================================================================================================
+// Evaluate the network on every sample of a dataset split evenly across all threads
+// ================================================================================================
+Evaluation Evaluator::evaluate(const Dataset& inputs, const Dataset& targets) {
+
+    if (inputs.getSize() != targets.getSize()) {
+
+        throw std::invalid_argument("Number of inputs and targets do not match!");
+
+    }
+
+    // A network can be pruned between evaluations, so its weights are looked up again every time
+    setLayers();
+
+    if (inputs.getPoints() != _layers.front().neurons) {
+
+        throw std::invalid_argument("Invalid number of activations!");
+
+    }
+
+    if (targets.getPoints() != _layers.back().neurons) {
+
+        throw std::invalid_argument("Invalid number of targets!");
+
+    }
+
+    const std::size_t samples = inputs.getSize();
+    const std::size_t threads = _workers.size();
+
+    // Threads only share the weights, which are never written while evaluating
+    _pool.run([&](const std::size_t thread) {
+
+        evaluateRange(
+            _workers[thread],
+            inputs,
+            targets,
+            samples * thread / threads,
+            samples * (thread + 1) / threads
+        );
+
+    });
+
+    // Results are added up in thread order so the loss only depends on the thread count
+    Evaluation evaluation = {0, 0, 0.0, std::vector<std::size_t>(_workers.front().evaluation.confusion.size(), 0)};
+
+    for (const auto& worker : _workers) {
+
+        evaluation.samples += worker.evaluation.samples;
+        evaluation.correct += worker.evaluation.correct;
+        evaluation.loss += worker.evaluation.loss;
+
+        for (std::size_t index = 0; index < evaluation.confusion.size(); index++) {
+
+            evaluation.confusion[index] += worker.evaluation.confusion[index];
+
+        }
+
+    }
+
+    return evaluation;
+
+}
+
+// ================================================================================================
+// Get the number of threads used for evaluation
+// ================================================================================================
+std::size_t Evaluator::getThreadCount() {
+
+    return _workers.size();
+
+}
+
+// ================================================================================================
+// Size the scratch buffers of every worker for a full batch up front, so evaluating never allocates
+// ================================================================================================
+void Evaluator::allocate() {
+
+    if (_batchSize == 0) {
+
+        throw std::invalid_argument("Invalid batch size!");
+
+    }
+
+    setLayers();
+
+    const std::size_t classes = _layers.back().neurons;
+
+    for (auto& worker : _workers) {
+
+        worker.activations.resize(_layers.size());
+
+        for (std::size_t layer = 0; layer < _layers.size(); layer++) {
+
+            worker.activations[layer].resize(_batchSize * _layers[layer].neurons);
+
+        }
+
+        worker.targets.resize(_batchSize * classes);
+        worker.evaluation.confusion.resize(classes * classes);
+
+    }
+
+}
+
+// ================================================================================================
+// Look up the weights of every layer of the evaluated network
+// ================================================================================================
+void Evaluator::setLayers() {
+
+    if (_mapped) {
+
+        for (std::size_t layer = 0; layer < _layers.size(); layer++) {
+
+            _layers[layer] = {
+                _mapped->getWeights(layer),
+                _mapped->getBiases(layer),
+                _mapped->getRows(layer),
+                _mapped->getColumns(layer),
+                _mapped->getNeuronCount(layer),
+                _mapped->getActivation(layer)
+            };
+
+        }
+
+        return;
+
+    }
+
+    _objective = _network->getLossFunction();
+
+    for (std::size_t layer = 0; layer < _layers.size(); layer++) {
+
+        Layer* const current = _network->getLayer(layer);
+
+        const bool pruned = layer > 0 && current->isPruned();
+
+        _layers[layer] = {
+            layer > 0 ? current->getWeights() : nullptr,
+            layer > 0 ? current->getBiases() : nullptr,
+            pruned ? current->getRows() : nullptr,
+            pruned ? current->getColumns() : nullptr,
+            current->getNeuronCount(),
+            current->getActivation()
+        };
+
+    }
+
+}
+
+// ================================================================================================
+// Evaluate a range of samples in batches into the results of a worker
+// ================================================================================================
+void Evaluator::evaluateRange(Worker& worker, const Dataset& inputs, const Dataset& targets, const std::size_t first, const std::size_t last) {
+
+    worker.evaluation.samples = 0;
+    worker.evaluation.correct = 0;
+    worker.evaluation.loss = 0.0;
+
+    std::fill(worker.evaluation.confusion.begin(), worker.evaluation.confusion.end(), 0);
+
+    for (std::size_t offset = first; offset < last; offset += _batchSize) {
+
+        evaluateBatch(worker, inputs, targets, offset, std::min(_batchSize, last - offset));
+
+    }
+
+}
+
+// ================================================================================================
+// Run a batch of samples through the network and score its outputs in the same pass
+// ================================================================================================
+void Evaluator::evaluateBatch(Worker& worker, const Dataset& inputs, const Dataset& targets, const std::size_t offset, const std::size_t samples) {
+
+    const std::size_t layers = _layers.size();
+
+    inputs.getSamples(offset, samples, worker.activations[0].data());
+
+    for (std::size_t layer = 1; layer < layers; layer++) {
+
+        PROFILE_SCOPE(PHASE_FORWARD, layer);
+
+        const View& current = _layers[layer];
+
+        const std::size_t rows = current.neurons;
+        const std::size_t columns = _layers[layer - 1].neurons;
+
+        const double* const layerInputs = worker.activations[layer - 1].data();
+        double* const layerOutputs = worker.activations[layer].data();
+
+        if (!current.rows) {
+
+            kernels::inferBatch(current.weights, current.biases, layerInputs, layerOutputs, samples, rows, columns, current.activation);
+            continue;
+
+        }
+
+        // Pruned layers have no batched kernel, so their samples are inferred one at a time
+        for (std::size_t sample = 0; sample < samples; sample++) {
+
+            kernels::inferSparse(
+                current.rows,
+                current.columns,
+                current.weights,
+                current.biases,
+                layerInputs + sample * columns,
+                layerOutputs + sample * rows,
+                rows,
+                current.activation
+            );
+
+        }
+
+    }
+
+    const std::size_t classes = _layers.back().neurons;
+    const activation::Function function = _layers.back().activation;
+    const double* const outputs = worker.activations[layers - 1].data();
+
+    targets.getSamples(offset, samples, worker.targets.data());
+
+    for (std::size_t sample = 0; sample < samples; sample++) {
+
+        const double* const output = outputs + sample * classes;
+        const double* const target = worker.targets.data() + sample * classes;
+
+        const std::size_t guess = std::max_element(output, output + classes) - output;
+        const std::size_t expected = std::max_element(target, target + classes) - target;
+
+        worker.evaluation.loss += kernels::loss(output, target, classes, function, _objective);
+        worker.evaluation.confusion[expected * classes + guess]++;
+
+        if (guess == expected) { worker.evaluation.correct++; }
+
+    }
+
+    worker.evaluation.samples += samples;
+
+}
\ No newline at end of file
@@ -0,0 +1,788 @@
+#include "Kernels.h"
+#include <algorithm>
+#include <limits>
+
+#define BLOCK_SAMPLES 32
+#define BLOCK_ROWS 32
+#define BLOCK_COLUMNS 128
+
+// ================================================================================================
+// Apply an elementwise activation function chosen at compile time to a set of values
+// ================================================================================================
+template <activation::Function F, typename T>
+static void activateElementwise(T* const values, const std::size_t rows) {
+
+    for (std::size_t row = 0; row < rows; row++) {
+
+        values[row] = activation::apply<F>(values[row]);
+
+    }
+
+}
+
+// ================================================================================================
+// Scale a set of deltas by the derivative of an elementwise activation function chosen at compile time
+// ================================================================================================
+template <activation::Function F, typename T>
+static void scaleElementwise(const T* const activations, T* const deltas, const std::size_t rows) {
+
+    for (std::size_t row = 0; row < rows; row++) {
+
+        deltas[row] *= activation::derivative<F>(activations[row]);
+
+    }
+
+}
+
+// ================================================================================================
+// Apply an activation function to the summed inputs of a layer in place
+// ================================================================================================
+// The function is only switched on once per layer, so the loops themselves have no dispatch
+template <typename T>
+void kernels::activate(
+    T* const values,
+    const std::size_t rows,
+    const activation::Function function
+) {
+
+    switch (function) {
+
+        case activation::RELU: activateElementwise<activation::RELU>(values, rows); break;
+        case activation::LEAKY_RELU: activateElementwise<activation::LEAKY_RELU>(values, rows); break;
+        case activation::TANH: activateElementwise<activation::TANH>(values, rows); break;
+
+        case activation::SOFTMAX: {
+
+            // Subtracting the largest input keeps every exponential at or below one
+            const T largest = *std::max_element(values, values + rows);
+
+            T sum = 0;
+
+            for (std::size_t row = 0; row < rows; row++) {
+
+                values[row] = std::exp(values[row] - largest);
+                sum += values[row];
+
+            }
+
+            for (std::size_t row = 0; row < rows; row++) {
+
+                values[row] /= sum;
+
+            }
+
+            break;
+
+        }
+
+        default: activateElementwise<activation::SIGMOID>(values, rows); break;
+
+    }
+
+}
+
+// ================================================================================================
+// Activate a dense layer from a row-major weight matrix and the activations of its input layer
+// ================================================================================================
+template <typename T>
+void kernels::forward(
+    const T* const weights,
+    const T* const biases,
+    const T* const inputs,
+    T* const outputs,
+    const std::size_t rows,
+    const std::size_t columns,
+    const activation::Function function
+) {
+
+    for (std::size_t row = 0; row < rows; row++) {
+
+        const T* const weight = weights + row * columns;
+
+        T activation = biases[row];
+
+        for (std::size_t column = 0; column < columns; column++) {
+
+            activation += inputs[column] * weight[column];
+
+        }
+
+        outputs[row] = activation;
+
+    }
+
+    activate(outputs, rows, function);
+
+}
+
+// ================================================================================================
+// Activate a quantised dense layer from int8 weights and inputs with per-row dequantisation scales
+// ================================================================================================
+void kernels::forward(
+    const std::int8_t* const weights,
+    const float* const scales,
+    const float* const biases,
+    const std::int8_t* const inputs,
+    float* const outputs,
+    const std::size_t rows,
+    const std::size_t columns
+) {
+
+    for (std::size_t row = 0; row < rows; row++) {
+
+        const std::int8_t* const weight = weights + row * columns;
+
+        std::int32_t accumulator = 0;
+
+        for (std::size_t column = 0; column < columns; column++) {
+
+            accumulator += inputs[column] * weight[column];
+
+        }
+
+        outputs[row] = activation::apply<activation::SIGMOID>(biases[row] + accumulator * scales[row]);
+
+    }
+
+}
+
+// ================================================================================================
+// Activate a pruned layer whose weights are stored as compressed sparse rows
+// ================================================================================================
+void kernels::forwardSparse(
+    const std::uint64_t* const offsets,
+    const std::uint32_t* const indices,
+    const double* const values,
+    const double* const biases,
+    const double* const inputs,
+    double* const outputs,
+    const std::size_t rows,
+    const activation::Function function
+) {
+
+    for (std::size_t row = 0; row < rows; row++) {
+
+        double activation = biases[row];
+
+        for (std::uint64_t entry = offsets[row]; entry < offsets[row + 1]; entry++) {
+
+            activation += inputs[indices[entry]] * values[entry];
+
+        }
+
+        outputs[row] = activation;
+
+    }
+
+    activate(outputs, rows, function);
+
+}
+
+// ================================================================================================
+// Get the cross-entropy of a single output against its target
+// ================================================================================================
+// Outputs are clamped to the smallest normal value, so a saturated output costs a large but finite loss,
+// and terms whose coefficient is zero are skipped so they never evaluate the logarithm of zero
+template <typename T>
+static T getCrossEntropy(const T output, const T target, const activation::Function function) {
+
+    const T smallest = std::numeric_limits<T>::min();
+
+    T entropy = target != T(0) ? -target * std::log(std::max(output, smallest)) : T(0);
+
+    // Sigmoid outputs are independent probabilities, so their complement adds the binary term
+    if (function != activation::SOFTMAX && target != T(1)) {
+
+        entropy -= (T(1) - target) * std::log(std::max(T(1) - output, smallest));
+
+    }
+
+    return entropy;
+
+}
+
+// ================================================================================================
+// Calculate the output layer deltas for a given set of targets and get their summed loss
+// ================================================================================================
+// With cross-entropy the derivative of the output function cancels out and the deltas are fused into a
+// single pass of t - p. Softmax outputs under squared error depend on every input of the layer, so their
+// deltas go through the full Jacobian and the rows have to belong to a single sample
+template <typename T>
+T kernels::error(
+    const T* const outputs,
+    const T* const targets,
+    T* const deltas,
+    const std::size_t rows,
+    const activation::Function function,
+    const loss::Function objective
+) {
+
+    if (objective == loss::CROSS_ENTROPY) {
+
+        for (std::size_t row = 0; row < rows; row++) {
+
+            deltas[row] = targets[row] - outputs[row];
+
+        }
+
+        T entropy = 0;
+
+        for (std::size_t row = 0; row < rows; row++) {
+
+            entropy += getCrossEntropy(outputs[row], targets[row], function);
+
+        }
+
+        return entropy;
+
+    }
+
+    T loss = 0;
+
+    for (std::size_t row = 0; row < rows; row++) {
+
+        const T difference = targets[row] - outputs[row];
+
+        deltas[row] = difference;
+        loss += difference * difference;
+
+    }
+
+    if (function == activation::SOFTMAX) {
+
+        T weighted = 0;
+
+        for (std::size_t row = 0; row < rows; row++) {
+
+            weighted += deltas[row] * outputs[row];
+
+        }
+
+        for (std::size_t row = 0; row < rows; row++) {
+
+            deltas[row] = outputs[row] * (deltas[row] - weighted);
+
+        }
+
+    } else {
+
+        derivative(outputs, deltas, rows, function);
+
+    }
+
+    return loss;
+
+}
+
+// ================================================================================================
+// Propagate the deltas of a dense layer back to its inputs and update the weight matrix
+// ================================================================================================
+template <typename T>
+void kernels::backward(
+    T* const weights,
+    const T* const inputs,
+    const T* const deltas,
+    T* const inputDeltas,
+    const std::size_t rows,
+    const std::size_t columns,
+    const T rate
+) {
+
+    for (std::size_t row = 0; row < rows; row++) {
+
+        T* const weight = weights + row * columns;
+
+        const T delta = deltas[row];
+
+        if (inputDeltas) {
+
+            for (std::size_t column = 0; column < columns; column++) {
+
+                inputDeltas[column] += weight[column] * delta;
+                weight[column] += rate * inputs[column] * delta;
+
+            }
+
+        } else {
+
+            for (std::size_t column = 0; column < columns; column++) {
+
+                weight[column] += rate * inputs[column] * delta;
+
+            }
+
+        }
+
+    }
+
+}
+
+// ================================================================================================
+// Propagate the deltas of a pruned layer back to its inputs and update its remaining weights
+// ================================================================================================
+void kernels::backwardSparse(
+    const std::uint64_t* const offsets,
+    const std::uint32_t* const indices,
+    double* const values,
+    const double* const inputs,
+    const double* const deltas,
+    double* const inputDeltas,
+    const std::size_t rows,
+    const double rate
+) {
+
+    for (std::size_t row = 0; row < rows; row++) {
+
+        const double delta = deltas[row];
+
+        for (std::uint64_t entry = offsets[row]; entry < offsets[row + 1]; entry++) {
+
+            const std::uint32_t column = indices[entry];
+
+            if (inputDeltas) {
+
+                inputDeltas[column] += values[entry] * delta;
+
+            }
+
+            values[entry] += rate * inputs[column] * delta;
+
+        }
+
+    }
+
+}
+
+// ================================================================================================
+// Scale the accumulated deltas by the derivative of the activation function
+// ================================================================================================
+// Softmax is limited to output layers, whose deltas come from the error kernel instead
+template <typename T>
+void kernels::derivative(
+    const T* const activations,
+    T* const deltas,
+    const std::size_t rows,
+    const activation::Function function
+) {
+
+    switch (function) {
+
+        case activation::RELU: scaleElementwise<activation::RELU>(activations, deltas, rows); break;
+        case activation::LEAKY_RELU: scaleElementwise<activation::LEAKY_RELU>(activations, deltas, rows); break;
+        case activation::TANH: scaleElementwise<activation::TANH>(activations, deltas, rows); break;
+        default: scaleElementwise<activation::SIGMOID>(activations, deltas, rows); break;
+
+    }
+
+}
+
+// ================================================================================================
+// Update the biases of a layer with its deltas
+// ================================================================================================
+template <typename T>
+void kernels::update(
+    T* const biases,
+    const T* const deltas,
+    const std::size_t rows,
+    const T rate
+) {
+
+    for (std::size_t row = 0; row < rows; row++) {
+
+        biases[row] += rate * deltas[row];
+
+    }
+
+}
+
+// ================================================================================================
+// Activate a dense layer for a batch of samples, one sample per row of inputs and outputs
+// ================================================================================================
+void kernels::forwardBatch(
+    const double* const weights,
+    const double* const biases,
+    const double* const inputs,
+    double* const outputs,
+    const std::size_t samples,
+    const std::size_t rows,
+    const std::size_t columns,
+    const activation::Function function
+) {
+
+    static thread_local double packed[BLOCK_COLUMNS * BLOCK_ROWS];
+
+    for (std::size_t sample = 0; sample < samples; sample++) {
+
+        std::copy(biases, biases + rows, outputs + sample * rows);
+
+    }
+
+    for (std::size_t rowBlock = 0; rowBlock < rows; rowBlock += BLOCK_ROWS) {
+
+        const std::size_t blockRows = std::min<std::size_t>(BLOCK_ROWS, rows - rowBlock);
+
+        for (std::size_t columnBlock = 0; columnBlock < columns; columnBlock += BLOCK_COLUMNS) {
+
+            const std::size_t blockColumns = std::min<std::size_t>(BLOCK_COLUMNS, columns - columnBlock);
+
+            // Transpose the weight block so the innermost loop runs over contiguous rows
+            for (std::size_t row = 0; row < blockRows; row++) {
+
+                const double* const weight = weights + (rowBlock + row) * columns + columnBlock;
+
+                for (std::size_t column = 0; column < blockColumns; column++) {
+
+                    packed[column * blockRows + row] = weight[column];
+
+                }
+
+            }
+
+            for (std::size_t sample = 0; sample < samples; sample++) {
+
+                const double* const input = inputs + sample * columns + columnBlock;
+                double* const output = outputs + sample * rows + rowBlock;
+
+                for (std::size_t column = 0; column < blockColumns; column++) {
+
+                    const double activation = input[column];
+                    const double* const weight = packed + column * blockRows;
+
+                    for (std::size_t row = 0; row < blockRows; row++) {
+
+                        output[row] += activation * weight[row];
+
+                    }
+
+                }
+
+            }
+
+        }
+
+    }
+
+    for (std::size_t sample = 0; sample < samples; sample++) {
+
+        activate(outputs + sample * rows, rows, function);
+
+    }
+
+}
+
+// ================================================================================================
+// Propagate the deltas of a dense layer back to its inputs for a batch of samples
+// ================================================================================================
+void kernels::backwardBatch(
+    const double* const weights,
+    const double* const deltas,
+    double* const inputDeltas,
+    const std::size_t samples,
+    const std::size_t rows,
+    const std::size_t columns
+) {
+
+    std::fill(inputDeltas, inputDeltas + samples * columns, 0.0);
+
+    for (std::size_t columnBlock = 0; columnBlock < columns; columnBlock += BLOCK_COLUMNS) {
+
+        const std::size_t blockColumns = std::min<std::size_t>(BLOCK_COLUMNS, columns - columnBlock);
+
+        for (std::size_t rowBlock = 0; rowBlock < rows; rowBlock += BLOCK_ROWS) {
+
+            const std::size_t blockRows = std::min<std::size_t>(BLOCK_ROWS, rows - rowBlock);
+
+            for (std::size_t sample = 0; sample < samples; sample++) {
+
+                double* const inputDelta = inputDeltas + sample * columns + columnBlock;
+
+                for (std::size_t row = rowBlock; row < rowBlock + blockRows; row++) {
+
+                    const double delta = deltas[sample * rows + row];
+                    const double* const weight = weights + row * columns + columnBlock;
+
+                    for (std::size_t column = 0; column < blockColumns; column++) {
+
+                        inputDelta[column] += delta * weight[column];
+
+                    }
+
+                }
+
+            }
+
+        }
+
+    }
+
+}
+
+// ================================================================================================
+// Add the weight gradient of a batch of samples, scaled by the learning rate, to a weight matrix
+// ================================================================================================
+void kernels::accumulateBatch(
+    double* const weights,
+    const double* const inputs,
+    const double* const deltas,
+    const std::size_t samples,
+    const std::size_t rows,
+    const std::size_t columns,
+    const double rate
+) {
+
+    for (std::size_t sampleBlock = 0; sampleBlock < samples; sampleBlock += BLOCK_SAMPLES) {
+
+        const std::size_t blockSamples = std::min<std::size_t>(BLOCK_SAMPLES, samples - sampleBlock);
+
+        for (std::size_t columnBlock = 0; columnBlock < columns; columnBlock += BLOCK_COLUMNS) {
+
+            const std::size_t blockColumns = std::min<std::size_t>(BLOCK_COLUMNS, columns - columnBlock);
+
+            for (std::size_t row = 0; row < rows; row++) {
+
+                double* const weight = weights + row * columns + columnBlock;
+
+                for (std::size_t sample = sampleBlock; sample < sampleBlock + blockSamples; sample++) {
+
+                    const double delta = rate * deltas[sample * rows + row];
+                    const double* const input = inputs + sample * columns + columnBlock;
+
+                    for (std::size_t column = 0; column < blockColumns; column++) {
+
+                        weight[column] += delta * input[column];
+
+                    }
+
+                }
+
+            }
+
+        }
+
+    }
+
+}
+
+// ================================================================================================
+// Add the bias gradient of a batch of samples, scaled by the learning rate, to a bias vector
+// ================================================================================================
+void kernels::updateBatch(
+    double* const biases,
+    const double* const deltas,
+    const std::size_t samples,
+    const std::size_t rows,
+    const double rate
+) {
+
+    for (std::size_t sample = 0; sample < samples; sample++) {
+
+        update(biases, deltas + sample * rows, rows, rate);
+
+    }
+
+}
+
+// ================================================================================================
+// Apply a gradient to a set of parameters with an optimizer method chosen at compile time
+// ================================================================================================
+// Gradients point in the direction the parameters move in, the same as the deltas they come from
+template <optimizer::Method M>
+static void optimizeElementwise(
+    double* const parameters,
+    const double* const gradients,
+    double* const first,
+    double* const second,
+    const std::size_t count,
+    const double scale,
+    const optimizer::Step& step
+) {
+
+    const double rate = step.rate;
+    const double momentum = step.momentum;
+
+    // Adam folds the bias corrections of both moments into its step size and epsilon
+    const double size = step.rate / step.correction1;
+    const double root = 1.0 / std::sqrt(step.correction2);
+
+    for (std::size_t index = 0; index < count; index++) {
+
+        const double gradient = scale * gradients[index];
+
+        if constexpr (M == optimizer::MOMENTUM) {
+
+            first[index] = momentum * first[index] + gradient;
+            parameters[index] += rate * first[index];
+
+        } else if constexpr (M == optimizer::NESTEROV) {
+
+            first[index] = momentum * first[index] + gradient;
+            parameters[index] += rate * (gradient + momentum * first[index]);
+
+        } else {
+
+            first[index] = step.beta1 * first[index] + (1.0 - step.beta1) * gradient;
+            second[index] = step.beta2 * second[index] + (1.0 - step.beta2) * gradient * gradient;
+            parameters[index] += size * first[index] / (std::sqrt(second[index]) * root + step.epsilon);
+
+        }
+
+    }
+
+}
+
+// ================================================================================================
+// Apply the gradient of a set of parameters with the optimizer of a step and update its state
+// ================================================================================================
+// The state holds every value an optimizer keeps per parameter as its own block, stride values apart,
+// so a slice of the parameters can be updated with the matching slice of the state
+void kernels::optimize(
+    double* const parameters,
+    const double* const gradients,
+    double* const state,
+    const std::size_t stride,
+    const std::size_t count,
+    const double scale,
+    const optimizer::Step& step
+) {
+
+    switch (step.method) {
+
+        case optimizer::MOMENTUM: optimizeElementwise<optimizer::MOMENTUM>(parameters, gradients, state, nullptr, count, scale, step); break;
+        case optimizer::NESTEROV: optimizeElementwise<optimizer::NESTEROV>(parameters, gradients, state, nullptr, count, scale, step); break;
+        case optimizer::ADAM: optimizeElementwise<optimizer::ADAM>(parameters, gradients, state, state + stride, count, scale, step); break;
+
+        default: {
+
+            for (std::size_t index = 0; index < count; index++) {
+
+                parameters[index] += step.rate * scale * gradients[index];
+
+            }
+
+            break;
+
+        }
+
+    }
+
+}
+
+// ================================================================================================
+// Apply the weight gradient of a single sample, the outer product of its deltas and inputs, with an optimizer
+// ================================================================================================
+// The gradient of a row is its inputs scaled by its delta, so it is never written out to memory
+void kernels::optimizeOuter(
+    double* const weights,
+    const double* const inputs,
+    const double* const deltas,
+    double* const state,
+    const std::size_t rows,
+    const std::size_t columns,
+    const optimizer::Step& step
+) {
+
+    const std::size_t stride = rows * columns;
+
+    for (std::size_t row = 0; row < rows; row++) {
+
+        double* const parameters = weights + row * columns;
+        double* const first = state + row * columns;
+
+        switch (step.method) {
+
+            case optimizer::MOMENTUM: optimizeElementwise<optimizer::MOMENTUM>(parameters, inputs, first, nullptr, columns, deltas[row], step); break;
+            case optimizer::NESTEROV: optimizeElementwise<optimizer::NESTEROV>(parameters, inputs, first, nullptr, columns, deltas[row], step); break;
+            case optimizer::ADAM: optimizeElementwise<optimizer::ADAM>(parameters, inputs, first, first + stride, columns, deltas[row], step); break;
+
+            default: {
+
+                for (std::size_t column = 0; column < columns; column++) {
+
+                    parameters[column] += step.rate * deltas[row] * inputs[column];
+
+                }
+
+                break;
+
+            }
+
+        }
+
+    }
+
+}
+
+// ================================================================================================
+// Get the summed loss of a set of outputs
+// ================================================================================================
+template <typename T>
+T kernels::loss(
+    const T* const outputs,
+    const T* const targets,
+    const std::size_t rows,
+    const activation::Function function,
+    const loss::Function objective
+) {
+
+    T sum = 0;
+
+    if (objective == loss::CROSS_ENTROPY) {
+
+        for (std::size_t row = 0; row < rows; row++) {
+
+            sum += getCrossEntropy(outputs[row], targets[row], function);
+
+        }
+
+        return sum;
+
+    }
+
+    for (std::size_t row = 0; row < rows; row++) {
+
+        const T difference = outputs[row] - targets[row];
+
+        sum += difference * difference;
+
+    }
+
+    return sum;
+
+}
+
+// ================================================================================================
+// Get the dot product of two vectors
+// ================================================================================================
+double kernels::dot(
+    const double* const left,
+    const double* const right,
+    const std::size_t rows
+) {
+
+    double sum = 0.0;
+
+    for (std::size_t row = 0; row < rows; row++) {
+
+        sum += left[row] * right[row];
+
+    }
+
+    return sum;
+
+}
+
+// Instantiate the per-sample kernels for single and double precision networks
+template void kernels::activate(float* const, const std::size_t, const activation::Function);
+template void kernels::activate(double* const, const std::size_t, const activation::Function);
+template void kernels::forward(const float* const, const float* const, const float* const, float* const, const std::size_t, const std::size_t, const activation::Function);
+template void kernels::forward(const double* const, const double* const, const double* const, double* const, const std::size_t, const std::size_t, const activation::Function);
+template float kernels::error(const float* const, const float* const, float* const, const std::size_t, const activation::Function, const loss::Function);
+template double kernels::error(const double* const, const double* const, double* const, const std::size_t, const activation::Function, const loss::Function);
+template void kernels::backward(float* const, const float* const, const float* const, float* const, const std::size_t, const std::size_t, const float);
+template void kernels::backward(double* const, const double* const, const double* const, double* const, const std::size_t, const std::size_t, const double);
+template void kernels::derivative(const float* const, float* const, const std::size_t, const activation::Function);
+template void kernels::derivative(const double* const, double* const, const std::size_t, const activation::Function);
+template void kernels::update(float* const, const float* const, const std::size_t, const float);
+template void kernels::update(double* const, const double* const, const std::size_t, const double);
+template float kernels::loss(const float* const, const float* const, const std::size_t, const activation::Function, const loss::Function);
+template double kernels::loss(const double* const, const double* const, const std::size_t, const activation::Function, const loss::Function);
\ No newline at end of file
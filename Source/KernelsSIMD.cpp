@@ -0,0 +1,1368 @@
+#include "Kernels.h"
+#include <cstring>
+#include <algorithm>
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(__i386__)
+// GCC reports the deliberately undefined pass-through operand of the AVX-512 intrinsics as uninitialized
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#include <immintrin.h>
+#define KERNELS_X86
+#endif
+
+// Inputs to the exponential are clamped so the result stays a normal double
+#define EXP_LIMIT 708.0
+#define EXP_LOG2E 1.4426950408889634
+#define EXP_LN2_HIGH 0.693145751953125
+#define EXP_LN2_LOW 1.42860682030941723212e-6
+#define EXP_ROUND 6755399441055744.0
+
+// Taylor coefficients of exp(r) for |r| <= ln(2) / 2, the truncation error is below 1e-14
+static const double EXP_COEFFICIENTS[] = {
+    1.0 / 39916800.0,
+    1.0 / 3628800.0,
+    1.0 / 362880.0,
+    1.0 / 40320.0,
+    1.0 / 5040.0,
+    1.0 / 720.0,
+    1.0 / 120.0,
+    1.0 / 24.0,
+    1.0 / 6.0,
+    1.0 / 2.0,
+    1.0,
+    1.0
+};
+
+// Single precision uses the same reduction with float constants and a degree 7 polynomial
+#define EXPF_LIMIT 87.0f
+#define EXPF_LOG2E 1.44269504f
+#define EXPF_LN2_HIGH 0.693359375f
+#define EXPF_LN2_LOW -2.12194440e-4f
+#define EXPF_ROUND 12582912.0f
+
+static const float EXPF_COEFFICIENTS[] = {
+    1.0f / 5040.0f,
+    1.0f / 720.0f,
+    1.0f / 120.0f,
+    1.0f / 24.0f,
+    1.0f / 6.0f,
+    1.0f / 2.0f,
+    1.0f,
+    1.0f
+};
+
+typedef void (*Forward)(const double*, const double*, const double*, double*, std::size_t, std::size_t, activation::Function);
+typedef void (*ForwardF32)(const float*, const float*, const float*, float*, std::size_t, std::size_t, activation::Function);
+typedef void (*ForwardInt8)(const std::int8_t*, const float*, const float*, const std::int8_t*, float*, std::size_t, std::size_t);
+typedef void (*ForwardBatch)(const double*, const double*, const double*, double*, std::size_t, std::size_t, std::size_t, activation::Function);
+typedef void (*ForwardSparse)(const std::uint64_t*, const std::uint32_t*, const double*, const double*, const double*, double*, std::size_t, activation::Function);
+
+// ================================================================================================
+// Apply an activation function in place to a batch of summed inputs with the array kernels of an instruction set
+// ================================================================================================
+// The kernels are template arguments, so every instruction set gets its own copy without indirect
+// calls. Tanh reuses the sigmoid kernel as 2 * sigmoid(2x) - 1, softmax reuses the exponential
+// kernel and the ReLU variants need no approximation, so they share the exact kernel
+template <typename T, void (*Sigmoid)(T*, std::size_t), void (*Exponential)(T*, std::size_t)>
+static void activateWith(T* outputs, std::size_t samples, std::size_t rows, activation::Function function) {
+
+    const std::size_t count = samples * rows;
+
+    switch (function) {
+
+        case activation::RELU:
+        case activation::LEAKY_RELU: kernels::activate(outputs, count, function); break;
+
+        case activation::TANH: {
+
+            for (std::size_t index = 0; index < count; index++) { outputs[index] *= T(2); }
+
+            Sigmoid(outputs, count);
+
+            for (std::size_t index = 0; index < count; index++) { outputs[index] = T(2) * outputs[index] - T(1); }
+
+            break;
+
+        }
+
+        case activation::SOFTMAX: {
+
+            for (std::size_t sample = 0; sample < samples; sample++) {
+
+                T* const output = outputs + sample * rows;
+                const T largest = *std::max_element(output, output + rows);
+
+                for (std::size_t row = 0; row < rows; row++) { output[row] -= largest; }
+
+                Exponential(output, rows);
+
+                T sum = 0;
+
+                for (std::size_t row = 0; row < rows; row++) { sum += output[row]; }
+                for (std::size_t row = 0; row < rows; row++) { output[row] /= sum; }
+
+            }
+
+            break;
+
+        }
+
+        default: Sigmoid(outputs, count); break;
+
+    }
+
+}
+
+#ifdef KERNELS_X86
+
+// ================================================================================================
+// Approximate exp(x) for two doubles with SSE2
+// ================================================================================================
+// Min and max return their second operand for NaN, so x goes last to keep NaN as the scalar exp does
+__attribute__((target("sse2")))
+static __m128d expSSE2(__m128d x) {
+
+    x = _mm_min_pd(_mm_set1_pd(EXP_LIMIT), _mm_max_pd(_mm_set1_pd(-EXP_LIMIT), x));
+
+    const __m128d shifted = _mm_add_pd(_mm_mul_pd(x, _mm_set1_pd(EXP_LOG2E)), _mm_set1_pd(EXP_ROUND));
+    const __m128d k = _mm_sub_pd(shifted, _mm_set1_pd(EXP_ROUND));
+
+    __m128d r = _mm_sub_pd(x, _mm_mul_pd(k, _mm_set1_pd(EXP_LN2_HIGH)));
+    r = _mm_sub_pd(r, _mm_mul_pd(k, _mm_set1_pd(EXP_LN2_LOW)));
+
+    __m128d p = _mm_set1_pd(EXP_COEFFICIENTS[0]);
+
+    for (std::size_t index = 1; index < sizeof(EXP_COEFFICIENTS) / sizeof(double); index++) {
+
+        p = _mm_add_pd(_mm_mul_pd(p, r), _mm_set1_pd(EXP_COEFFICIENTS[index]));
+
+    }
+
+    // The low mantissa bits of the shifted value hold k, which becomes the exponent of 2^k
+    __m128i exponent = _mm_sub_epi64(_mm_castpd_si128(shifted), _mm_castpd_si128(_mm_set1_pd(EXP_ROUND)));
+    exponent = _mm_slli_epi64(_mm_add_epi64(exponent, _mm_set1_epi64x(1023)), 52);
+
+    return _mm_mul_pd(p, _mm_castsi128_pd(exponent));
+
+}
+
+// ================================================================================================
+// Apply the sigmoid function to a set of activations in place with SSE2
+// ================================================================================================
+__attribute__((target("sse2")))
+static void sigmoidSSE2(double* outputs, std::size_t count) {
+
+    for (std::size_t index = 0; index < count; index += 2) {
+
+        double values[2] = {0.0, 0.0};
+        const std::size_t lanes = std::min<std::size_t>(2, count - index);
+
+        std::memcpy(values, outputs + index, lanes * sizeof(double));
+
+        const __m128d exponential = expSSE2(_mm_sub_pd(_mm_setzero_pd(), _mm_loadu_pd(values)));
+        _mm_storeu_pd(values, _mm_div_pd(_mm_set1_pd(1.0), _mm_add_pd(_mm_set1_pd(1.0), exponential)));
+
+        std::memcpy(outputs + index, values, lanes * sizeof(double));
+
+    }
+
+}
+
+// ================================================================================================
+// Apply exp(x) to a set of values in place with SSE2
+// ================================================================================================
+__attribute__((target("sse2")))
+static void exponentialSSE2(double* outputs, std::size_t count) {
+
+    for (std::size_t index = 0; index < count; index += 2) {
+
+        double values[2] = {0.0, 0.0};
+        const std::size_t lanes = std::min<std::size_t>(2, count - index);
+
+        std::memcpy(values, outputs + index, lanes * sizeof(double));
+        _mm_storeu_pd(values, expSSE2(_mm_loadu_pd(values)));
+        std::memcpy(outputs + index, values, lanes * sizeof(double));
+
+    }
+
+}
+
+// ================================================================================================
+// Activate a dense layer with SSE2
+// ================================================================================================
+__attribute__((target("sse2")))
+static void forwardSSE2(const double* weights, const double* biases, const double* inputs, double* outputs, std::size_t rows, std::size_t columns, activation::Function function) {
+
+    for (std::size_t row = 0; row < rows; row++) {
+
+        const double* const weight = weights + row * columns;
+
+        __m128d sum0 = _mm_setzero_pd();
+        __m128d sum1 = _mm_setzero_pd();
+
+        std::size_t column = 0;
+
+        for (; column + 4 <= columns; column += 4) {
+
+            sum0 = _mm_add_pd(sum0, _mm_mul_pd(_mm_loadu_pd(inputs + column), _mm_loadu_pd(weight + column)));
+            sum1 = _mm_add_pd(sum1, _mm_mul_pd(_mm_loadu_pd(inputs + column + 2), _mm_loadu_pd(weight + column + 2)));
+
+        }
+
+        double lanes[2];
+        _mm_storeu_pd(lanes, _mm_add_pd(sum0, sum1));
+
+        double activation = biases[row] + lanes[0] + lanes[1];
+
+        for (; column < columns; column++) {
+
+            activation += inputs[column] * weight[column];
+
+        }
+
+        outputs[row] = activation;
+
+    }
+
+    activateWith<double, sigmoidSSE2, exponentialSSE2>(outputs, 1, rows, function);
+
+}
+
+// ================================================================================================
+// Approximate exp(x) for four doubles with AVX2 and FMA
+// ================================================================================================
+__attribute__((target("avx2,fma")))
+static __m256d expAVX2(__m256d x) {
+
+    x = _mm256_min_pd(_mm256_set1_pd(EXP_LIMIT), _mm256_max_pd(_mm256_set1_pd(-EXP_LIMIT), x));
+
+    const __m256d shifted = _mm256_fmadd_pd(x, _mm256_set1_pd(EXP_LOG2E), _mm256_set1_pd(EXP_ROUND));
+    const __m256d k = _mm256_sub_pd(shifted, _mm256_set1_pd(EXP_ROUND));
+
+    __m256d r = _mm256_fnmadd_pd(k, _mm256_set1_pd(EXP_LN2_HIGH), x);
+    r = _mm256_fnmadd_pd(k, _mm256_set1_pd(EXP_LN2_LOW), r);
+
+    __m256d p = _mm256_set1_pd(EXP_COEFFICIENTS[0]);
+
+    for (std::size_t index = 1; index < sizeof(EXP_COEFFICIENTS) / sizeof(double); index++) {
+
+        p = _mm256_fmadd_pd(p, r, _mm256_set1_pd(EXP_COEFFICIENTS[index]));
+
+    }
+
+    __m256i exponent = _mm256_sub_epi64(_mm256_castpd_si256(shifted), _mm256_castpd_si256(_mm256_set1_pd(EXP_ROUND)));
+    exponent = _mm256_slli_epi64(_mm256_add_epi64(exponent, _mm256_set1_epi64x(1023)), 52);
+
+    return _mm256_mul_pd(p, _mm256_castsi256_pd(exponent));
+
+}
+
+// ================================================================================================
+// Apply the sigmoid function to a set of activations in place with AVX2 and FMA
+// ================================================================================================
+__attribute__((target("avx2,fma")))
+static void sigmoidAVX2(double* outputs, std::size_t count) {
+
+    std::size_t index = 0;
+
+    for (; index + 4 <= count; index += 4) {
+
+        const __m256d exponential = expAVX2(_mm256_sub_pd(_mm256_setzero_pd(), _mm256_loadu_pd(outputs + index)));
+        _mm256_storeu_pd(outputs + index, _mm256_div_pd(_mm256_set1_pd(1.0), _mm256_add_pd(_mm256_set1_pd(1.0), exponential)));
+
+    }
+
+    if (index < count) {
+
+        double values[4] = {0.0, 0.0, 0.0, 0.0};
+
+        std::memcpy(values, outputs + index, (count - index) * sizeof(double));
+
+        const __m256d exponential = expAVX2(_mm256_sub_pd(_mm256_setzero_pd(), _mm256_loadu_pd(values)));
+        _mm256_storeu_pd(values, _mm256_div_pd(_mm256_set1_pd(1.0), _mm256_add_pd(_mm256_set1_pd(1.0), exponential)));
+
+        std::memcpy(outputs + index, values, (count - index) * sizeof(double));
+
+    }
+
+}
+
+// ================================================================================================
+// Apply exp(x) to a set of values in place with AVX2 and FMA
+// ================================================================================================
+__attribute__((target("avx2,fma")))
+static void exponentialAVX2(double* outputs, std::size_t count) {
+
+    std::size_t index = 0;
+
+    for (; index + 4 <= count; index += 4) {
+
+        _mm256_storeu_pd(outputs + index, expAVX2(_mm256_loadu_pd(outputs + index)));
+
+    }
+
+    if (index < count) {
+
+        double values[4] = {0.0, 0.0, 0.0, 0.0};
+
+        std::memcpy(values, outputs + index, (count - index) * sizeof(double));
+        _mm256_storeu_pd(values, expAVX2(_mm256_loadu_pd(values)));
+        std::memcpy(outputs + index, values, (count - index) * sizeof(double));
+
+    }
+
+}
+
+// ================================================================================================
+// Activate a dense layer with AVX2 and FMA
+// ================================================================================================
+__attribute__((target("avx2,fma")))
+static void forwardAVX2(const double* weights, const double* biases, const double* inputs, double* outputs, std::size_t rows, std::size_t columns, activation::Function function) {
+
+    for (std::size_t row = 0; row < rows; row++) {
+
+        const double* const weight = weights + row * columns;
+
+        __m256d sum0 = _mm256_setzero_pd();
+        __m256d sum1 = _mm256_setzero_pd();
+
+        std::size_t column = 0;
+
+        for (; column + 8 <= columns; column += 8) {
+
+            sum0 = _mm256_fmadd_pd(_mm256_loadu_pd(inputs + column), _mm256_loadu_pd(weight + column), sum0);
+            sum1 = _mm256_fmadd_pd(_mm256_loadu_pd(inputs + column + 4), _mm256_loadu_pd(weight + column + 4), sum1);
+
+        }
+
+        const __m256d sum = _mm256_add_pd(sum0, sum1);
+        const __m128d half = _mm_add_pd(_mm256_castpd256_pd128(sum), _mm256_extractf128_pd(sum, 1));
+
+        double activation = biases[row] + _mm_cvtsd_f64(_mm_add_sd(half, _mm_unpackhi_pd(half, half)));
+
+        for (; column < columns; column++) {
+
+            activation += inputs[column] * weight[column];
+
+        }
+
+        outputs[row] = activation;
+
+    }
+
+    activateWith<double, sigmoidAVX2, exponentialAVX2>(outputs, 1, rows, function);
+
+}
+
+// ================================================================================================
+// Approximate exp(x) for eight doubles with AVX-512
+// ================================================================================================
+__attribute__((target("avx512f")))
+static __m512d expAVX512(__m512d x) {
+
+    x = _mm512_min_pd(_mm512_set1_pd(EXP_LIMIT), _mm512_max_pd(_mm512_set1_pd(-EXP_LIMIT), x));
+
+    const __m512d shifted = _mm512_fmadd_pd(x, _mm512_set1_pd(EXP_LOG2E), _mm512_set1_pd(EXP_ROUND));
+    const __m512d k = _mm512_sub_pd(shifted, _mm512_set1_pd(EXP_ROUND));
+
+    __m512d r = _mm512_fnmadd_pd(k, _mm512_set1_pd(EXP_LN2_HIGH), x);
+    r = _mm512_fnmadd_pd(k, _mm512_set1_pd(EXP_LN2_LOW), r);
+
+    __m512d p = _mm512_set1_pd(EXP_COEFFICIENTS[0]);
+
+    for (std::size_t index = 1; index < sizeof(EXP_COEFFICIENTS) / sizeof(double); index++) {
+
+        p = _mm512_fmadd_pd(p, r, _mm512_set1_pd(EXP_COEFFICIENTS[index]));
+
+    }
+
+    // AVX-512 scales by 2^k directly instead of building the exponent bits
+    return _mm512_scalef_pd(p, k);
+
+}
+
+// ================================================================================================
+// Apply the sigmoid function to a set of activations in place with AVX-512
+// ================================================================================================
+__attribute__((target("avx512f")))
+static void sigmoidAVX512(double* outputs, std::size_t count) {
+
+    for (std::size_t index = 0; index < count; index += 8) {
+
+        const __mmask8 mask = static_cast<__mmask8>((1u << std::min<std::size_t>(8, count - index)) - 1);
+
+        const __m512d values = _mm512_maskz_loadu_pd(mask, outputs + index);
+        const __m512d exponential = expAVX512(_mm512_sub_pd(_mm512_setzero_pd(), values));
+
+        _mm512_mask_storeu_pd(outputs + index, mask, _mm512_div_pd(_mm512_set1_pd(1.0), _mm512_add_pd(_mm512_set1_pd(1.0), exponential)));
+
+    }
+
+}
+
+// ================================================================================================
+// Apply exp(x) to a set of values in place with AVX-512
+// ================================================================================================
+__attribute__((target("avx512f")))
+static void exponentialAVX512(double* outputs, std::size_t count) {
+
+    for (std::size_t index = 0; index < count; index += 8) {
+
+        const __mmask8 mask = static_cast<__mmask8>((1u << std::min<std::size_t>(8, count - index)) - 1);
+
+        _mm512_mask_storeu_pd(outputs + index, mask, expAVX512(_mm512_maskz_loadu_pd(mask, outputs + index)));
+
+    }
+
+}
+
+// ================================================================================================
+// Activate a dense layer with AVX-512
+// ================================================================================================
+__attribute__((target("avx512f")))
+static void forwardAVX512(const double* weights, const double* biases, const double* inputs, double* outputs, std::size_t rows, std::size_t columns, activation::Function function) {
+
+    for (std::size_t row = 0; row < rows; row++) {
+
+        const double* const weight = weights + row * columns;
+
+        __m512d sum0 = _mm512_setzero_pd();
+        __m512d sum1 = _mm512_setzero_pd();
+
+        std::size_t column = 0;
+
+        for (; column + 16 <= columns; column += 16) {
+
+            sum0 = _mm512_fmadd_pd(_mm512_loadu_pd(inputs + column), _mm512_loadu_pd(weight + column), sum0);
+            sum1 = _mm512_fmadd_pd(_mm512_loadu_pd(inputs + column + 8), _mm512_loadu_pd(weight + column + 8), sum1);
+
+        }
+
+        double activation = biases[row] + _mm512_reduce_add_pd(_mm512_add_pd(sum0, sum1));
+
+        for (; column < columns; column++) {
+
+            activation += inputs[column] * weight[column];
+
+        }
+
+        outputs[row] = activation;
+
+    }
+
+    activateWith<double, sigmoidAVX512, exponentialAVX512>(outputs, 1, rows, function);
+
+}
+
+// ================================================================================================
+// Approximate exp(x) for four floats with SSE2
+// ================================================================================================
+__attribute__((target("sse2")))
+static __m128 expSSE2(__m128 x) {
+
+    x = _mm_min_ps(_mm_set1_ps(EXPF_LIMIT), _mm_max_ps(_mm_set1_ps(-EXPF_LIMIT), x));
+
+    const __m128 shifted = _mm_add_ps(_mm_mul_ps(x, _mm_set1_ps(EXPF_LOG2E)), _mm_set1_ps(EXPF_ROUND));
+    const __m128 k = _mm_sub_ps(shifted, _mm_set1_ps(EXPF_ROUND));
+
+    __m128 r = _mm_sub_ps(x, _mm_mul_ps(k, _mm_set1_ps(EXPF_LN2_HIGH)));
+    r = _mm_sub_ps(r, _mm_mul_ps(k, _mm_set1_ps(EXPF_LN2_LOW)));
+
+    __m128 p = _mm_set1_ps(EXPF_COEFFICIENTS[0]);
+
+    for (std::size_t index = 1; index < sizeof(EXPF_COEFFICIENTS) / sizeof(float); index++) {
+
+        p = _mm_add_ps(_mm_mul_ps(p, r), _mm_set1_ps(EXPF_COEFFICIENTS[index]));
+
+    }
+
+    __m128i exponent = _mm_sub_epi32(_mm_castps_si128(shifted), _mm_castps_si128(_mm_set1_ps(EXPF_ROUND)));
+    exponent = _mm_slli_epi32(_mm_add_epi32(exponent, _mm_set1_epi32(127)), 23);
+
+    return _mm_mul_ps(p, _mm_castsi128_ps(exponent));
+
+}
+
+// ================================================================================================
+// Apply the sigmoid function to a single precision layer in place with SSE2
+// ================================================================================================
+__attribute__((target("sse2")))
+static void sigmoidSSE2(float* outputs, std::size_t rows) {
+
+    for (std::size_t row = 0; row < rows; row += 4) {
+
+        float values[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+        const std::size_t count = std::min<std::size_t>(4, rows - row);
+
+        std::memcpy(values, outputs + row, count * sizeof(float));
+
+        const __m128 exponential = expSSE2(_mm_sub_ps(_mm_setzero_ps(), _mm_loadu_ps(values)));
+        _mm_storeu_ps(values, _mm_div_ps(_mm_set1_ps(1.0f), _mm_add_ps(_mm_set1_ps(1.0f), exponential)));
+
+        std::memcpy(outputs + row, values, count * sizeof(float));
+
+    }
+
+}
+
+// ================================================================================================
+// Apply exp(x) to a single precision set of values in place with SSE2
+// ================================================================================================
+__attribute__((target("sse2")))
+static void exponentialSSE2(float* outputs, std::size_t count) {
+
+    for (std::size_t index = 0; index < count; index += 4) {
+
+        float values[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+        const std::size_t lanes = std::min<std::size_t>(4, count - index);
+
+        std::memcpy(values, outputs + index, lanes * sizeof(float));
+        _mm_storeu_ps(values, expSSE2(_mm_loadu_ps(values)));
+        std::memcpy(outputs + index, values, lanes * sizeof(float));
+
+    }
+
+}
+
+// ================================================================================================
+// Activate a single precision dense layer with SSE2
+// ================================================================================================
+__attribute__((target("sse2")))
+static void forwardSSE2(const float* weights, const float* biases, const float* inputs, float* outputs, std::size_t rows, std::size_t columns, activation::Function function) {
+
+    for (std::size_t row = 0; row < rows; row++) {
+
+        const float* const weight = weights + row * columns;
+
+        __m128 sum0 = _mm_setzero_ps();
+        __m128 sum1 = _mm_setzero_ps();
+
+        std::size_t column = 0;
+
+        for (; column + 8 <= columns; column += 8) {
+
+            sum0 = _mm_add_ps(sum0, _mm_mul_ps(_mm_loadu_ps(inputs + column), _mm_loadu_ps(weight + column)));
+            sum1 = _mm_add_ps(sum1, _mm_mul_ps(_mm_loadu_ps(inputs + column + 4), _mm_loadu_ps(weight + column + 4)));
+
+        }
+
+        const __m128 sum = _mm_add_ps(sum0, sum1);
+        const __m128 half = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+
+        float activation = biases[row] + _mm_cvtss_f32(_mm_add_ss(half, _mm_shuffle_ps(half, half, 1)));
+
+        for (; column < columns; column++) {
+
+            activation += inputs[column] * weight[column];
+
+        }
+
+        outputs[row] = activation;
+
+    }
+
+    activateWith<float, sigmoidSSE2, exponentialSSE2>(outputs, 1, rows, function);
+
+}
+
+// ================================================================================================
+// Approximate exp(x) for eight floats with AVX2 and FMA
+// ================================================================================================
+__attribute__((target("avx2,fma")))
+static __m256 expAVX2(__m256 x) {
+
+    x = _mm256_min_ps(_mm256_set1_ps(EXPF_LIMIT), _mm256_max_ps(_mm256_set1_ps(-EXPF_LIMIT), x));
+
+    const __m256 shifted = _mm256_fmadd_ps(x, _mm256_set1_ps(EXPF_LOG2E), _mm256_set1_ps(EXPF_ROUND));
+    const __m256 k = _mm256_sub_ps(shifted, _mm256_set1_ps(EXPF_ROUND));
+
+    __m256 r = _mm256_fnmadd_ps(k, _mm256_set1_ps(EXPF_LN2_HIGH), x);
+    r = _mm256_fnmadd_ps(k, _mm256_set1_ps(EXPF_LN2_LOW), r);
+
+    __m256 p = _mm256_set1_ps(EXPF_COEFFICIENTS[0]);
+
+    for (std::size_t index = 1; index < sizeof(EXPF_COEFFICIENTS) / sizeof(float); index++) {
+
+        p = _mm256_fmadd_ps(p, r, _mm256_set1_ps(EXPF_COEFFICIENTS[index]));
+
+    }
+
+    __m256i exponent = _mm256_sub_epi32(_mm256_castps_si256(shifted), _mm256_castps_si256(_mm256_set1_ps(EXPF_ROUND)));
+    exponent = _mm256_slli_epi32(_mm256_add_epi32(exponent, _mm256_set1_epi32(127)), 23);
+
+    return _mm256_mul_ps(p, _mm256_castsi256_ps(exponent));
+
+}
+
+// ================================================================================================
+// Apply the sigmoid function to a single precision layer in place with AVX2 and FMA
+// ================================================================================================
+__attribute__((target("avx2,fma")))
+static void sigmoidAVX2(float* outputs, std::size_t rows) {
+
+    for (std::size_t row = 0; row < rows; row += 8) {
+
+        float values[8] = {0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f};
+        const std::size_t count = std::min<std::size_t>(8, rows - row);
+
+        std::memcpy(values, outputs + row, count * sizeof(float));
+
+        const __m256 exponential = expAVX2(_mm256_sub_ps(_mm256_setzero_ps(), _mm256_loadu_ps(values)));
+        _mm256_storeu_ps(values, _mm256_div_ps(_mm256_set1_ps(1.0f), _mm256_add_ps(_mm256_set1_ps(1.0f), exponential)));
+
+        std::memcpy(outputs + row, values, count * sizeof(float));
+
+    }
+
+}
+
+// ================================================================================================
+// Apply exp(x) to a single precision set of values in place with AVX2 and FMA
+// ================================================================================================
+__attribute__((target("avx2,fma")))
+static void exponentialAVX2(float* outputs, std::size_t count) {
+
+    for (std::size_t index = 0; index < count; index += 8) {
+
+        float values[8] = {0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f};
+        const std::size_t lanes = std::min<std::size_t>(8, count - index);
+
+        std::memcpy(values, outputs + index, lanes * sizeof(float));
+        _mm256_storeu_ps(values, expAVX2(_mm256_loadu_ps(values)));
+        std::memcpy(outputs + index, values, lanes * sizeof(float));
+
+    }
+
+}
+
+// ================================================================================================
+// Activate a single precision dense layer with AVX2 and FMA
+// ================================================================================================
+__attribute__((target("avx2,fma")))
+static void forwardAVX2(const float* weights, const float* biases, const float* inputs, float* outputs, std::size_t rows, std::size_t columns, activation::Function function) {
+
+    for (std::size_t row = 0; row < rows; row++) {
+
+        const float* const weight = weights + row * columns;
+
+        __m256 sum0 = _mm256_setzero_ps();
+        __m256 sum1 = _mm256_setzero_ps();
+
+        std::size_t column = 0;
+
+        for (; column + 16 <= columns; column += 16) {
+
+            sum0 = _mm256_fmadd_ps(_mm256_loadu_ps(inputs + column), _mm256_loadu_ps(weight + column), sum0);
+            sum1 = _mm256_fmadd_ps(_mm256_loadu_ps(inputs + column + 8), _mm256_loadu_ps(weight + column + 8), sum1);
+
+        }
+
+        const __m256 sum = _mm256_add_ps(sum0, sum1);
+        const __m128 quarter = _mm_add_ps(_mm256_castps256_ps128(sum), _mm256_extractf128_ps(sum, 1));
+        const __m128 half = _mm_add_ps(quarter, _mm_movehl_ps(quarter, quarter));
+
+        float activation = biases[row] + _mm_cvtss_f32(_mm_add_ss(half, _mm_shuffle_ps(half, half, 1)));
+
+        for (; column < columns; column++) {
+
+            activation += inputs[column] * weight[column];
+
+        }
+
+        outputs[row] = activation;
+
+    }
+
+    activateWith<float, sigmoidAVX2, exponentialAVX2>(outputs, 1, rows, function);
+
+}
+
+// ================================================================================================
+// Approximate exp(x) for sixteen floats with AVX-512
+// ================================================================================================
+__attribute__((target("avx512f")))
+static __m512 expAVX512(__m512 x) {
+
+    x = _mm512_min_ps(_mm512_set1_ps(EXPF_LIMIT), _mm512_max_ps(_mm512_set1_ps(-EXPF_LIMIT), x));
+
+    const __m512 shifted = _mm512_fmadd_ps(x, _mm512_set1_ps(EXPF_LOG2E), _mm512_set1_ps(EXPF_ROUND));
+    const __m512 k = _mm512_sub_ps(shifted, _mm512_set1_ps(EXPF_ROUND));
+
+    __m512 r = _mm512_fnmadd_ps(k, _mm512_set1_ps(EXPF_LN2_HIGH), x);
+    r = _mm512_fnmadd_ps(k, _mm512_set1_ps(EXPF_LN2_LOW), r);
+
+    __m512 p = _mm512_set1_ps(EXPF_COEFFICIENTS[0]);
+
+    for (std::size_t index = 1; index < sizeof(EXPF_COEFFICIENTS) / sizeof(float); index++) {
+
+        p = _mm512_fmadd_ps(p, r, _mm512_set1_ps(EXPF_COEFFICIENTS[index]));
+
+    }
+
+    return _mm512_scalef_ps(p, k);
+
+}
+
+// ================================================================================================
+// Apply the sigmoid function to a single precision layer in place with AVX-512
+// ================================================================================================
+__attribute__((target("avx512f")))
+static void sigmoidAVX512(float* outputs, std::size_t rows) {
+
+    for (std::size_t row = 0; row < rows; row += 16) {
+
+        const std::size_t count = std::min<std::size_t>(16, rows - row);
+        const __mmask16 mask = static_cast<__mmask16>((1u << count) - 1);
+
+        const __m512 values = _mm512_maskz_loadu_ps(mask, outputs + row);
+        const __m512 exponential = expAVX512(_mm512_sub_ps(_mm512_setzero_ps(), values));
+
+        _mm512_mask_storeu_ps(outputs + row, mask, _mm512_div_ps(_mm512_set1_ps(1.0f), _mm512_add_ps(_mm512_set1_ps(1.0f), exponential)));
+
+    }
+
+}
+
+// ================================================================================================
+// Apply exp(x) to a single precision set of values in place with AVX-512
+// ================================================================================================
+__attribute__((target("avx512f")))
+static void exponentialAVX512(float* outputs, std::size_t count) {
+
+    for (std::size_t index = 0; index < count; index += 16) {
+
+        const __mmask16 mask = static_cast<__mmask16>((1u << std::min<std::size_t>(16, count - index)) - 1);
+
+        _mm512_mask_storeu_ps(outputs + index, mask, expAVX512(_mm512_maskz_loadu_ps(mask, outputs + index)));
+
+    }
+
+}
+
+// ================================================================================================
+// Activate a single precision dense layer with AVX-512
+// ================================================================================================
+__attribute__((target("avx512f")))
+static void forwardAVX512(const float* weights, const float* biases, const float* inputs, float* outputs, std::size_t rows, std::size_t columns, activation::Function function) {
+
+    for (std::size_t row = 0; row < rows; row++) {
+
+        const float* const weight = weights + row * columns;
+
+        __m512 sum0 = _mm512_setzero_ps();
+        __m512 sum1 = _mm512_setzero_ps();
+
+        std::size_t column = 0;
+
+        for (; column + 32 <= columns; column += 32) {
+
+            sum0 = _mm512_fmadd_ps(_mm512_loadu_ps(inputs + column), _mm512_loadu_ps(weight + column), sum0);
+            sum1 = _mm512_fmadd_ps(_mm512_loadu_ps(inputs + column + 16), _mm512_loadu_ps(weight + column + 16), sum1);
+
+        }
+
+        float activation = biases[row] + _mm512_reduce_add_ps(_mm512_add_ps(sum0, sum1));
+
+        for (; column < columns; column++) {
+
+            activation += inputs[column] * weight[column];
+
+        }
+
+        outputs[row] = activation;
+
+    }
+
+    activateWith<float, sigmoidAVX512, exponentialAVX512>(outputs, 1, rows, function);
+
+}
+
+// ================================================================================================
+// Activate a quantised dense layer with SSE2
+// ================================================================================================
+__attribute__((target("sse2")))
+static void forwardSSE2(const std::int8_t* weights, const float* scales, const float* biases, const std::int8_t* inputs, float* outputs, std::size_t rows, std::size_t columns) {
+
+    for (std::size_t row = 0; row < rows; row++) {
+
+        const std::int8_t* const weight = weights + row * columns;
+
+        __m128i sum = _mm_setzero_si128();
+
+        std::size_t column = 0;
+
+        for (; column + 16 <= columns; column += 16) {
+
+            const __m128i input = _mm_loadu_si128(reinterpret_cast<const __m128i*>(inputs + column));
+            const __m128i value = _mm_loadu_si128(reinterpret_cast<const __m128i*>(weight + column));
+
+            // Duplicating every byte and shifting it back down sign extends it to 16 bits
+            sum = _mm_add_epi32(sum, _mm_madd_epi16(_mm_srai_epi16(_mm_unpacklo_epi8(input, input), 8), _mm_srai_epi16(_mm_unpacklo_epi8(value, value), 8)));
+            sum = _mm_add_epi32(sum, _mm_madd_epi16(_mm_srai_epi16(_mm_unpackhi_epi8(input, input), 8), _mm_srai_epi16(_mm_unpackhi_epi8(value, value), 8)));
+
+        }
+
+        std::int32_t lanes[4];
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(lanes), sum);
+
+        std::int32_t accumulator = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+
+        for (; column < columns; column++) {
+
+            accumulator += inputs[column] * weight[column];
+
+        }
+
+        outputs[row] = biases[row] + accumulator * scales[row];
+
+    }
+
+    sigmoidSSE2(outputs, rows);
+
+}
+
+// ================================================================================================
+// Activate a quantised dense layer with AVX2
+// ================================================================================================
+__attribute__((target("avx2,fma")))
+static void forwardAVX2(const std::int8_t* weights, const float* scales, const float* biases, const std::int8_t* inputs, float* outputs, std::size_t rows, std::size_t columns) {
+
+    for (std::size_t row = 0; row < rows; row++) {
+
+        const std::int8_t* const weight = weights + row * columns;
+
+        __m256i sum0 = _mm256_setzero_si256();
+        __m256i sum1 = _mm256_setzero_si256();
+
+        std::size_t column = 0;
+
+        for (; column + 32 <= columns; column += 32) {
+
+            const __m256i input0 = _mm256_cvtepi8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(inputs + column)));
+            const __m256i input1 = _mm256_cvtepi8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(inputs + column + 16)));
+            const __m256i value0 = _mm256_cvtepi8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(weight + column)));
+            const __m256i value1 = _mm256_cvtepi8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(weight + column + 16)));
+
+            sum0 = _mm256_add_epi32(sum0, _mm256_madd_epi16(input0, value0));
+            sum1 = _mm256_add_epi32(sum1, _mm256_madd_epi16(input1, value1));
+
+        }
+
+        const __m256i sum = _mm256_add_epi32(sum0, sum1);
+        __m128i half = _mm_add_epi32(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+        half = _mm_add_epi32(half, _mm_shuffle_epi32(half, _MM_SHUFFLE(1, 0, 3, 2)));
+        half = _mm_add_epi32(half, _mm_shuffle_epi32(half, _MM_SHUFFLE(2, 3, 0, 1)));
+
+        std::int32_t accumulator = _mm_cvtsi128_si32(half);
+
+        for (; column < columns; column++) {
+
+            accumulator += inputs[column] * weight[column];
+
+        }
+
+        outputs[row] = biases[row] + accumulator * scales[row];
+
+    }
+
+    sigmoidAVX2(outputs, rows);
+
+}
+
+// ================================================================================================
+// Activate a quantised dense layer with AVX-512
+// ================================================================================================
+__attribute__((target("avx512f,avx512bw")))
+static void forwardAVX512(const std::int8_t* weights, const float* scales, const float* biases, const std::int8_t* inputs, float* outputs, std::size_t rows, std::size_t columns) {
+
+    for (std::size_t row = 0; row < rows; row++) {
+
+        const std::int8_t* const weight = weights + row * columns;
+
+        __m512i sum0 = _mm512_setzero_si512();
+        __m512i sum1 = _mm512_setzero_si512();
+
+        std::size_t column = 0;
+
+        for (; column + 64 <= columns; column += 64) {
+
+            const __m512i input0 = _mm512_cvtepi8_epi16(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(inputs + column)));
+            const __m512i input1 = _mm512_cvtepi8_epi16(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(inputs + column + 32)));
+            const __m512i value0 = _mm512_cvtepi8_epi16(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(weight + column)));
+            const __m512i value1 = _mm512_cvtepi8_epi16(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(weight + column + 32)));
+
+            sum0 = _mm512_add_epi32(sum0, _mm512_madd_epi16(input0, value0));
+            sum1 = _mm512_add_epi32(sum1, _mm512_madd_epi16(input1, value1));
+
+        }
+
+        std::int32_t accumulator = _mm512_reduce_add_epi32(_mm512_add_epi32(sum0, sum1));
+
+        for (; column < columns; column++) {
+
+            accumulator += inputs[column] * weight[column];
+
+        }
+
+        outputs[row] = biases[row] + accumulator * scales[row];
+
+    }
+
+    sigmoidAVX512(outputs, rows);
+
+}
+
+// ================================================================================================
+// Activate a pruned layer with AVX2 and FMA, gathering the inputs of four weights at a time
+// ================================================================================================
+__attribute__((target("avx2,fma")))
+static void forwardSparseAVX2(const std::uint64_t* offsets, const std::uint32_t* indices, const double* values, const double* biases, const double* inputs, double* outputs, std::size_t rows, activation::Function function) {
+
+    for (std::size_t row = 0; row < rows; row++) {
+
+        __m256d sum = _mm256_setzero_pd();
+
+        std::uint64_t entry = offsets[row];
+
+        for (; entry + 4 <= offsets[row + 1]; entry += 4) {
+
+            const __m128i columns = _mm_loadu_si128(reinterpret_cast<const __m128i*>(indices + entry));
+            sum = _mm256_fmadd_pd(_mm256_i32gather_pd(inputs, columns, 8), _mm256_loadu_pd(values + entry), sum);
+
+        }
+
+        const __m128d half = _mm_add_pd(_mm256_castpd256_pd128(sum), _mm256_extractf128_pd(sum, 1));
+
+        double activation = biases[row] + _mm_cvtsd_f64(_mm_add_sd(half, _mm_unpackhi_pd(half, half)));
+
+        for (; entry < offsets[row + 1]; entry++) {
+
+            activation += inputs[indices[entry]] * values[entry];
+
+        }
+
+        outputs[row] = activation;
+
+    }
+
+    activateWith<double, sigmoidAVX2, exponentialAVX2>(outputs, 1, rows, function);
+
+}
+
+// ================================================================================================
+// Activate a pruned layer with AVX-512, gathering the inputs of eight weights at a time
+// ================================================================================================
+__attribute__((target("avx512f")))
+static void forwardSparseAVX512(const std::uint64_t* offsets, const std::uint32_t* indices, const double* values, const double* biases, const double* inputs, double* outputs, std::size_t rows, activation::Function function) {
+
+    for (std::size_t row = 0; row < rows; row++) {
+
+        __m512d sum = _mm512_setzero_pd();
+
+        for (std::uint64_t entry = offsets[row]; entry < offsets[row + 1]; entry += 8) {
+
+            // The tail of a row is masked so the gather never reads past the end of the row
+            const std::size_t count = std::min<std::uint64_t>(8, offsets[row + 1] - entry);
+            const __mmask8 mask = static_cast<__mmask8>((1u << count) - 1);
+
+            const __m256i columns = _mm512_castsi512_si256(_mm512_maskz_loadu_epi32(mask, indices + entry));
+            const __m512d gathered = _mm512_mask_i32gather_pd(_mm512_setzero_pd(), mask, columns, inputs, 8);
+
+            sum = _mm512_fmadd_pd(gathered, _mm512_maskz_loadu_pd(mask, values + entry), sum);
+
+        }
+
+        outputs[row] = biases[row] + _mm512_reduce_add_pd(sum);
+
+    }
+
+    activateWith<double, sigmoidAVX512, exponentialAVX512>(outputs, 1, rows, function);
+
+}
+
+// ================================================================================================
+// Activate a dense layer for a batch of samples with AVX2 and FMA, four samples per pass over the weights
+// ================================================================================================
+__attribute__((target("avx2,fma")))
+static void forwardBatchAVX2(const double* weights, const double* biases, const double* inputs, double* outputs, std::size_t samples, std::size_t rows, std::size_t columns, activation::Function function) {
+
+    std::size_t sample = 0;
+
+    for (; sample + 4 <= samples; sample += 4) {
+
+        const double* const input = inputs + sample * columns;
+
+        for (std::size_t row = 0; row < rows; row++) {
+
+            const double* const weight = weights + row * columns;
+
+            __m256d sums[4] = {_mm256_setzero_pd(), _mm256_setzero_pd(), _mm256_setzero_pd(), _mm256_setzero_pd()};
+
+            std::size_t column = 0;
+
+            // Each weight is loaded once and used for all four samples
+            for (; column + 4 <= columns; column += 4) {
+
+                const __m256d values = _mm256_loadu_pd(weight + column);
+
+                for (std::size_t offset = 0; offset < 4; offset++) {
+
+                    sums[offset] = _mm256_fmadd_pd(_mm256_loadu_pd(input + offset * columns + column), values, sums[offset]);
+
+                }
+
+            }
+
+            for (std::size_t offset = 0; offset < 4; offset++) {
+
+                const __m128d half = _mm_add_pd(_mm256_castpd256_pd128(sums[offset]), _mm256_extractf128_pd(sums[offset], 1));
+
+                double activation = biases[row] + _mm_cvtsd_f64(_mm_add_sd(half, _mm_unpackhi_pd(half, half)));
+
+                for (std::size_t tail = column; tail < columns; tail++) {
+
+                    activation += input[offset * columns + tail] * weight[tail];
+
+                }
+
+                outputs[(sample + offset) * rows + row] = activation;
+
+            }
+
+        }
+
+    }
+
+    activateWith<double, sigmoidAVX2, exponentialAVX2>(outputs, sample, rows, function);
+
+    for (; sample < samples; sample++) {
+
+        forwardAVX2(weights, biases, inputs + sample * columns, outputs + sample * rows, rows, columns, function);
+
+    }
+
+}
+
+// ================================================================================================
+// Activate a dense layer for a batch of samples with AVX-512, four samples per pass over the weights
+// ================================================================================================
+__attribute__((target("avx512f")))
+static void forwardBatchAVX512(const double* weights, const double* biases, const double* inputs, double* outputs, std::size_t samples, std::size_t rows, std::size_t columns, activation::Function function) {
+
+    std::size_t sample = 0;
+
+    for (; sample + 4 <= samples; sample += 4) {
+
+        const double* const input = inputs + sample * columns;
+
+        for (std::size_t row = 0; row < rows; row++) {
+
+            const double* const weight = weights + row * columns;
+
+            __m512d sums[4] = {_mm512_setzero_pd(), _mm512_setzero_pd(), _mm512_setzero_pd(), _mm512_setzero_pd()};
+
+            // Each weight is loaded once and used for all four samples, the masked tail covers the last columns
+            for (std::size_t column = 0; column < columns; column += 8) {
+
+                const __mmask8 mask = static_cast<__mmask8>((1u << std::min<std::size_t>(8, columns - column)) - 1);
+                const __m512d values = _mm512_maskz_loadu_pd(mask, weight + column);
+
+                for (std::size_t offset = 0; offset < 4; offset++) {
+
+                    sums[offset] = _mm512_fmadd_pd(_mm512_maskz_loadu_pd(mask, input + offset * columns + column), values, sums[offset]);
+
+                }
+
+            }
+
+            for (std::size_t offset = 0; offset < 4; offset++) {
+
+                outputs[(sample + offset) * rows + row] = biases[row] + _mm512_reduce_add_pd(sums[offset]);
+
+            }
+
+        }
+
+    }
+
+    activateWith<double, sigmoidAVX512, exponentialAVX512>(outputs, sample, rows, function);
+
+    for (; sample < samples; sample++) {
+
+        forwardAVX512(weights, biases, inputs + sample * columns, outputs + sample * rows, rows, columns, function);
+
+    }
+
+}
+
+#endif
+
+// ================================================================================================
+// Pick the widest instruction set supported by the CPU
+// ================================================================================================
+static const char* detectInstructionSet() {
+
+    #ifdef KERNELS_X86
+
+    __builtin_cpu_init();
+
+    if (__builtin_cpu_supports("avx512f")) { return "avx512"; }
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) { return "avx2"; }
+    if (__builtin_cpu_supports("sse2")) { return "sse2"; }
+
+    #endif
+
+    return "scalar";
+
+}
+
+static const char* instructionSet = detectInstructionSet();
+
+// ================================================================================================
+// Get the forward kernel of an instruction set
+// ================================================================================================
+static Forward getForward(const char* const name) {
+
+    #ifdef KERNELS_X86
+
+    if (std::strcmp(name, "avx512") == 0) { return forwardAVX512; }
+    if (std::strcmp(name, "avx2") == 0) { return forwardAVX2; }
+    if (std::strcmp(name, "sse2") == 0) { return forwardSSE2; }
+
+    #endif
+
+    return kernels::forward<double>;
+
+}
+
+// ================================================================================================
+// Get the single precision forward kernel of an instruction set
+// ================================================================================================
+static ForwardF32 getForwardF32(const char* const name) {
+
+    #ifdef KERNELS_X86
+
+    if (std::strcmp(name, "avx512") == 0) { return forwardAVX512; }
+    if (std::strcmp(name, "avx2") == 0) { return forwardAVX2; }
+    if (std::strcmp(name, "sse2") == 0) { return forwardSSE2; }
+
+    #endif
+
+    return kernels::forward<float>;
+
+}
+
+// ================================================================================================
+// Get the quantised forward kernel of an instruction set
+// ================================================================================================
+static ForwardInt8 getForwardInt8(const char* const name) {
+
+    #ifdef KERNELS_X86
+
+    // The widening multiply of the AVX-512 kernel needs the byte and word extension as well
+    if (std::strcmp(name, "avx512") == 0 && __builtin_cpu_supports("avx512bw")) { return forwardAVX512; }
+    if (std::strcmp(name, "avx512") == 0 || std::strcmp(name, "avx2") == 0) { return forwardAVX2; }
+    if (std::strcmp(name, "sse2") == 0) { return forwardSSE2; }
+
+    #endif
+
+    return kernels::forward;
+
+}
+
+// ================================================================================================
+// Get the pruned layer forward kernel of an instruction set
+// ================================================================================================
+static ForwardSparse getForwardSparse(const char* const name) {
+
+    #ifdef KERNELS_X86
+
+    // Gathers only pay off from AVX2 onwards, so SSE2 uses the scalar kernel
+    if (std::strcmp(name, "avx512") == 0) { return forwardSparseAVX512; }
+    if (std::strcmp(name, "avx2") == 0) { return forwardSparseAVX2; }
+
+    #endif
+
+    return kernels::forwardSparse;
+
+}
+
+static Forward forwardKernel = getForward(instructionSet);
+static ForwardF32 forwardKernelF32 = getForwardF32(instructionSet);
+static ForwardInt8 forwardKernelInt8 = getForwardInt8(instructionSet);
+static ForwardSparse forwardKernelSparse = getForwardSparse(instructionSet);
+
+// ================================================================================================
+// Activate a dense layer for a batch of samples one sample at a time with the selected forward kernel
+// ================================================================================================
+static void forwardBatchSamples(const double* weights, const double* biases, const double* inputs, double* outputs, std::size_t samples, std::size_t rows, std::size_t columns, activation::Function function) {
+
+    for (std::size_t sample = 0; sample < samples; sample++) {
+
+        forwardKernel(weights, biases, inputs + sample * columns, outputs + sample * rows, rows, columns, function);
+
+    }
+
+}
+
+// ================================================================================================
+// Get the batch inference kernel of an instruction set
+// ================================================================================================
+static ForwardBatch getForwardBatch(const char* const name) {
+
+    #ifdef KERNELS_X86
+
+    if (std::strcmp(name, "avx512") == 0) { return forwardBatchAVX512; }
+    if (std::strcmp(name, "avx2") == 0) { return forwardBatchAVX2; }
+
+    #endif
+
+    return forwardBatchSamples;
+
+}
+
+static ForwardBatch forwardKernelBatch = getForwardBatch(instructionSet);
+
+// ================================================================================================
+// Activate a dense layer for inference with the selected instruction set
+// ================================================================================================
+// The vector kernels reorder the dot product sums and approximate exp(x) with a relative error
+// below 1e-14, so their outputs match the scalar kernel within an absolute tolerance of 1e-12
+void kernels::infer(
+    const double* const weights,
+    const double* const biases,
+    const double* const inputs,
+    double* const outputs,
+    const std::size_t rows,
+    const std::size_t columns,
+    const activation::Function function
+) {
+
+    forwardKernel(weights, biases, inputs, outputs, rows, columns, function);
+
+}
+
+// ================================================================================================
+// Activate a single precision dense layer for inference with the selected instruction set
+// ================================================================================================
+// The single precision exp(x) approximation stays within 2 ulp, so the outputs match the scalar
+// single precision kernel within an absolute tolerance of 1e-5
+void kernels::infer(
+    const float* const weights,
+    const float* const biases,
+    const float* const inputs,
+    float* const outputs,
+    const std::size_t rows,
+    const std::size_t columns,
+    const activation::Function function
+) {
+
+    forwardKernelF32(weights, biases, inputs, outputs, rows, columns, function);
+
+}
+
+// ================================================================================================
+// Activate a quantised dense layer for inference with the selected instruction set
+// ================================================================================================
+// The integer dot products are exact, so the outputs only differ from the scalar quantised kernel
+// by the single precision exp(x) approximation
+void kernels::infer(
+    const std::int8_t* const weights,
+    const float* const scales,
+    const float* const biases,
+    const std::int8_t* const inputs,
+    float* const outputs,
+    const std::size_t rows,
+    const std::size_t columns
+) {
+
+    forwardKernelInt8(weights, scales, biases, inputs, outputs, rows, columns);
+
+}
+
+// ================================================================================================
+// Activate a dense layer for inference on a batch of samples with the selected instruction set
+// ================================================================================================
+// The vector kernels read every weight once per four samples instead of once per sample, their
+// outputs match the single sample kernel within the same tolerance
+void kernels::inferBatch(
+    const double* const weights,
+    const double* const biases,
+    const double* const inputs,
+    double* const outputs,
+    const std::size_t samples,
+    const std::size_t rows,
+    const std::size_t columns,
+    const activation::Function function
+) {
+
+    forwardKernelBatch(weights, biases, inputs, outputs, samples, rows, columns, function);
+
+}
+
+// ================================================================================================
+// Activate a pruned layer for inference with the selected instruction set
+// ================================================================================================
+// The gather kernels reorder the sums of each row like the dense kernels, so their outputs match
+// the scalar sparse kernel within the same tolerance
+void kernels::inferSparse(
+    const std::uint64_t* const offsets,
+    const std::uint32_t* const indices,
+    const double* const values,
+    const double* const biases,
+    const double* const inputs,
+    double* const outputs,
+    const std::size_t rows,
+    const activation::Function function
+) {
+
+    forwardKernelSparse(offsets, indices, values, biases, inputs, outputs, rows, function);
+
+}
+
+// ================================================================================================
+// Get the name of the instruction set used for inference
+// ================================================================================================
+const char* kernels::getInstructionSet() {
+
+    return instructionSet;
+
+}
+
+// ================================================================================================
+// Select an instruction set for inference if the CPU supports it
+// ================================================================================================
+bool kernels::setInstructionSet(const char* const name) {
+
+    const char* const names[] = {"scalar", "sse2", "avx2", "avx512"};
+
+    for (const char* const candidate : names) {
+
+        if (std::strcmp(candidate, name) != 0) { continue; }
+
+        #ifdef KERNELS_X86
+
+        if (std::strcmp(name, "avx512") == 0 && !__builtin_cpu_supports("avx512f")) { return false; }
+        if (std::strcmp(name, "avx2") == 0 && !(__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))) { return false; }
+        if (std::strcmp(name, "sse2") == 0 && !__builtin_cpu_supports("sse2")) { return false; }
+
+        #else
+
+        if (std::strcmp(name, "scalar") != 0) { return false; }
+
+        #endif
+
+        instructionSet = candidate;
+        forwardKernel = getForward(candidate);
+        forwardKernelF32 = getForwardF32(candidate);
+        forwardKernelInt8 = getForwardInt8(candidate);
+        forwardKernelSparse = getForwardSparse(candidate);
+        forwardKernelBatch = getForwardBatch(candidate);
+
+        return true;
+
+    }
+
+    return false;
+
+}
\ No newline at end of file
@@ -1,6 +1,13 @@
 #include "Layer.h"
 #include "Network.h"
+#include "Kernels.h"
+#include "RNG.h"
+#include "Profiler.h"
 #include <stdexcept>
+#include <algorithm>
+#include <utility>
+#include <limits>
+#include <cmath>
 
 // ================================================================================================
 // Constructor
@@ -9,12 +16,21 @@ Layer::Layer(
     Network* const network,
     const std::size_t neurons
 ):
-    _network(network)
+    _network(network),
+    _inputs(nullptr),
+    _outputs(nullptr),
+    _biases(neurons),
+    _activations(neurons, 0.0),
+    _deltas(neurons, 0.0),
+    _connections(0),
+    _activation(activation::SIGMOID),
+    _loss(0.0)
 {
 
     for (std::size_t neuron = 0; neuron < neurons; neuron++) {
 
-        _neurons.push_back(_network->createNeuron());
+        _neurons.push_back(_network->createNeuron(this));
+        _biases[neuron] = rng::range(-1.0, 1.0);
 
     }
 
@@ -25,57 +41,242 @@ Layer::Layer(
 // ================================================================================================
 Layer::Layer(
     Network* const network,
+    Layer* const layer,
     std::ifstream& file
 ):
-    _network(network)
+    _network(network),
+    _inputs(nullptr),
+    _outputs(nullptr),
+    _connections(0),
+    _activation(activation::SIGMOID),
+    _loss(0.0)
 {
 
     std::size_t neurons;
 
     file.read(reinterpret_cast<char*>(&neurons), sizeof(neurons));
 
+    _biases.resize(neurons);
+    _activations.resize(neurons, 0.0);
+    _deltas.resize(neurons, 0.0);
+
+    const std::size_t columns = layer->getNeuronCount();
+
+    std::vector<std::size_t> connections(neurons);
+    std::vector<std::size_t> targets;
+    std::vector<double> weights;
+
+    bool dense = true;
+
     for (std::size_t neuron = 0; neuron < neurons; neuron++) {
 
-        _neurons.push_back(_network->loadNeuron(file));
+        _neurons.push_back(_network->createNeuron(this));
+
+        file.read(reinterpret_cast<char*>(&_biases[neuron]), sizeof(_biases[neuron]));
+        file.read(reinterpret_cast<char*>(&connections[neuron]), sizeof(connections[neuron]));
+
+        // A layer is dense if every neuron, including ones without any connection, is connected to every
+        // input neuron in order
+        dense = dense && connections[neuron] == columns;
+
+        for (std::size_t connection = 0; connection < connections[neuron]; connection++) {
+
+            std::size_t target;
+            double weight;
+
+            file.read(reinterpret_cast<char*>(&target), sizeof(target));
+            file.read(reinterpret_cast<char*>(&weight), sizeof(weight));
+
+            dense = dense && target == layer->_neurons[connection]->getID();
+
+            targets.push_back(target);
+            weights.push_back(weight);
+
+        }
+
+    }
+
+    if (dense) {
+
+        _inputs = layer;
+        _inputs->_outputs = this;
+        _weights = std::move(weights);
+
+    } else {
+
+        std::size_t edge = 0;
+
+        for (std::size_t neuron = 0; neuron < neurons; neuron++) {
+
+            for (std::size_t connection = 0; connection < connections[neuron]; connection++, edge++) {
+
+                _neurons[neuron]->connect(_network->getNeuron(targets[edge]), weights[edge]);
+
+            }
+
+        }
 
     }
 
 }
 
 // ================================================================================================
-// Connect this layer to another layer
+// Densely connect this layer to another layer
 // ================================================================================================
+// Sigmoid layers keep the original uniform weights in [-1, 1], the other functions start with zero
+// biases and weights scaled to the layer size, He for the ReLU variants and Xavier for the rest
 void Layer::connect(Layer* const layer) {
 
-    for (auto& source : _neurons) {
+    _inputs = layer;
+    _inputs->_outputs = this;
+    _weights.resize(_neurons.size() * _inputs->_neurons.size());
 
-        for (auto& target : layer->_neurons) {
+    const double columns = static_cast<double>(_inputs->_neurons.size());
+    const double rows = static_cast<double>(_neurons.size());
 
-            source->connect(target);
+    double limit = 1.0;
 
-        }
+    if (_activation == activation::RELU || _activation == activation::LEAKY_RELU) {
+
+        limit = std::sqrt(6.0 / columns);
+
+    } else if (_activation != activation::SIGMOID) {
+
+        limit = std::sqrt(6.0 / (columns + rows));
+
+    }
+
+    rng::getGenerator().fill(_weights.data(), _weights.size(), -limit, limit);
+
+    if (_activation != activation::SIGMOID) {
+
+        std::fill(_biases.begin(), _biases.end(), 0.0);
 
     }
 
 }
 
 // ================================================================================================
-// Set the activation values of all neurons in the layer
+// Read the biases of this layer from disk and, given an input layer, densely connect it with its weights
 // ================================================================================================
-void Layer::setActivations(const std::vector<double>& activations) {
+void Layer::load(Layer* const layer, std::ifstream& file, const std::size_t weights, const std::size_t biases) {
 
-    if (activations.size() != _neurons.size()) {
+    if (layer) {
 
-        throw std::invalid_argument("Invalid number of activations!");
+        _inputs = layer;
+        _inputs->_outputs = this;
+        _weights.resize(_neurons.size() * _inputs->_neurons.size());
+
+        file.seekg(weights);
+        file.read(reinterpret_cast<char*>(_weights.data()), _weights.size() * sizeof(double));
 
     }
 
-    for (std::size_t index = 0; index < activations.size(); index++) {
+    file.seekg(biases);
+    file.read(reinterpret_cast<char*>(_biases.data()), _biases.size() * sizeof(double));
+
+}
+
+// ================================================================================================
+// Read the biases of this layer from disk and connect it to an input layer with its compressed sparse rows
+// ================================================================================================
+void Layer::load(Layer* const layer, std::ifstream& file, const format::SparseEntry& sparse, const std::size_t biases) {
 
-        _neurons[index]->setActivation(activations[index]);
+    _inputs = layer;
+    _inputs->_outputs = this;
+    _rows.resize(_neurons.size() + 1);
+    _weights.resize(sparse.nonzeros);
+    _columns.resize(sparse.nonzeros);
+
+    file.seekg(sparse.offset);
+    file.read(reinterpret_cast<char*>(_rows.data()), _rows.size() * sizeof(std::uint64_t));
+    file.read(reinterpret_cast<char*>(_weights.data()), _weights.size() * sizeof(double));
+    file.read(reinterpret_cast<char*>(_columns.data()), _columns.size() * sizeof(std::uint32_t));
+
+    if (!file || !format::isValid(_rows.data(), _columns.data(), _neurons.size(), _inputs->_neurons.size(), sparse.nonzeros)) {
+
+        throw std::invalid_argument("Invalid network file!");
 
     }
 
+    file.seekg(biases);
+    file.read(reinterpret_cast<char*>(_biases.data()), _biases.size() * sizeof(double));
+
+}
+
+// ================================================================================================
+// Register a connection between individual neurons that bypasses the weight matrix
+// ================================================================================================
+void Layer::addConnection() {
+
+    // The per-neuron paths index the weights of the next layer as a full matrix
+    if (isPruned() || (_outputs && _outputs->isPruned())) {
+
+        throw std::logic_error("Pruned layers can not be connected to individual neurons!");
+
+    }
+
+    // Every softmax output depends on the whole layer, which the neuron by neuron paths can not express
+    if (_activation == activation::SOFTMAX) {
+
+        throw std::logic_error("Softmax layers can not be connected to individual neurons!");
+
+    }
+
+    // Optimizer state is kept per weight of the full matrix, which individual connections bypass
+    if (_network->getStep().method != optimizer::SGD) {
+
+        throw std::logic_error("Optimizers with state require densely connected layers!");
+
+    }
+
+    _connections++;
+
+}
+
+// ================================================================================================
+// Set the activation function of the layer
+// ================================================================================================
+void Layer::setActivation(const activation::Function function) {
+
+    if (function >= activation::FUNCTION_COUNT) {
+
+        throw std::invalid_argument("Unknown activation function!");
+
+    }
+
+    if (function == activation::SOFTMAX && _connections > 0) {
+
+        throw std::logic_error("Softmax layers can not be connected to individual neurons!");
+
+    }
+
+    _activation = function;
+
+}
+
+// ================================================================================================
+// Get the activation function of the layer
+// ================================================================================================
+activation::Function Layer::getActivation() {
+
+    return _activation;
+
+}
+
+// ================================================================================================
+// Set the activation values of all neurons in the layer
+// ================================================================================================
+void Layer::setActivations(const double* const activations, const std::size_t count) {
+
+    if (count != _neurons.size()) {
+
+        throw std::invalid_argument("Invalid number of activations!");
+
+    }
+
+    std::copy(activations, activations + count, _activations.begin());
+
 }
 
 // ================================================================================================
@@ -83,6 +284,41 @@ void Layer::setActivations(const std::vector<double>& activations) {
 // ================================================================================================
 void Layer::activate() {
 
+    PROFILE_SCOPE(PHASE_FORWARD, getIndex());
+
+    if (isPruned()) {
+
+        kernels::forwardSparse(
+            _rows.data(),
+            _columns.data(),
+            _weights.data(),
+            _biases.data(),
+            _inputs->_activations.data(),
+            _activations.data(),
+            _neurons.size(),
+            _activation
+        );
+
+        return;
+
+    }
+
+    if (_inputs && _connections == 0) {
+
+        kernels::forward(
+            _weights.data(),
+            _biases.data(),
+            _inputs->_activations.data(),
+            _activations.data(),
+            _neurons.size(),
+            _inputs->_neurons.size(),
+            _activation
+        );
+
+        return;
+
+    }
+
     for (auto& neuron : _neurons) {
 
         neuron->activate();
@@ -92,38 +328,94 @@ void Layer::activate() {
 }
 
 // ================================================================================================
-// Get the activation values of all neurons in the layer
+// Activate all neurons in the layer with the vectorised inference kernel
 // ================================================================================================
-std::vector<double> Layer::getActivations() {
+void Layer::infer() {
 
-    std::vector<double> activations;
+    if (isPruned()) {
 
-    for (auto& neuron : _neurons) {
+        PROFILE_SCOPE(PHASE_FORWARD, getIndex());
 
-        activations.push_back(neuron->getActivation());
+        kernels::inferSparse(
+            _rows.data(),
+            _columns.data(),
+            _weights.data(),
+            _biases.data(),
+            _inputs->_activations.data(),
+            _activations.data(),
+            _neurons.size(),
+            _activation
+        );
+
+        return;
+
+    }
+
+    if (_inputs && _connections == 0) {
+
+        PROFILE_SCOPE(PHASE_FORWARD, getIndex());
+
+        kernels::infer(
+            _weights.data(),
+            _biases.data(),
+            _inputs->_activations.data(),
+            _activations.data(),
+            _neurons.size(),
+            _inputs->_neurons.size(),
+            _activation
+        );
+
+        return;
 
     }
 
-    return activations;
+    activate();
+
+}
+
+// ================================================================================================
+// Get the activation values of all neurons in the layer
+// ================================================================================================
+const std::vector<double>& Layer::getActivations() {
+
+    return _activations;
+
+}
+
+// ================================================================================================
+// Copy the activation values of all neurons in the layer into memory owned by the caller
+// ================================================================================================
+void Layer::getActivations(double* const activations) {
+
+    std::copy(_activations.begin(), _activations.end(), activations);
 
 }
 
 // ================================================================================================
 // Set the target values of every neuron in this layer
 // ================================================================================================
-void Layer::setTargets(const std::vector<double>& targets) {
+void Layer::setTargets(const double* const targets, const std::size_t count) {
+
+    PROFILE_SCOPE(PHASE_OUTPUT_DELTA, getIndex());
 
-    if (targets.size() != _neurons.size()) {
+    if (count != _neurons.size()) {
 
         throw std::invalid_argument("Invalid number of targets!");
 
     }
 
-    for (std::size_t index = 0; index < targets.size(); index++) {
+    _loss = kernels::error(_activations.data(), targets, _deltas.data(), _neurons.size(), _activation, _network->getLossFunction());
 
-        _neurons[index]->setTarget(targets[index]);
+    updateBiases(_deltas.data(), 1);
 
-    }
+}
+
+// ================================================================================================
+// Get the summed loss of the targets set last, over every sample of a batch
+// ================================================================================================
+double Layer::getLoss() {
+
+    return _loss;
 
 }
 
@@ -132,12 +424,501 @@ void Layer::setTargets(const std::vector<double>& targets) {
 // ================================================================================================
 void Layer::train() {
 
+    PROFILE_SCOPE(PHASE_BACKWARD, getIndex());
+
+    if (!_outputs || _connections > 0) {
+
+        for (auto& neuron : _neurons) {
+
+            neuron->train();
+
+        }
+
+        return;
+
+    }
+
+    // The deltas of a layer without inputs are never used, so only the weights are updated
+    double* const deltas = _inputs ? _deltas.data() : nullptr;
+
+    if (_inputs) {
+
+        std::fill(_deltas.begin(), _deltas.end(), 0.0);
+
+    }
+
+    if (_outputs->isPruned()) {
+
+        kernels::backwardSparse(
+            _outputs->_rows.data(),
+            _outputs->_columns.data(),
+            _outputs->_weights.data(),
+            _activations.data(),
+            _outputs->_deltas.data(),
+            deltas,
+            _outputs->_neurons.size(),
+            _network->getLearningRate()
+        );
+
+    } else if (_network->getStep().method == optimizer::SGD) {
+
+        kernels::backward(
+            _outputs->_weights.data(),
+            _activations.data(),
+            _outputs->_deltas.data(),
+            deltas,
+            _outputs->_neurons.size(),
+            _neurons.size(),
+            _network->getLearningRate()
+        );
+
+    } else {
+
+        // Optimizers with state need the whole gradient, so the deltas are propagated before the weights change
+        if (deltas) {
+
+            kernels::backwardBatch(_outputs->_weights.data(), _outputs->_deltas.data(), deltas, 1, _outputs->_neurons.size(), _neurons.size());
+
+        }
+
+        _outputs->updateWeights(_activations.data(), _outputs->_deltas.data(), 1);
+
+    }
+
+    if (!_inputs) { return; }
+
+    kernels::derivative(_activations.data(), _deltas.data(), _neurons.size(), _activation);
+
+    updateBiases(_deltas.data(), 1);
+
+}
+
+// ================================================================================================
+// Set the activation values of all neurons in the layer for a batch of samples
+// ================================================================================================
+void Layer::setBatchActivations(const Dataset& activations, const std::size_t offset, const std::size_t samples) {
+
+    if (activations.getPoints() != _neurons.size()) {
+
+        throw std::invalid_argument("Invalid number of activations!");
+
+    }
+
+    _batchActivations.resize(samples * _neurons.size());
+
+    activations.getSamples(offset, samples, _batchActivations.data());
+
+}
+
+// ================================================================================================
+// Set the activation values of all neurons in the layer for a batch of samples in memory owned by the caller
+// ================================================================================================
+void Layer::setBatchActivations(const double* const activations, const std::size_t samples) {
+
+    _batchActivations.resize(samples * _neurons.size());
+
+    std::copy(activations, activations + samples * _neurons.size(), _batchActivations.begin());
+
+}
+
+// ================================================================================================
+// Activate all neurons in the layer for a batch of samples
+// ================================================================================================
+void Layer::activateBatch(const std::size_t samples) {
+
+    PROFILE_SCOPE(PHASE_FORWARD, getIndex());
+
+    _batchActivations.resize(samples * _neurons.size());
+
+    kernels::forwardBatch(
+        _weights.data(),
+        _biases.data(),
+        _inputs->_batchActivations.data(),
+        _batchActivations.data(),
+        samples,
+        _neurons.size(),
+        _inputs->_neurons.size(),
+        _activation
+    );
+
+}
+
+// ================================================================================================
+// Activate all neurons in the layer for a batch of samples with the vectorised inference kernel
+// ================================================================================================
+void Layer::inferBatch(const std::size_t samples) {
+
+    PROFILE_SCOPE(PHASE_FORWARD, getIndex());
+
+    _batchActivations.resize(samples * _neurons.size());
+
+    kernels::inferBatch(
+        _weights.data(),
+        _biases.data(),
+        _inputs->_batchActivations.data(),
+        _batchActivations.data(),
+        samples,
+        _neurons.size(),
+        _inputs->_neurons.size(),
+        _activation
+    );
+
+}
+
+// ================================================================================================
+// Copy the activation values of all neurons in the layer for a batch of samples into memory owned by the caller
+// ================================================================================================
+void Layer::getBatchActivations(double* const activations, const std::size_t samples) {
+
+    std::copy(_batchActivations.begin(), _batchActivations.begin() + samples * _neurons.size(), activations);
+
+}
+
+// ================================================================================================
+// Set the target values of every neuron in this layer for a batch of samples
+// ================================================================================================
+void Layer::setBatchTargets(const Dataset& targets, const std::size_t offset, const std::size_t samples) {
+
+    if (targets.getPoints() != _neurons.size()) {
+
+        throw std::invalid_argument("Invalid number of targets!");
+
+    }
+
+    _batchTargets.resize(samples * _neurons.size());
+    _batchDeltas.resize(samples * _neurons.size());
+
+    targets.getSamples(offset, samples, _batchTargets.data());
+
+    PROFILE_SCOPE(PHASE_OUTPUT_DELTA, getIndex());
+
+    const std::size_t rows = _neurons.size();
+    const loss::Function objective = _network->getLossFunction();
+
+    _loss = 0.0;
+
+    // The error kernel works on one sample at a time, since softmax deltas depend on the whole sample
+    for (std::size_t sample = 0; sample < samples; sample++) {
+
+        _loss += kernels::error(
+            _batchActivations.data() + sample * rows,
+            _batchTargets.data() + sample * rows,
+            _batchDeltas.data() + sample * rows,
+            rows,
+            _activation,
+            objective
+        );
+
+    }
+
+    updateBiases(_batchDeltas.data(), samples);
+
+}
+
+// ================================================================================================
+// Train every neuron in this layer on the mean gradient of a batch of samples
+// ================================================================================================
+void Layer::trainBatch(const std::size_t samples) {
+
+    const double rate = _network->getLearningRate() / samples;
+
+    // The deltas have to be propagated with the weights from before the update
+    if (_inputs) {
+
+        PROFILE_SCOPE(PHASE_BACKWARD, getIndex());
+
+        _batchDeltas.resize(samples * _neurons.size());
+
+        kernels::backwardBatch(
+            _outputs->_weights.data(),
+            _outputs->_batchDeltas.data(),
+            _batchDeltas.data(),
+            samples,
+            _outputs->_neurons.size(),
+            _neurons.size()
+        );
+
+        kernels::derivative(_batchActivations.data(), _batchDeltas.data(), samples * _neurons.size(), _activation);
+
+    }
+
+    PROFILE_SCOPE(PHASE_UPDATE, getIndex());
+
+    if (_network->getStep().method == optimizer::SGD) {
+
+        kernels::accumulateBatch(
+            _outputs->_weights.data(),
+            _batchActivations.data(),
+            _outputs->_batchDeltas.data(),
+            samples,
+            _outputs->_neurons.size(),
+            _neurons.size(),
+            rate
+        );
+
+    } else {
+
+        _outputs->updateWeights(_batchActivations.data(), _outputs->_batchDeltas.data(), samples);
+
+    }
+
+    if (_inputs) {
+
+        updateBiases(_batchDeltas.data(), samples);
+
+    }
+
+}
+
+// ================================================================================================
+// Remove every weight whose magnitude does not exceed a threshold and store the rest as compressed sparse rows
+// ================================================================================================
+void Layer::prune(const double threshold) {
+
+    if (!isPruned() && !isDense()) {
+
+        throw std::logic_error("Pruning requires densely connected layers!");
+
+    }
+
+    const std::size_t columns = _inputs->_neurons.size();
+
+    if (columns > std::numeric_limits<std::uint32_t>::max()) {
+
+        throw std::logic_error("Layer has too many inputs to be pruned!");
+
+    }
+
+    std::vector<std::uint64_t> rows(1, 0);
+    std::vector<std::uint32_t> indices;
+    std::vector<double> values;
+
+    // A dense layer is read as compressed rows that contain every column
+    for (std::size_t row = 0; row < _neurons.size(); row++) {
+
+        const std::size_t first = isPruned() ? _rows[row] : row * columns;
+        const std::size_t last = isPruned() ? _rows[row + 1] : first + columns;
+
+        for (std::size_t entry = first; entry < last; entry++) {
+
+            if (std::abs(_weights[entry]) <= threshold) { continue; }
+
+            indices.push_back(isPruned() ? _columns[entry] : entry - first);
+            values.push_back(_weights[entry]);
+
+        }
+
+        rows.push_back(values.size());
+
+    }
+
+    _rows = std::move(rows);
+    _columns = std::move(indices);
+    _weights = std::move(values);
+
+}
+
+// ================================================================================================
+// Check if the layer is connected to its inputs only through its weight matrix
+// ================================================================================================
+bool Layer::isDense() {
+
+    return _inputs && _connections == 0 && _rows.empty();
+
+}
+
+// ================================================================================================
+// Check if the weights of the layer are stored as compressed sparse rows
+// ================================================================================================
+bool Layer::isPruned() {
+
+    return !_rows.empty();
+
+}
+
+// ================================================================================================
+// Check if the layer has a weight matrix to its input layer, regardless of any individual connections
+// ================================================================================================
+bool Layer::hasWeights() {
+
+    return _inputs != nullptr && _rows.empty();
+
+}
+
+// ================================================================================================
+// Get the individual input connections of every neuron in the layer
+// ================================================================================================
+format::Edges Layer::getEdges() {
+
+    format::Edges edges;
+
+    edges.rows.push_back(0);
+
     for (auto& neuron : _neurons) {
 
-        neuron->train();
+        neuron->getEdges(edges);
+        edges.rows.push_back(edges.targets.size());
 
     }
 
+    return edges;
+
+}
+
+// ================================================================================================
+// Get a pointer to the row-major weight matrix of the layer, or to the remaining weights of a pruned layer
+// ================================================================================================
+double* Layer::getWeights() {
+
+    return _weights.data();
+
+}
+
+// ================================================================================================
+// Get the number of weights the layer stores
+// ================================================================================================
+std::size_t Layer::getWeightCount() {
+
+    return _weights.size();
+
+}
+
+// ================================================================================================
+// Get the L2 norm of the weights the layer stores
+// ================================================================================================
+double Layer::getWeightNorm() {
+
+    return std::sqrt(kernels::dot(_weights.data(), _weights.data(), _weights.size()));
+
+}
+
+// ================================================================================================
+// Get the L2 norm of the weight gradient of the last training step, averaged over a batch of samples
+// ================================================================================================
+// The gradient is never stored, so it is rebuilt from the deltas and the input activations that
+// produced it. A single sample gradient is an outer product, whose norm is the product of the norms
+// of its vectors. A batch gradient is a sum of outer products, whose squared norm is the sum of the
+// products of the dot products of every pair of samples. Layers wired neuron by neuron report zero.
+double Layer::getGradientNorm(const std::size_t samples) {
+
+    if (!_inputs || _connections > 0) { return 0.0; }
+
+    const std::size_t rows = _neurons.size();
+    const std::size_t columns = _inputs->_neurons.size();
+    const double* const inputs = _inputs->_activations.data();
+
+    if (samples == 0 && isPruned()) {
+
+        double sum = 0.0;
+
+        for (std::size_t row = 0; row < rows; row++) {
+
+            for (std::uint64_t entry = _rows[row]; entry < _rows[row + 1]; entry++) {
+
+                sum += _deltas[row] * _deltas[row] * inputs[_columns[entry]] * inputs[_columns[entry]];
+
+            }
+
+        }
+
+        return std::sqrt(sum);
+
+    }
+
+    if (samples == 0) {
+
+        return std::sqrt(kernels::dot(_deltas.data(), _deltas.data(), rows) * kernels::dot(inputs, inputs, columns));
+
+    }
+
+    const double* const deltas = _batchDeltas.data();
+    const double* const activations = _inputs->_batchActivations.data();
+
+    double sum = 0.0;
+
+    for (std::size_t first = 0; first < samples; first++) {
+
+        for (std::size_t second = 0; second <= first; second++) {
+
+            const double product =
+                kernels::dot(deltas + first * rows, deltas + second * rows, rows) *
+                kernels::dot(activations + first * columns, activations + second * columns, columns);
+
+            sum += first == second ? product : 2.0 * product;
+
+        }
+
+    }
+
+    return std::sqrt(std::max(sum, 0.0)) / samples;
+
+}
+
+// ================================================================================================
+// Get a pointer to the row offsets into the remaining weights of a pruned layer
+// ================================================================================================
+std::uint64_t* Layer::getRows() {
+
+    return _rows.data();
+
+}
+
+// ================================================================================================
+// Get a pointer to the input index of every remaining weight of a pruned layer
+// ================================================================================================
+std::uint32_t* Layer::getColumns() {
+
+    return _columns.data();
+
+}
+
+// ================================================================================================
+// Get a pointer to the biases of the layer
+// ================================================================================================
+double* Layer::getBiases() {
+
+    return _biases.data();
+
+}
+
+// ================================================================================================
+// Allocate zeroed optimizer state with a number of values for every weight and bias of the layer
+// ================================================================================================
+// The gradient buffers are only needed by optimizers with state, plain SGD updates in place
+void Layer::resetOptimizerState(const std::size_t values) {
+
+    _weightState.assign(values * _weights.size(), 0.0);
+    _biasState.assign(values * _biases.size(), 0.0);
+    _weightGradients.assign(values > 0 ? _weights.size() : 0, 0.0);
+    _biasGradients.assign(values > 0 ? _biases.size() : 0, 0.0);
+
+    if (values == 0) {
+
+        _weightState.shrink_to_fit();
+        _biasState.shrink_to_fit();
+        _weightGradients.shrink_to_fit();
+        _biasGradients.shrink_to_fit();
+
+    }
+
+}
+
+// ================================================================================================
+// Get a pointer to the optimizer state of the weights, one block of weights per state value
+// ================================================================================================
+double* Layer::getWeightState() {
+
+    return _weightState.data();
+
+}
+
+// ================================================================================================
+// Get a pointer to the optimizer state of the biases, one block of biases per state value
+// ================================================================================================
+double* Layer::getBiasState() {
+
+    return _biasState.data();
+
 }
 
 // ================================================================================================
@@ -149,6 +930,76 @@ std::size_t Layer::getNeuronCount() {
 
 }
 
+// ================================================================================================
+// Get the position of the layer in its network
+// ================================================================================================
+// Sparse layers are not linked to their inputs, so the network is searched instead of the links
+std::size_t Layer::getIndex() {
+
+    std::size_t index = 0;
+
+    while (_network->getLayer(index) != this) {
+
+        index++;
+
+    }
+
+    return index;
+
+}
+
+// ================================================================================================
+// Apply the summed weight gradient of a number of samples with an optimizer that keeps state
+// ================================================================================================
+void Layer::updateWeights(const double* const inputs, const double* const deltas, const std::size_t samples) {
+
+    const std::size_t columns = _inputs->_neurons.size();
+
+    if (samples == 1) {
+
+        kernels::optimizeOuter(_weights.data(), inputs, deltas, _weightState.data(), _neurons.size(), columns, _network->getStep());
+        return;
+
+    }
+
+    std::fill(_weightGradients.begin(), _weightGradients.end(), 0.0);
+
+    kernels::accumulateBatch(_weightGradients.data(), inputs, deltas, samples, _neurons.size(), columns, 1.0);
+    kernels::optimize(_weights.data(), _weightGradients.data(), _weightState.data(), _weights.size(), _weights.size(), 1.0 / samples, _network->getStep());
+
+}
+
+// ================================================================================================
+// Apply the summed bias gradient of a number of samples, which are the deltas of every sample
+// ================================================================================================
+void Layer::updateBiases(const double* const deltas, const std::size_t samples) {
+
+    const optimizer::Step& step = _network->getStep();
+    const std::size_t rows = _neurons.size();
+
+    if (step.method == optimizer::SGD) {
+
+        kernels::updateBatch(_biases.data(), deltas, samples, rows, step.rate / samples);
+        return;
+
+    }
+
+    const double* gradients = deltas;
+
+    if (samples > 1) {
+
+        std::fill(_biasGradients.begin(), _biasGradients.end(), 0.0);
+
+        kernels::updateBatch(_biasGradients.data(), deltas, samples, rows, 1.0);
+
+        gradients = _biasGradients.data();
+
+    }
+
+    kernels::optimize(_biases.data(), gradients, _biasState.data(), rows, rows, 1.0 / samples, step);
+
+}
+
 // ================================================================================================
 // Save the layer to disk
 // ================================================================================================
@@ -0,0 +1,32 @@
+#include "Loss.h"
+#include <stdexcept>
+
+static const char* const FUNCTION_NAMES[] = {"squared-error", "cross-entropy"};
+
+// ================================================================================================
+// Get the name of a loss function as used on the command line
+// ================================================================================================
+const char* loss::getName(const Function function) {
+
+    return function < FUNCTION_COUNT ? FUNCTION_NAMES[function] : "unknown";
+
+}
+
+// ================================================================================================
+// Get a loss function by its name
+// ================================================================================================
+loss::Function loss::getFunction(const std::string& name) {
+
+    for (std::size_t function = 0; function < FUNCTION_COUNT; function++) {
+
+        if (name == FUNCTION_NAMES[function]) {
+
+            return static_cast<Function>(function);
+
+        }
+
+    }
+
+    throw std::invalid_argument("Unknown loss function!");
+
+}
\ No newline at end of file
@@ -1,6 +1,10 @@
 #include "Network.h"
+#include "NetworkFormat.h"
+#include "Kernels.h"
+#include "Profiler.h"
 #include <stdexcept>
 #include <cmath>
+#include <algorithm>
 
 // ================================================================================================
 // Constructor
@@ -9,9 +13,45 @@ Network::Network(
     const std::vector<std::size_t>& topology,
     const double learningRate
 ):
-    _learningRate(learningRate)
+    Network(topology, std::vector<activation::Function>(topology.empty() ? 0 : topology.size() - 1, activation::SIGMOID), learningRate)
 {
 
+}
+
+// ================================================================================================
+// Construct a network with an activation function for every layer after the input layer
+// ================================================================================================
+Network::Network(
+    const std::vector<std::size_t>& topology,
+    const std::vector<activation::Function>& activations,
+    const double learningRate
+):
+    _learningRate(learningRate),
+    _lossFunction(loss::SQUARED_ERROR),
+    _optimizer(optimizer::getSettings(optimizer::SGD)),
+    _step(optimizer::getStep(_optimizer, learningRate, 0)),
+    _steps(0),
+    _trainingLoss(0.0),
+    _trainingSamples(0),
+    _batchSamples(0)
+{
+
+    if (activations.size() + 1 != topology.size()) {
+
+        throw std::invalid_argument("Invalid number of activation functions!");
+
+    }
+
+    for (std::size_t layer = 0; layer + 1 < activations.size(); layer++) {
+
+        if (activations[layer] == activation::SOFTMAX) {
+
+            throw std::invalid_argument("Softmax is only supported in the output layer!");
+
+        }
+
+    }
+
     for (std::size_t layer = 0; layer < topology.size(); layer++) {
 
         createLayer(topology[layer]);
@@ -21,6 +61,8 @@ Network::Network(
             Layer* const source = _layers[layer].get();
             Layer* const target = _layers[layer - 1].get();
 
+            // The activation function decides how the weights are initialised, so it is set first
+            source->setActivation(activations[layer - 1]);
             source->connect(target);
 
         }
@@ -36,9 +78,35 @@ Network::Network(
     std::ifstream& file,
     const double learningRate
 ):
-    _learningRate(learningRate)
+    _learningRate(learningRate),
+    _lossFunction(loss::SQUARED_ERROR),
+    _optimizer(optimizer::getSettings(optimizer::SGD)),
+    _step(optimizer::getStep(_optimizer, learningRate, 0)),
+    _steps(0),
+    _trainingLoss(0.0),
+    _trainingSamples(0),
+    _batchSamples(0)
 {
 
+    PROFILE_SCOPE(PHASE_IO, profiler::NO_LAYER);
+
+    format::Header header;
+
+    const std::streampos position = file.tellg();
+
+    file.read(reinterpret_cast<char*>(&header), sizeof(header));
+
+    if (file && format::isHeader(header)) {
+
+        load(file, header);
+        return;
+
+    }
+
+    // Files without a header are in the legacy format that lists every connection
+    file.clear();
+    file.seekg(position);
+
     std::size_t layers;
     std::size_t inputs;
 
@@ -69,11 +137,9 @@ Layer* Network::createLayer(const std::size_t neurons) {
 // ================================================================================================
 // Create a new neuron in the network
 // ================================================================================================
-Neuron* Network::createNeuron() {
+Neuron* Network::createNeuron(Layer* const layer) {
 
-    _neurons.emplace_back(std::make_unique<Neuron>(this));
-
-    return _neurons.back().get();
+    return _neurons.create(this, layer);
 
 }
 
@@ -82,9 +148,34 @@ Neuron* Network::createNeuron() {
 // ================================================================================================
 Connection* Network::createConnection(Neuron* const source, Neuron* const target) {
 
-    _connections.emplace_back(std::make_unique<Connection>(this, source, target));
+    return _connections.create(this, source, target);
+
+}
+
+// ================================================================================================
+// Create a new connection with a known weight in the network
+// ================================================================================================
+Connection* Network::createConnection(Neuron* const source, Neuron* const target, const double weight) {
+
+    return _connections.create(this, source, target, weight);
+
+}
+
+// ================================================================================================
+// Get the layer count of the network
+// ================================================================================================
+std::size_t Network::getLayerCount() {
+
+    return _layers.size();
 
-    return _connections.back().get();
+}
+
+// ================================================================================================
+// Get a pointer to a layer
+// ================================================================================================
+Layer* Network::getLayer(const std::size_t index) {
+
+    return _layers[index].get();
 
 }
 
@@ -93,7 +184,7 @@ Connection* Network::createConnection(Neuron* const source, Neuron* const target
 // ================================================================================================
 std::size_t Network::getNeuronCount() {
 
-    return _neurons.size();
+    return _neurons.getSize();
 
 }
 
@@ -102,29 +193,141 @@ std::size_t Network::getNeuronCount() {
 // ================================================================================================
 Neuron* Network::getNeuron(const std::size_t id) {
 
-    return _neurons[id].get();
+    return &_neurons[id];
 
 }
 
 // ================================================================================================
-// Get the learning rate of the network
+// Get the learning rate of the next update after the schedule of the optimizer
 // ================================================================================================
 double Network::getLearningRate() {
 
-    return _learningRate;
+    return _step.rate;
+
+}
+
+// ================================================================================================
+// Set the loss function the output layer is trained on
+// ================================================================================================
+void Network::setLossFunction(const loss::Function function) {
+
+    if (function >= loss::FUNCTION_COUNT) {
+
+        throw std::invalid_argument("Unknown loss function!");
+
+    }
+
+    if (!loss::isSupported(function, _layers.back()->getActivation())) {
+
+        throw std::logic_error("Cross-entropy requires a sigmoid or softmax output layer!");
+
+    }
+
+    _lossFunction = function;
+
+}
+
+// ================================================================================================
+// Get the loss function the output layer is trained on
+// ================================================================================================
+loss::Function Network::getLossFunction() {
+
+    return _lossFunction;
+
+}
+
+// ================================================================================================
+// Set the optimizer and learning rate schedule, which start over with zeroed state at step zero
+// ================================================================================================
+void Network::setOptimizer(const optimizer::Settings& settings) {
+
+    if (!optimizer::isValid(settings)) {
+
+        throw std::invalid_argument("Invalid optimizer settings!");
+
+    }
+
+    const std::size_t values = optimizer::getStateCount(settings.method);
+
+    for (std::size_t layer = 1; layer < _layers.size() && values > 0; layer++) {
+
+        if (!_layers[layer]->isDense()) {
+
+            throw std::logic_error("Optimizers with state require densely connected layers!");
+
+        }
+
+    }
+
+    _optimizer = settings;
+    _steps = 0;
+    _step = optimizer::getStep(_optimizer, _learningRate, _steps);
+
+    for (std::size_t layer = 1; layer < _layers.size(); layer++) {
+
+        _layers[layer]->resetOptimizerState(values);
+
+    }
+
+}
+
+// ================================================================================================
+// Get the optimizer and learning rate schedule settings
+// ================================================================================================
+const optimizer::Settings& Network::getOptimizer() {
+
+    return _optimizer;
+
+}
+
+// ================================================================================================
+// Get the parameters of the next update
+// ================================================================================================
+const optimizer::Step& Network::getStep() {
+
+    return _step;
+
+}
+
+// ================================================================================================
+// Get the number of updates applied since the optimizer was set
+// ================================================================================================
+std::uint64_t Network::getStepCount() {
+
+    return _steps;
+
+}
+
+// ================================================================================================
+// Advance the optimizer and its schedule past a number of applied updates
+// ================================================================================================
+void Network::addSteps(const std::uint64_t steps) {
+
+    _steps += steps;
+    _step = optimizer::getStep(_optimizer, _learningRate, _steps);
 
 }
 
 // ================================================================================================
 // Get the network outputs for a given set of inputs
 // ================================================================================================
-std::vector<double> Network::getOutputs(const std::vector<double>& inputs) {
+const std::vector<double>& Network::getOutputs(const std::vector<double>& inputs) {
+
+    return getOutputs(inputs.data(), inputs.size());
+
+}
+
+// ================================================================================================
+// Get the network outputs for a set of inputs in memory owned by the caller
+// ================================================================================================
+// The outputs are the activations of the output layer, which the next call overwrites in place
+const std::vector<double>& Network::getOutputs(const double* const inputs, const std::size_t inputCount) {
 
-    _layers.front()->setActivations(inputs);
+    _layers.front()->setActivations(inputs, inputCount);
 
     for (std::size_t layer = 1; layer < _layers.size(); layer++) {
 
-        _layers[layer]->activate();
+        _layers[layer]->infer();
 
     }
 
@@ -132,14 +335,82 @@ std::vector<double> Network::getOutputs(const std::vector<double>& inputs) {
 
 }
 
+// ================================================================================================
+// Write the network outputs for a batch of samples, stored one sample per row, into memory owned by the caller
+// ================================================================================================
+void Network::predictBatch(const double* const inputs, const std::size_t samples, double* const outputs) {
+
+    const std::size_t inputCount = _layers.front()->getNeuronCount();
+    const std::size_t outputCount = _layers.back()->getNeuronCount();
+
+    bool dense = samples > 1;
+
+    for (std::size_t layer = 1; layer < _layers.size(); layer++) {
+
+        dense = dense && _layers[layer]->isDense();
+
+    }
+
+    // Densely connected networks read every weight block once per group of samples instead of once per sample
+    if (dense) {
+
+        _layers.front()->setBatchActivations(inputs, samples);
+
+        for (std::size_t layer = 1; layer < _layers.size(); layer++) {
+
+            _layers[layer]->inferBatch(samples);
+
+        }
+
+        _layers.back()->getBatchActivations(outputs, samples);
+
+        return;
+
+    }
+
+    for (std::size_t sample = 0; sample < samples; sample++) {
+
+        _layers.front()->setActivations(inputs + sample * inputCount, inputCount);
+
+        for (std::size_t layer = 1; layer < _layers.size(); layer++) {
+
+            _layers[layer]->infer();
+
+        }
+
+        _layers.back()->getActivations(outputs + sample * outputCount);
+
+    }
+
+}
+
 // ================================================================================================
 // Train the network on a given set of inputs and targets
 // ================================================================================================
 void Network::train(const std::vector<double>& inputs, const std::vector<double>& targets) {
 
-    std::vector<double> outputs = getOutputs(inputs);
+    train(inputs.data(), inputs.size(), targets.data(), targets.size());
+
+}
+
+// ================================================================================================
+// Train the network on a set of inputs and targets in memory owned by the caller
+// ================================================================================================
+void Network::train(const double* const inputs, const std::size_t inputCount, const double* const targets, const std::size_t targetCount) {
+
+    // Training uses the exact activation function instead of the vectorised approximation
+    _layers.front()->setActivations(inputs, inputCount);
+
+    for (std::size_t layer = 1; layer < _layers.size(); layer++) {
 
-    _layers.back()->setTargets(targets);
+        _layers[layer]->activate();
+
+    }
+
+    _layers.back()->setTargets(targets, targetCount);
+
+    addTrainingLoss(_layers.back()->getLoss(), 1);
+    _batchSamples = 0;
 
     for (std::size_t layer = _layers.size() - 2; layer < _layers.size(); layer--) {
 
@@ -147,6 +418,79 @@ void Network::train(const std::vector<double>& inputs, const std::vector<double>
 
     }
 
+    addSteps(1);
+
+}
+
+// ================================================================================================
+// Train the network on a set of inputs and targets in batches of a given size
+// ================================================================================================
+void Network::trainBatch(const Dataset& inputs, const Dataset& targets, const std::size_t batchSize) {
+
+    if (batchSize == 0) {
+
+        throw std::invalid_argument("Invalid batch size!");
+
+    }
+
+    for (std::size_t offset = 0; offset < inputs.getSize(); offset += batchSize) {
+
+        trainBatch(inputs, targets, offset, batchSize);
+
+    }
+
+}
+
+// ================================================================================================
+// Train the network on a single batch of inputs and targets starting at an offset
+// ================================================================================================
+void Network::trainBatch(const Dataset& inputs, const Dataset& targets, const std::size_t offset, const std::size_t batchSize) {
+
+    if (inputs.getSize() != targets.getSize()) {
+
+        throw std::invalid_argument("Number of inputs and targets do not match!");
+
+    }
+
+    if (offset >= inputs.getSize() || batchSize == 0) {
+
+        throw std::invalid_argument("Invalid batch range!");
+
+    }
+
+    for (std::size_t layer = 1; layer < _layers.size(); layer++) {
+
+        if (!_layers[layer]->isDense()) {
+
+            throw std::logic_error("Batch training requires densely connected layers!");
+
+        }
+
+    }
+
+    const std::size_t samples = std::min(batchSize, inputs.getSize() - offset);
+
+    _layers.front()->setBatchActivations(inputs, offset, samples);
+
+    for (std::size_t layer = 1; layer < _layers.size(); layer++) {
+
+        _layers[layer]->activateBatch(samples);
+
+    }
+
+    _layers.back()->setBatchTargets(targets, offset, samples);
+
+    addTrainingLoss(_layers.back()->getLoss(), samples);
+    _batchSamples = samples;
+
+    for (std::size_t layer = _layers.size() - 2; layer < _layers.size(); layer--) {
+
+        _layers[layer]->trainBatch(samples);
+
+    }
+
+    addSteps(1);
+
 }
 
 // ================================================================================================
@@ -154,30 +498,309 @@ void Network::train(const std::vector<double>& inputs, const std::vector<double>
 // ================================================================================================
 double Network::getLoss(const std::vector<double>& inputs, const std::vector<double>& targets) {
 
-    std::vector<double> outputs = getOutputs(inputs);
+    return getLoss(inputs.data(), inputs.size(), targets.data(), targets.size());
 
-    if (targets.size() != outputs.size()) {
+}
+
+// ================================================================================================
+// Get the loss of the network for a set of inputs and targets in memory owned by the caller
+// ================================================================================================
+double Network::getLoss(const double* const inputs, const std::size_t inputCount, const double* const targets, const std::size_t targetCount) {
+
+    const std::vector<double>& outputs = getOutputs(inputs, inputCount);
+
+    if (targetCount != outputs.size()) {
 
         throw std::invalid_argument("Invalid number of targets!");
 
     }
 
-    double loss = 0.0;
+    return kernels::loss(outputs.data(), targets, outputs.size(), _layers.back()->getActivation(), _lossFunction);
 
-    for (std::size_t index = 0; index < outputs.size(); index++) {
+}
 
-        loss += std::pow(outputs[index] - targets[index], 2);
+// ================================================================================================
+// Add the summed loss of samples trained outside of the network, such as by a trainer
+// ================================================================================================
+void Network::addTrainingLoss(const double loss, const std::size_t samples) {
+
+    _trainingLoss += loss;
+    _trainingSamples += samples;
+
+}
+
+// ================================================================================================
+// Get the summed loss of every sample trained so far, as measured by its own forward pass
+// ================================================================================================
+double Network::getTrainingLoss() {
+
+    return _trainingLoss;
+
+}
+
+// ================================================================================================
+// Get the number of samples trained so far
+// ================================================================================================
+std::size_t Network::getTrainingSamples() {
+
+    return _trainingSamples;
+
+}
+
+// ================================================================================================
+// Get the L2 norm of the weights of a layer
+// ================================================================================================
+double Network::getWeightNorm(const std::size_t layer) {
+
+    return _layers[layer]->getWeightNorm();
+
+}
+
+// ================================================================================================
+// Get the L2 norm of the weight gradient of a layer from the last training step of the network
+// ================================================================================================
+double Network::getGradientNorm(const std::size_t layer) {
+
+    return _layers[layer]->getGradientNorm(_batchSamples);
+
+}
+
+// ================================================================================================
+// Remove the smallest weights until a fraction of all possible weights is pruned, across all layers or per layer
+// ================================================================================================
+void Network::prune(const double sparsity, const bool global) {
+
+    if (!(sparsity >= 0.0 && sparsity < 1.0)) {
+
+        throw std::invalid_argument("Invalid sparsity!");
+
+    }
+
+    for (std::size_t layer = 1; layer < _layers.size(); layer++) {
+
+        if (!_layers[layer]->isDense() && !_layers[layer]->isPruned()) {
+
+            throw std::logic_error("Pruning requires densely connected layers!");
+
+        }
+
+    }
+
+    // Pruned layers update their remaining weights in place, which leaves no room for optimizer state
+    if (optimizer::getStateCount(_optimizer.method) > 0) {
+
+        throw std::logic_error("Pruned networks can only be trained with plain SGD!");
+
+    }
+
+    // Weights removed by an earlier step count towards the sparsity, so repeated calls prune gradually
+    const auto pruneLayers = [&](const std::size_t first, const std::size_t last) {
+
+        std::vector<double> magnitudes;
+        std::size_t capacity = 0;
+
+        for (std::size_t layer = first; layer < last; layer++) {
+
+            const double* const weights = _layers[layer]->getWeights();
+
+            for (std::size_t weight = 0; weight < _layers[layer]->getWeightCount(); weight++) {
+
+                magnitudes.push_back(std::abs(weights[weight]));
+
+            }
+
+            capacity += _layers[layer]->getNeuronCount() * _layers[layer - 1]->getNeuronCount();
+
+        }
+
+        const std::size_t kept = capacity - static_cast<std::size_t>(sparsity * capacity);
+
+        if (magnitudes.size() <= kept) { return; }
+
+        const std::size_t removed = magnitudes.size() - kept;
+
+        std::nth_element(magnitudes.begin(), magnitudes.begin() + removed - 1, magnitudes.end());
+
+        for (std::size_t layer = first; layer < last; layer++) {
+
+            _layers[layer]->prune(magnitudes[removed - 1]);
+
+        }
+
+    };
+
+    if (global) {
+
+        pruneLayers(1, _layers.size());
+        return;
+
+    }
+
+    for (std::size_t layer = 1; layer < _layers.size(); layer++) {
+
+        pruneLayers(layer, layer + 1);
+
+    }
+
+}
+
+// ================================================================================================
+// Get the fraction of the weights between consecutive layers that has been pruned
+// ================================================================================================
+double Network::getSparsity() {
+
+    std::size_t weights = 0;
+    std::size_t capacity = 0;
+
+    for (std::size_t layer = 1; layer < _layers.size(); layer++) {
+
+        if (!_layers[layer]->isDense() && !_layers[layer]->isPruned()) { continue; }
+
+        weights += _layers[layer]->getWeightCount();
+        capacity += _layers[layer]->getNeuronCount() * _layers[layer - 1]->getNeuronCount();
+
+    }
+
+    return capacity == 0 ? 0.0 : 1.0 - static_cast<double>(weights) / capacity;
+
+}
+
+// ================================================================================================
+// Save the network to disk as weight blocks, with explicit edges only for sparse connections and
+// compressed sparse rows only for pruned layers
+// ================================================================================================
+void Network::save(std::ostream& file) {
+
+    PROFILE_SCOPE(PHASE_IO, profiler::NO_LAYER);
+
+    std::vector<format::LayerEntry> layers(_layers.size(), {0, 0, 0});
+    std::vector<format::EdgeEntry> edges(_layers.size(), {0, 0});
+    std::vector<format::SparseEntry> pruned(_layers.size(), {0, 0});
+    std::vector<format::ActivationEntry> activations(_layers.size(), {activation::SIGMOID});
+    std::vector<format::StateEntry> states(_layers.size(), {0});
+    std::vector<format::Edges> connections(_layers.size());
+
+    bool sparse = false;
+    bool compressed = false;
+    bool activated = false;
+
+    for (std::size_t layer = 0; layer < _layers.size(); layer++) {
+
+        layers[layer].neurons = _layers[layer]->getNeuronCount();
+
+        if (layer == 0) { continue; }
+
+        activations[layer].function = _layers[layer]->getActivation();
+        activated = activated || activations[layer].function != activation::SIGMOID;
+
+        // A non-zero weight offset marks the layers that have a weight matrix before the layout is set
+        layers[layer].weights = _layers[layer]->hasWeights() ? 1 : 0;
+        connections[layer] = _layers[layer]->getEdges();
+        edges[layer].edges = connections[layer].targets.size();
+
+        // Pruned layers are marked the same way through a non-zero sparse offset
+        pruned[layer].offset = _layers[layer]->isPruned() ? 1 : 0;
+        pruned[layer].nonzeros = _layers[layer]->isPruned() ? _layers[layer]->getWeightCount() : 0;
+
+        sparse = sparse || (layers[layer].weights == 0 && pruned[layer].offset == 0) || edges[layer].edges != 0;
+        compressed = compressed || pruned[layer].offset != 0;
+
+    }
+
+    // Densely connected networks leave out the edge table, unpruned networks the sparse table and sigmoid
+    // networks the activation table entirely
+    if (!sparse) { edges.clear(); }
+    if (!compressed) { pruned.clear(); }
+    if (!activated) { activations.clear(); }
+
+    // Plain SGD at a constant rate has nothing to resume, so it leaves out the optimizer entry and the state
+    const bool optimized = _optimizer.method != optimizer::SGD || _optimizer.schedule != optimizer::CONSTANT || _optimizer.warmup != 0;
+    const std::size_t values = optimizer::getStateCount(_optimizer.method);
+    const format::OptimizerEntry optimizerEntry = format::getEntry(_optimizer, _steps);
+
+    if (!optimized) { states.clear(); }
+
+    format::setLayout(layers, edges, pruned, activations, states, values);
+
+    const std::uint32_t flags = (sparse ? NETWORK_FORMAT_EDGES : 0u) | (compressed ? NETWORK_FORMAT_PRUNED : 0u) | (activated ? NETWORK_FORMAT_ACTIVATIONS : 0u) | (optimized ? NETWORK_FORMAT_OPTIMIZER : 0u);
+    const format::Header header = format::getHeader(_layers.size(), flags);
+
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(layers.data()), layers.size() * sizeof(format::LayerEntry));
+    file.write(reinterpret_cast<const char*>(edges.data()), edges.size() * sizeof(format::EdgeEntry));
+    file.write(reinterpret_cast<const char*>(pruned.data()), pruned.size() * sizeof(format::SparseEntry));
+    file.write(reinterpret_cast<const char*>(activations.data()), activations.size() * sizeof(format::ActivationEntry));
+
+    if (optimized) {
+
+        file.write(reinterpret_cast<const char*>(&optimizerEntry), sizeof(optimizerEntry));
+        file.write(reinterpret_cast<const char*>(states.data()), states.size() * sizeof(format::StateEntry));
 
     }
 
-    return loss;
+    const char padding[NETWORK_FORMAT_ALIGNMENT] = {};
+
+    const auto writeBlock = [&](const std::uint64_t offset, const void* const data, const std::uint64_t size) {
+
+        file.write(padding, offset - static_cast<std::uint64_t>(file.tellp()));
+        file.write(reinterpret_cast<const char*>(data), size);
+
+    };
+
+    for (std::size_t layer = 1; layer < _layers.size(); layer++) {
+
+        if (layers[layer].weights != 0) {
+
+            writeBlock(layers[layer].weights, _layers[layer]->getWeights(), layers[layer].neurons * layers[layer - 1].neurons * sizeof(double));
+
+        }
+
+        if (compressed && pruned[layer].offset != 0) {
+
+            writeBlock(pruned[layer].offset, _layers[layer]->getRows(), (layers[layer].neurons + 1) * sizeof(std::uint64_t));
+            file.write(reinterpret_cast<const char*>(_layers[layer]->getWeights()), pruned[layer].nonzeros * sizeof(double));
+            file.write(reinterpret_cast<const char*>(_layers[layer]->getColumns()), pruned[layer].nonzeros * sizeof(std::uint32_t));
+
+        }
+
+        writeBlock(layers[layer].biases, _layers[layer]->getBiases(), layers[layer].neurons * sizeof(double));
+
+        if (optimized && values > 0) {
+
+            writeBlock(states[layer].offset, _layers[layer]->getWeightState(), values * _layers[layer]->getWeightCount() * sizeof(double));
+            file.write(reinterpret_cast<const char*>(_layers[layer]->getBiasState()), values * layers[layer].neurons * sizeof(double));
+
+        }
+
+        if (sparse && edges[layer].edges != 0) {
+
+            writeBlock(edges[layer].offset, connections[layer].rows.data(), connections[layer].rows.size() * sizeof(std::uint64_t));
+            file.write(reinterpret_cast<const char*>(connections[layer].targets.data()), edges[layer].edges * sizeof(std::uint64_t));
+            file.write(reinterpret_cast<const char*>(connections[layer].weights.data()), edges[layer].edges * sizeof(double));
+
+        }
+
+    }
 
 }
 
 // ================================================================================================
-// Save the network to disk
+// Save the network to disk in the legacy format that lists every connection
 // ================================================================================================
-void Network::save(std::ofstream& file) {
+void Network::saveLegacy(std::ofstream& file) {
+
+    PROFILE_SCOPE(PHASE_IO, profiler::NO_LAYER);
+
+    // The legacy format has no place for activation functions, so it can only hold sigmoid networks
+    for (std::size_t layer = 1; layer < _layers.size(); layer++) {
+
+        if (_layers[layer]->getActivation() != activation::SIGMOID) {
+
+            throw std::logic_error("The legacy format only supports sigmoid activations!");
+
+        }
+
+    }
 
     const std::size_t layers = _layers.size();
     const std::size_t inputs = _layers.front()->getNeuronCount();
@@ -194,34 +817,162 @@ void Network::save(std::ofstream& file) {
 }
 
 // ================================================================================================
-// Load a layer from disk
+// Load the weight blocks and explicit edges of a network file after its header
 // ================================================================================================
-Layer* Network::loadLayer(std::ifstream& file) {
+void Network::load(std::ifstream& file, const format::Header& header) {
 
-    _layers.emplace_back(std::make_unique<Layer>(this, file));
+    if (header.byteOrder != NETWORK_FORMAT_BYTE_ORDER) {
 
-    return _layers.back().get();
+        throw std::invalid_argument("Unsupported network file byte order!");
 
-}
+    }
 
-// ================================================================================================
-// Load a neuron from disk
-// ================================================================================================
-Neuron* Network::loadNeuron(std::ifstream& file) {
+    if (header.version != NETWORK_FORMAT_VERSION || (header.flags & ~(NETWORK_FORMAT_EDGES | NETWORK_FORMAT_PRUNED | NETWORK_FORMAT_ACTIVATIONS | NETWORK_FORMAT_OPTIMIZER)) != 0) {
+
+        throw std::invalid_argument("Unsupported network file version!");
+
+    }
+
+    const std::streampos position = file.tellg();
+
+    file.seekg(0, std::ios::end);
+
+    const std::uint64_t length = file.tellg();
 
-    _neurons.emplace_back(std::make_unique<Neuron>(this, file));
+    file.seekg(position);
+
+    // The layer count is checked against the file size before it is trusted with an allocation
+    const std::size_t count = header.layers > length / sizeof(format::LayerEntry) ? 0 : header.layers;
+
+    std::vector<format::LayerEntry> layers(count);
+    std::vector<format::EdgeEntry> edges(header.flags & NETWORK_FORMAT_EDGES ? count : 0);
+    std::vector<format::SparseEntry> pruned(header.flags & NETWORK_FORMAT_PRUNED ? count : 0);
+    std::vector<format::ActivationEntry> activations(header.flags & NETWORK_FORMAT_ACTIVATIONS ? count : 0);
+    std::vector<format::StateEntry> states(header.flags & NETWORK_FORMAT_OPTIMIZER ? count : 0);
+    format::OptimizerEntry optimizerEntry = format::getEntry(_optimizer, 0);
+
+    file.read(reinterpret_cast<char*>(layers.data()), layers.size() * sizeof(format::LayerEntry));
+    file.read(reinterpret_cast<char*>(edges.data()), edges.size() * sizeof(format::EdgeEntry));
+    file.read(reinterpret_cast<char*>(pruned.data()), pruned.size() * sizeof(format::SparseEntry));
+    file.read(reinterpret_cast<char*>(activations.data()), activations.size() * sizeof(format::ActivationEntry));
+
+    if (header.flags & NETWORK_FORMAT_OPTIMIZER) {
+
+        file.read(reinterpret_cast<char*>(&optimizerEntry), sizeof(optimizerEntry));
+        file.read(reinterpret_cast<char*>(states.data()), states.size() * sizeof(format::StateEntry));
+
+    }
 
-    return _neurons.back().get();
+    const bool optimized = format::isValid(optimizerEntry) && optimizer::isValid(format::getSettings(optimizerEntry));
+    const std::size_t values = optimized ? optimizer::getStateCount(format::getSettings(optimizerEntry).method) : 0;
+
+    if (!file || !optimized || !format::isValid(layers, edges, pruned, activations, states, values, length)) {
+
+        throw std::invalid_argument("Invalid network file!");
+
+    }
+
+    createLayer(layers.front().neurons);
+
+    for (std::size_t layer = 1; layer < layers.size(); layer++) {
+
+        Layer* const current = createLayer(layers[layer].neurons);
+
+        if (!activations.empty()) {
+
+            current->setActivation(static_cast<activation::Function>(activations[layer].function));
+
+        }
+
+        if (!pruned.empty() && pruned[layer].offset != 0) {
+
+            current->load(_layers[layer - 1].get(), file, pruned[layer], layers[layer].biases);
+
+        } else {
+
+            current->load(layers[layer].weights != 0 ? _layers[layer - 1].get() : nullptr, file, layers[layer].weights, layers[layer].biases);
+
+        }
+
+        if (edges.empty() || edges[layer].edges == 0) { continue; }
+
+        format::Edges connections = {
+            std::vector<std::uint64_t>(layers[layer].neurons + 1),
+            std::vector<std::uint64_t>(edges[layer].edges),
+            std::vector<double>(edges[layer].edges)
+        };
+
+        file.seekg(edges[layer].offset);
+        file.read(reinterpret_cast<char*>(connections.rows.data()), connections.rows.size() * sizeof(std::uint64_t));
+        file.read(reinterpret_cast<char*>(connections.targets.data()), connections.targets.size() * sizeof(std::uint64_t));
+        file.read(reinterpret_cast<char*>(connections.weights.data()), connections.weights.size() * sizeof(double));
+
+        if (!file || connections.rows.front() != 0 || connections.rows.back() != edges[layer].edges) {
+
+            throw std::invalid_argument("Invalid network file!");
+
+        }
+
+        // Edges can only lead to neurons that already exist, which are the ones of earlier layers
+        const std::size_t first = _neurons.getSize() - layers[layer].neurons;
+
+        for (std::size_t neuron = 0; neuron < layers[layer].neurons; neuron++) {
+
+            if (connections.rows[neuron] > connections.rows[neuron + 1]) {
+
+                throw std::invalid_argument("Invalid network file!");
+
+            }
+
+            for (std::size_t edge = connections.rows[neuron]; edge < connections.rows[neuron + 1]; edge++) {
+
+                if (connections.targets[edge] >= first) {
+
+                    throw std::invalid_argument("Invalid network file!");
+
+                }
+
+                getNeuron(first + neuron)->connect(getNeuron(connections.targets[edge]), connections.weights[edge]);
+
+            }
+
+        }
+
+    }
+
+    // The optimizer resumes with its state and the step its schedule had reached when it was saved
+    if (!states.empty()) {
+
+        setOptimizer(format::getSettings(optimizerEntry));
+
+        _steps = optimizerEntry.steps;
+        _step = optimizer::getStep(_optimizer, _learningRate, _steps);
+
+        for (std::size_t layer = 1; layer < _layers.size() && values > 0; layer++) {
+
+            file.seekg(states[layer].offset);
+            file.read(reinterpret_cast<char*>(_layers[layer]->getWeightState()), values * _layers[layer]->getWeightCount() * sizeof(double));
+            file.read(reinterpret_cast<char*>(_layers[layer]->getBiasState()), values * layers[layer].neurons * sizeof(double));
+
+        }
+
+    }
+
+    if (!file) {
+
+        throw std::invalid_argument("Invalid network file!");
+
+    }
 
 }
 
 // ================================================================================================
-// Load a connection from disk
+// Load a layer from disk
 // ================================================================================================
-Connection* Network::loadConnection(Neuron* const source, std::ifstream& file) {
+Layer* Network::loadLayer(std::ifstream& file) {
 
-    _connections.emplace_back(std::make_unique<Connection>(this, source, file));
+    _layers.emplace_back(std::make_unique<Layer>(this, _layers.back().get(), file));
 
-    return _connections.back().get();
+    return _layers.back().get();
 
 }
\ No newline at end of file
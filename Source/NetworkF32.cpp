@@ -0,0 +1,318 @@
+#include "NetworkF32.h"
+#include "Network.h"
+#include "Kernels.h"
+#include "Profiler.h"
+#include <stdexcept>
+#include <algorithm>
+
+// ================================================================================================
+// Construct a single precision copy of a network
+// ================================================================================================
+NetworkF32::NetworkF32(
+    Network* const network
+):
+    _learningRate(static_cast<float>(network->getLearningRate()))
+{
+
+    convert(network);
+
+}
+
+// ================================================================================================
+// Construct a single precision network from a double precision file on disk
+// ================================================================================================
+NetworkF32::NetworkF32(
+    std::ifstream& file,
+    const float learningRate
+):
+    _learningRate(learningRate)
+{
+
+    Network network(file, learningRate);
+
+    convert(&network);
+
+}
+
+// ================================================================================================
+// Get the layer count of the network
+// ================================================================================================
+std::size_t NetworkF32::getLayerCount() {
+
+    return _layers.size();
+
+}
+
+// ================================================================================================
+// Get the number of neurons in a layer
+// ================================================================================================
+std::size_t NetworkF32::getNeuronCount(const std::size_t layer) {
+
+    return _layers[layer].biases.size();
+
+}
+
+// ================================================================================================
+// Get the learning rate of the network
+// ================================================================================================
+float NetworkF32::getLearningRate() {
+
+    return _learningRate;
+
+}
+
+// ================================================================================================
+// Get the outputs of the network for a given set of inputs
+// ================================================================================================
+const std::vector<float>& NetworkF32::getOutputs(const std::vector<float>& inputs) {
+
+    setActivations(inputs.data(), inputs.size());
+
+    return infer();
+
+}
+
+// ================================================================================================
+// Get the outputs of the network for a set of double precision inputs owned by the caller
+// ================================================================================================
+const std::vector<float>& NetworkF32::getOutputs(const double* const inputs, const std::size_t inputCount) {
+
+    setActivations(inputs, inputCount);
+
+    return infer();
+
+}
+
+// ================================================================================================
+// Train the network on a set of inputs and targets
+// ================================================================================================
+void NetworkF32::train(const std::vector<float>& inputs, const std::vector<float>& targets) {
+
+    setActivations(inputs.data(), inputs.size());
+
+    // Training uses the exact activation function instead of the vectorised approximation
+    for (std::size_t layer = 1; layer < _layers.size(); layer++) {
+
+        PROFILE_SCOPE(PHASE_FORWARD, layer);
+
+        kernels::forward(
+            _layers[layer].weights.data(),
+            _layers[layer].biases.data(),
+            _layers[layer - 1].activations.data(),
+            _layers[layer].activations.data(),
+            _layers[layer].biases.size(),
+            _layers[layer - 1].biases.size(),
+            _layers[layer].activation
+        );
+
+    }
+
+    DenseLayer& output = _layers.back();
+
+    if (targets.size() != output.biases.size()) {
+
+        throw std::invalid_argument("Invalid number of targets!");
+
+    }
+
+    kernels::error(output.activations.data(), targets.data(), output.deltas.data(), output.biases.size(), output.activation, _lossFunction);
+    kernels::update(output.biases.data(), output.deltas.data(), output.biases.size(), _learningRate);
+
+    // Every layer updates the weights of the layer above it, the deltas of a layer without inputs are never used
+    for (std::size_t layer = _layers.size() - 2; layer < _layers.size(); layer--) {
+
+        DenseLayer& current = _layers[layer];
+        DenseLayer& next = _layers[layer + 1];
+
+        if (layer > 0) {
+
+            std::fill(current.deltas.begin(), current.deltas.end(), 0.0f);
+
+        }
+
+        kernels::backward(
+            next.weights.data(),
+            current.activations.data(),
+            next.deltas.data(),
+            layer > 0 ? current.deltas.data() : nullptr,
+            next.biases.size(),
+            current.biases.size(),
+            _learningRate
+        );
+
+        if (layer > 0) {
+
+            kernels::derivative(current.activations.data(), current.deltas.data(), current.biases.size(), current.activation);
+            kernels::update(current.biases.data(), current.deltas.data(), current.biases.size(), _learningRate);
+
+        }
+
+    }
+
+}
+
+// ================================================================================================
+// Get the loss of the network for given set of inputs and targets
+// ================================================================================================
+float NetworkF32::getLoss(const std::vector<float>& inputs, const std::vector<float>& targets) {
+
+    const std::vector<float>& outputs = getOutputs(inputs);
+
+    if (targets.size() != outputs.size()) {
+
+        throw std::invalid_argument("Invalid number of targets!");
+
+    }
+
+    return kernels::loss(outputs.data(), targets.data(), outputs.size(), _layers.back().activation, _lossFunction);
+
+}
+
+// ================================================================================================
+// Save the network to disk in the double precision network format
+// ================================================================================================
+void NetworkF32::save(std::ofstream& file) {
+
+    // The listed connections of the legacy format leave no place for activation functions
+    for (const auto& layer : _layers) {
+
+        if (layer.activation != activation::SIGMOID) {
+
+            throw std::logic_error("The legacy format only supports sigmoid activations!");
+
+        }
+
+    }
+
+    const std::size_t layers = _layers.size();
+    const std::size_t inputs = _layers.front().biases.size();
+
+    file.write(reinterpret_cast<const char*>(&layers), sizeof(layers));
+    file.write(reinterpret_cast<const char*>(&inputs), sizeof(inputs));
+
+    // Neuron IDs are assigned in order of creation, so every layer continues where the last one ended
+    std::size_t firstInput = 0;
+
+    for (std::size_t layer = 1; layer < layers; layer++) {
+
+        const std::size_t neurons = _layers[layer].biases.size();
+        const std::size_t columns = _layers[layer - 1].biases.size();
+
+        file.write(reinterpret_cast<const char*>(&neurons), sizeof(neurons));
+
+        for (std::size_t neuron = 0; neuron < neurons; neuron++) {
+
+            const double bias = _layers[layer].biases[neuron];
+
+            file.write(reinterpret_cast<const char*>(&bias), sizeof(bias));
+            file.write(reinterpret_cast<const char*>(&columns), sizeof(columns));
+
+            for (std::size_t column = 0; column < columns; column++) {
+
+                const std::size_t target = firstInput + column;
+                const double weight = _layers[layer].weights[neuron * columns + column];
+
+                file.write(reinterpret_cast<const char*>(&target), sizeof(target));
+                file.write(reinterpret_cast<const char*>(&weight), sizeof(weight));
+
+            }
+
+        }
+
+        firstInput += columns;
+
+    }
+
+}
+
+// ================================================================================================
+// Copy the weights, biases and loss function of a densely connected network in single precision
+// ================================================================================================
+void NetworkF32::convert(Network* const network) {
+
+    _lossFunction = network->getLossFunction();
+    _layers.resize(network->getLayerCount());
+
+    for (std::size_t layer = 0; layer < _layers.size(); layer++) {
+
+        Layer* const source = network->getLayer(layer);
+
+        const std::size_t rows = source->getNeuronCount();
+
+        if (layer > 0 && !source->isDense()) {
+
+            throw std::logic_error("Single precision networks require densely connected layers!");
+
+        }
+
+        _layers[layer].activation = source->getActivation();
+        _layers[layer].biases.assign(source->getBiases(), source->getBiases() + rows);
+        _layers[layer].activations.resize(rows, 0.0f);
+        _layers[layer].deltas.resize(rows, 0.0f);
+
+        if (layer > 0) {
+
+            const std::size_t columns = network->getLayer(layer - 1)->getNeuronCount();
+
+            _layers[layer].weights.assign(source->getWeights(), source->getWeights() + rows * columns);
+
+        }
+
+    }
+
+}
+
+// ================================================================================================
+// Set the activation values of the input layer
+// ================================================================================================
+void NetworkF32::setActivations(const float* const inputs, const std::size_t inputCount) {
+
+    if (inputCount != _layers.front().activations.size()) {
+
+        throw std::invalid_argument("Invalid number of activations!");
+
+    }
+
+    std::copy(inputs, inputs + inputCount, _layers.front().activations.begin());
+
+}
+
+// ================================================================================================
+// Set the activation values of the input layer from double precision inputs
+// ================================================================================================
+void NetworkF32::setActivations(const double* const inputs, const std::size_t inputCount) {
+
+    if (inputCount != _layers.front().activations.size()) {
+
+        throw std::invalid_argument("Invalid number of activations!");
+
+    }
+
+    std::copy(inputs, inputs + inputCount, _layers.front().activations.begin());
+
+}
+
+// ================================================================================================
+// Activate all layers for inference and get the activations of the output layer
+// ================================================================================================
+const std::vector<float>& NetworkF32::infer() {
+
+    for (std::size_t layer = 1; layer < _layers.size(); layer++) {
+
+        PROFILE_SCOPE(PHASE_FORWARD, layer);
+
+        kernels::infer(
+            _layers[layer].weights.data(),
+            _layers[layer].biases.data(),
+            _layers[layer - 1].activations.data(),
+            _layers[layer].activations.data(),
+            _layers[layer].biases.size(),
+            _layers[layer - 1].biases.size(),
+            _layers[layer].activation
+        );
+
+    }
+
+    return _layers.back().activations;
+
+}
\ No newline at end of file
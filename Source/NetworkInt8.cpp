@@ -0,0 +1,385 @@
+#include "NetworkInt8.h"
+#include "Network.h"
+#include "Kernels.h"
+#include "Profiler.h"
+#include <stdexcept>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#define NETWORK_INT8_MAGIC "SNQ8"
+#define NETWORK_INT8_RANGE 127.0f
+
+// ================================================================================================
+// Get the scale that maps the largest magnitude of a set of values onto the int8 range
+// ================================================================================================
+static float getScale(const float maximum) {
+
+    return maximum > 0.0f ? maximum / NETWORK_INT8_RANGE : 1.0f;
+
+}
+
+// ================================================================================================
+// Round a value to the nearest int8 step of a scale
+// ================================================================================================
+static std::int8_t getQuantized(const float value, const float inverseScale) {
+
+    // Rounding half away from zero by hand keeps the loops over whole layers vectorisable
+    const float quantized = std::max(-NETWORK_INT8_RANGE, std::min(NETWORK_INT8_RANGE, value * inverseScale));
+
+    return static_cast<std::int8_t>(quantized + (quantized < 0.0f ? -0.5f : 0.5f));
+
+}
+
+// ================================================================================================
+// Quantise a trained network, calibrating the activation scales on a sample of inputs
+// ================================================================================================
+NetworkInt8::NetworkInt8(
+    Network* const network,
+    const Dataset& calibration,
+    const std::size_t samples
+) {
+
+    if (samples == 0 || samples > calibration.getSize()) {
+
+        throw std::invalid_argument("Invalid number of calibration samples!");
+
+    }
+
+    _layers.resize(network->getLayerCount());
+
+    std::vector<float> maximums(_layers.size(), 0.0f);
+    std::vector<double> inputs(calibration.getPoints());
+
+    for (std::size_t sample = 0; sample < samples; sample++) {
+
+        calibration.getSample(sample, inputs.data());
+        network->getOutputs(inputs.data(), inputs.size());
+
+        for (std::size_t layer = 0; layer < _layers.size(); layer++) {
+
+            for (const double activation : network->getLayer(layer)->getActivations()) {
+
+                maximums[layer] = std::max(maximums[layer], static_cast<float>(std::fabs(activation)));
+
+            }
+
+        }
+
+    }
+
+    for (std::size_t layer = 0; layer < _layers.size(); layer++) {
+
+        Layer* const source = network->getLayer(layer);
+
+        const std::size_t rows = source->getNeuronCount();
+
+        if (layer > 0 && !source->isDense()) {
+
+            throw std::logic_error("Quantised networks require densely connected layers!");
+
+        }
+
+        // The quantised kernels fuse the sigmoid function into their dequantisation
+        if (layer > 0 && source->getActivation() != activation::SIGMOID) {
+
+            throw std::logic_error("Quantised networks require sigmoid activations!");
+
+        }
+
+        _layers[layer].scale = getScale(maximums[layer]);
+        _layers[layer].biases.assign(source->getBiases(), source->getBiases() + rows);
+        _layers[layer].activations.resize(rows, 0.0f);
+        _layers[layer].quantized.resize(rows, 0);
+
+        if (layer == 0) { continue; }
+
+        const std::size_t columns = network->getLayer(layer - 1)->getNeuronCount();
+        const double* const weights = source->getWeights();
+
+        _layers[layer].weights.resize(rows * columns);
+        _layers[layer].scales.resize(rows);
+
+        // Every row gets its own weight scale, combined with the activation scale of the inputs
+        for (std::size_t row = 0; row < rows; row++) {
+
+            float maximum = 0.0f;
+
+            for (std::size_t column = 0; column < columns; column++) {
+
+                maximum = std::max(maximum, static_cast<float>(std::fabs(weights[row * columns + column])));
+
+            }
+
+            const float scale = getScale(maximum);
+
+            for (std::size_t column = 0; column < columns; column++) {
+
+                _layers[layer].weights[row * columns + column] = getQuantized(static_cast<float>(weights[row * columns + column]), 1.0f / scale);
+
+            }
+
+            _layers[layer].scales[row] = scale * _layers[layer - 1].scale;
+
+        }
+
+    }
+
+}
+
+// ================================================================================================
+// Construct a quantised network from disk
+// ================================================================================================
+NetworkInt8::NetworkInt8(
+    std::ifstream& file
+) {
+
+    char magic[sizeof(NETWORK_INT8_MAGIC) - 1];
+    std::size_t layers;
+
+    const std::streampos position = file.tellg();
+
+    file.seekg(0, std::ios::end);
+
+    const std::uint64_t length = file.tellg();
+
+    file.seekg(position);
+
+    file.read(magic, sizeof(magic));
+    file.read(reinterpret_cast<char*>(&layers), sizeof(layers));
+
+    // Counts are bounded by the file length before they are trusted with an allocation, every layer has at
+    // least its neuron count and scale in the file
+    if (!file || std::memcmp(magic, NETWORK_INT8_MAGIC, sizeof(magic)) != 0 || layers < 2 || layers > length / (sizeof(std::size_t) + sizeof(float))) {
+
+        throw std::invalid_argument("Invalid quantised network file!");
+
+    }
+
+    _layers.resize(layers);
+
+    for (auto& layer : _layers) {
+
+        std::size_t neurons;
+
+        file.read(reinterpret_cast<char*>(&neurons), sizeof(neurons));
+        file.read(reinterpret_cast<char*>(&layer.scale), sizeof(layer.scale));
+
+        if (!file || neurons > length / sizeof(float)) {
+
+            throw std::invalid_argument("Invalid quantised network file!");
+
+        }
+
+        layer.biases.resize(neurons, 0.0f);
+        layer.activations.resize(neurons, 0.0f);
+        layer.quantized.resize(neurons, 0);
+
+    }
+
+    // The blocks of every layer have to fit into the rest of the file, which also keeps their sizes from
+    // overflowing since each one is checked before it is added
+    const std::uint64_t remaining = length - static_cast<std::uint64_t>(file.tellg());
+
+    std::uint64_t size = 0;
+
+    for (std::size_t layer = 1; layer < layers; layer++) {
+
+        const std::uint64_t rows = _layers[layer].biases.size();
+        const std::uint64_t columns = _layers[layer - 1].biases.size();
+
+        if (columns > 0 && rows > remaining / columns) {
+
+            throw std::invalid_argument("Invalid quantised network file!");
+
+        }
+
+        size += rows * 2 * sizeof(float) + rows * columns * sizeof(std::int8_t);
+
+        if (size > remaining) {
+
+            throw std::invalid_argument("Invalid quantised network file!");
+
+        }
+
+    }
+
+    for (std::size_t layer = 1; layer < layers; layer++) {
+
+        const std::size_t rows = _layers[layer].biases.size();
+        const std::size_t columns = _layers[layer - 1].biases.size();
+
+        _layers[layer].scales.resize(rows);
+        _layers[layer].weights.resize(rows * columns);
+
+        file.read(reinterpret_cast<char*>(_layers[layer].biases.data()), rows * sizeof(float));
+        file.read(reinterpret_cast<char*>(_layers[layer].scales.data()), rows * sizeof(float));
+        file.read(reinterpret_cast<char*>(_layers[layer].weights.data()), rows * columns * sizeof(std::int8_t));
+
+        if (!file) {
+
+            throw std::invalid_argument("Invalid quantised network file!");
+
+        }
+
+    }
+
+}
+
+// ================================================================================================
+// Check if a file holds a quantised network without moving its read position
+// ================================================================================================
+bool NetworkInt8::isQuantized(std::ifstream& file) {
+
+    char magic[sizeof(NETWORK_INT8_MAGIC) - 1] = {};
+
+    const std::streampos position = file.tellg();
+
+    file.read(magic, sizeof(magic));
+    file.clear();
+    file.seekg(position);
+
+    return std::memcmp(magic, NETWORK_INT8_MAGIC, sizeof(magic)) == 0;
+
+}
+
+// ================================================================================================
+// Get the layer count of the network
+// ================================================================================================
+std::size_t NetworkInt8::getLayerCount() {
+
+    return _layers.size();
+
+}
+
+// ================================================================================================
+// Get the number of neurons in a layer
+// ================================================================================================
+std::size_t NetworkInt8::getNeuronCount(const std::size_t layer) {
+
+    return _layers[layer].biases.size();
+
+}
+
+// ================================================================================================
+// Get the outputs of the network for a given set of inputs
+// ================================================================================================
+const std::vector<float>& NetworkInt8::getOutputs(const std::vector<float>& inputs) {
+
+    setActivations(inputs.data(), inputs.size());
+
+    return infer();
+
+}
+
+// ================================================================================================
+// Get the outputs of the network for a set of double precision inputs owned by the caller
+// ================================================================================================
+const std::vector<float>& NetworkInt8::getOutputs(const double* const inputs, const std::size_t inputCount) {
+
+    setActivations(inputs, inputCount);
+
+    return infer();
+
+}
+
+// ================================================================================================
+// Save the network to disk in the compact quantised format
+// ================================================================================================
+void NetworkInt8::save(std::ofstream& file) {
+
+    const std::size_t layers = _layers.size();
+
+    file.write(NETWORK_INT8_MAGIC, sizeof(NETWORK_INT8_MAGIC) - 1);
+    file.write(reinterpret_cast<const char*>(&layers), sizeof(layers));
+
+    for (auto& layer : _layers) {
+
+        const std::size_t neurons = layer.biases.size();
+
+        file.write(reinterpret_cast<const char*>(&neurons), sizeof(neurons));
+        file.write(reinterpret_cast<const char*>(&layer.scale), sizeof(layer.scale));
+
+    }
+
+    for (std::size_t layer = 1; layer < layers; layer++) {
+
+        file.write(reinterpret_cast<const char*>(_layers[layer].biases.data()), _layers[layer].biases.size() * sizeof(float));
+        file.write(reinterpret_cast<const char*>(_layers[layer].scales.data()), _layers[layer].scales.size() * sizeof(float));
+        file.write(reinterpret_cast<const char*>(_layers[layer].weights.data()), _layers[layer].weights.size() * sizeof(std::int8_t));
+
+    }
+
+}
+
+// ================================================================================================
+// Set the activation values of the input layer
+// ================================================================================================
+void NetworkInt8::setActivations(const float* const inputs, const std::size_t inputCount) {
+
+    if (inputCount != _layers.front().activations.size()) {
+
+        throw std::invalid_argument("Invalid number of activations!");
+
+    }
+
+    std::copy(inputs, inputs + inputCount, _layers.front().activations.begin());
+
+}
+
+// ================================================================================================
+// Set the activation values of the input layer from double precision inputs
+// ================================================================================================
+void NetworkInt8::setActivations(const double* const inputs, const std::size_t inputCount) {
+
+    if (inputCount != _layers.front().activations.size()) {
+
+        throw std::invalid_argument("Invalid number of activations!");
+
+    }
+
+    std::copy(inputs, inputs + inputCount, _layers.front().activations.begin());
+
+}
+
+// ================================================================================================
+// Activate all layers with quantised inputs and get the activations of the output layer
+// ================================================================================================
+const std::vector<float>& NetworkInt8::infer() {
+
+    for (std::size_t layer = 1; layer < _layers.size(); layer++) {
+
+        PROFILE_SCOPE(PHASE_FORWARD, layer);
+
+        quantize(_layers[layer - 1]);
+
+        kernels::infer(
+            _layers[layer].weights.data(),
+            _layers[layer].scales.data(),
+            _layers[layer].biases.data(),
+            _layers[layer - 1].quantized.data(),
+            _layers[layer].activations.data(),
+            _layers[layer].biases.size(),
+            _layers[layer - 1].biases.size()
+        );
+
+    }
+
+    return _layers.back().activations;
+
+}
+
+// ================================================================================================
+// Quantise the activations of a layer with its calibrated scale
+// ================================================================================================
+void NetworkInt8::quantize(DenseLayer& layer) {
+
+    const float inverseScale = 1.0f / layer.scale;
+
+    for (std::size_t neuron = 0; neuron < layer.activations.size(); neuron++) {
+
+        layer.quantized[neuron] = getQuantized(layer.activations[neuron], inverseScale);
+
+    }
+
+}
\ No newline at end of file
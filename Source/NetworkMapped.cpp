@@ -0,0 +1,320 @@
+#include "NetworkMapped.h"
+#include "NetworkFormat.h"
+#include "Kernels.h"
+#include "Profiler.h"
+#include <stdexcept>
+#include <algorithm>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// ================================================================================================
+// Map a network file into memory and use its weight blocks in place
+// ================================================================================================
+NetworkMapped::NetworkMapped(
+    const std::string& path
+):
+    _mapping(nullptr),
+    _length(0)
+{
+
+    const int file = open(path.c_str(), O_RDONLY);
+
+    if (file < 0) {
+
+        throw std::invalid_argument("Network file could not be opened!");
+
+    }
+
+    struct stat status;
+
+    if (fstat(file, &status) != 0 || static_cast<std::size_t>(status.st_size) < sizeof(format::Header)) {
+
+        close(file);
+        throw std::invalid_argument("Invalid network file!");
+
+    }
+
+    _length = status.st_size;
+    _mapping = mmap(nullptr, _length, PROT_READ, MAP_PRIVATE, file, 0);
+
+    close(file);
+
+    if (_mapping == MAP_FAILED) {
+
+        _mapping = nullptr;
+        throw std::invalid_argument("Network file could not be mapped!");
+
+    }
+
+    const char* const bytes = static_cast<const char*>(_mapping);
+
+    format::Header header;
+
+    std::memcpy(&header, bytes, sizeof(header));
+
+    const char* error = nullptr;
+    std::vector<format::LayerEntry> entries;
+    std::vector<format::SparseEntry> pruned;
+    std::vector<format::ActivationEntry> activations;
+    std::vector<format::StateEntry> states;
+    format::OptimizerEntry optimizerEntry = format::getEntry(optimizer::getSettings(optimizer::SGD), 0);
+
+    if (!format::isHeader(header)) {
+
+        error = "Invalid network file!";
+
+    } else if (header.byteOrder != NETWORK_FORMAT_BYTE_ORDER) {
+
+        error = "Unsupported network file byte order!";
+
+    } else if (header.version != NETWORK_FORMAT_VERSION || (header.flags & ~(NETWORK_FORMAT_EDGES | NETWORK_FORMAT_PRUNED | NETWORK_FORMAT_ACTIVATIONS | NETWORK_FORMAT_OPTIMIZER)) != 0) {
+
+        error = "Unsupported network file version!";
+
+    } else if (header.flags & NETWORK_FORMAT_EDGES) {
+
+        munmap(_mapping, _length);
+        throw std::logic_error("Mapped networks require densely connected layers!");
+
+    } else if (header.layers > (_length - sizeof(header)) / sizeof(format::LayerEntry)) {
+
+        error = "Invalid network file!";
+
+    } else {
+
+        entries.resize(header.layers);
+        pruned.resize(header.flags & NETWORK_FORMAT_PRUNED ? header.layers : 0);
+        activations.resize(header.flags & NETWORK_FORMAT_ACTIVATIONS ? header.layers : 0);
+        states.resize(header.flags & NETWORK_FORMAT_OPTIMIZER ? header.layers : 0);
+
+        // Inference ignores the optimizer state, but its table still has to describe the file layout
+        const std::size_t tables = entries.size() * sizeof(format::LayerEntry) + pruned.size() * sizeof(format::SparseEntry) + activations.size() * sizeof(format::ActivationEntry);
+        const std::size_t optimizerTables = states.empty() ? 0 : sizeof(format::OptimizerEntry) + states.size() * sizeof(format::StateEntry);
+
+        if (tables > _length - sizeof(header) || optimizerTables > _length - sizeof(header) - tables) {
+
+            error = "Invalid network file!";
+
+        } else {
+
+            const char* const table = bytes + sizeof(header);
+
+            std::memcpy(entries.data(), table, entries.size() * sizeof(format::LayerEntry));
+            std::memcpy(pruned.data(), table + entries.size() * sizeof(format::LayerEntry), pruned.size() * sizeof(format::SparseEntry));
+            std::memcpy(activations.data(), table + entries.size() * sizeof(format::LayerEntry) + pruned.size() * sizeof(format::SparseEntry), activations.size() * sizeof(format::ActivationEntry));
+
+            if (!states.empty()) {
+
+                std::memcpy(&optimizerEntry, table + tables, sizeof(optimizerEntry));
+                std::memcpy(states.data(), table + tables + sizeof(optimizerEntry), states.size() * sizeof(format::StateEntry));
+
+            }
+
+            const bool optimized = format::isValid(optimizerEntry) && optimizer::isValid(format::getSettings(optimizerEntry));
+            const std::size_t values = optimized ? optimizer::getStateCount(format::getSettings(optimizerEntry).method) : 0;
+
+            if (!optimized || !format::isValid(entries, {}, pruned, activations, states, values, _length)) { error = "Invalid network file!"; }
+
+        }
+
+        // The sparse kernels index the inputs with the stored columns, so those are checked once up front
+        for (std::size_t layer = 1; layer < pruned.size() && !error; layer++) {
+
+            if (pruned[layer].offset == 0) { continue; }
+
+            const std::uint64_t* const rows = reinterpret_cast<const std::uint64_t*>(bytes + pruned[layer].offset);
+            const std::uint32_t* const columns = reinterpret_cast<const std::uint32_t*>(rows + entries[layer].neurons + 1 + pruned[layer].nonzeros);
+
+            if (!format::isValid(rows, columns, entries[layer].neurons, entries[layer - 1].neurons, pruned[layer].nonzeros)) { error = "Invalid network file!"; }
+
+        }
+
+    }
+
+    if (error) {
+
+        munmap(_mapping, _length);
+        throw std::invalid_argument(error);
+
+    }
+
+    _layers.resize(entries.size());
+
+    for (std::size_t layer = 0; layer < entries.size(); layer++) {
+
+        // Blocks are aligned within the file and the mapping starts on a page boundary
+        _layers[layer].weights = layer == 0 ? nullptr : reinterpret_cast<const double*>(bytes + entries[layer].weights);
+        _layers[layer].rows = nullptr;
+        _layers[layer].columns = nullptr;
+
+        // The weights of a pruned layer follow its row offsets and are followed by their columns
+        if (!pruned.empty() && pruned[layer].offset != 0) {
+
+            _layers[layer].rows = reinterpret_cast<const std::uint64_t*>(bytes + pruned[layer].offset);
+            _layers[layer].weights = reinterpret_cast<const double*>(_layers[layer].rows + entries[layer].neurons + 1);
+            _layers[layer].columns = reinterpret_cast<const std::uint32_t*>(_layers[layer].weights + pruned[layer].nonzeros);
+
+        }
+
+        _layers[layer].biases = layer == 0 ? nullptr : reinterpret_cast<const double*>(bytes + entries[layer].biases);
+        _layers[layer].activation = activations.empty() ? activation::SIGMOID : static_cast<activation::Function>(activations[layer].function);
+        _layers[layer].activations.resize(entries[layer].neurons, 0.0);
+
+    }
+
+}
+
+// ================================================================================================
+// Destructor
+// ================================================================================================
+NetworkMapped::~NetworkMapped() {
+
+    if (_mapping) {
+
+        munmap(_mapping, _length);
+
+    }
+
+}
+
+// ================================================================================================
+// Check if a file starts with the header of a network of dense or pruned layers without consuming it
+// ================================================================================================
+bool NetworkMapped::isMappable(std::ifstream& file) {
+
+    format::Header header = {};
+
+    const std::streampos position = file.tellg();
+
+    file.read(reinterpret_cast<char*>(&header), sizeof(header));
+    file.clear();
+    file.seekg(position);
+
+    return format::isHeader(header) && (header.flags & NETWORK_FORMAT_EDGES) == 0;
+
+}
+
+// ================================================================================================
+// Get the layer count of the network
+// ================================================================================================
+std::size_t NetworkMapped::getLayerCount() {
+
+    return _layers.size();
+
+}
+
+// ================================================================================================
+// Get the number of neurons in a layer
+// ================================================================================================
+std::size_t NetworkMapped::getNeuronCount(const std::size_t layer) {
+
+    return _layers[layer].activations.size();
+
+}
+
+// ================================================================================================
+// Get the activation function of a layer
+// ================================================================================================
+activation::Function NetworkMapped::getActivation(const std::size_t layer) {
+
+    return _layers[layer].activation;
+
+}
+
+// ================================================================================================
+// Get the mapped weights of a layer, row-major for dense layers and in row order for pruned ones
+// ================================================================================================
+const double* NetworkMapped::getWeights(const std::size_t layer) {
+
+    return _layers[layer].weights;
+
+}
+
+// ================================================================================================
+// Get the mapped biases of a layer
+// ================================================================================================
+const double* NetworkMapped::getBiases(const std::size_t layer) {
+
+    return _layers[layer].biases;
+
+}
+
+// ================================================================================================
+// Get the mapped row offsets of a pruned layer, nullptr for dense layers
+// ================================================================================================
+const std::uint64_t* NetworkMapped::getRows(const std::size_t layer) {
+
+    return _layers[layer].rows;
+
+}
+
+// ================================================================================================
+// Get the mapped column of every weight of a pruned layer, nullptr for dense layers
+// ================================================================================================
+const std::uint32_t* NetworkMapped::getColumns(const std::size_t layer) {
+
+    return _layers[layer].columns;
+
+}
+
+// ================================================================================================
+// Get the outputs of the network for a given set of inputs
+// ================================================================================================
+const std::vector<double>& NetworkMapped::getOutputs(const std::vector<double>& inputs) {
+
+    return getOutputs(inputs.data(), inputs.size());
+
+}
+
+// ================================================================================================
+// Get the outputs of the network for a set of inputs in memory owned by the caller
+// ================================================================================================
+const std::vector<double>& NetworkMapped::getOutputs(const double* const inputs, const std::size_t inputCount) {
+
+    if (inputCount != _layers.front().activations.size()) {
+
+        throw std::invalid_argument("Invalid number of activations!");
+
+    }
+
+    std::copy(inputs, inputs + inputCount, _layers.front().activations.begin());
+
+    for (std::size_t layer = 1; layer < _layers.size(); layer++) {
+
+        PROFILE_SCOPE(PHASE_FORWARD, layer);
+
+        if (_layers[layer].rows) {
+
+            kernels::inferSparse(
+                _layers[layer].rows,
+                _layers[layer].columns,
+                _layers[layer].weights,
+                _layers[layer].biases,
+                _layers[layer - 1].activations.data(),
+                _layers[layer].activations.data(),
+                _layers[layer].activations.size(),
+                _layers[layer].activation
+            );
+
+            continue;
+
+        }
+
+        kernels::infer(
+            _layers[layer].weights,
+            _layers[layer].biases,
+            _layers[layer - 1].activations.data(),
+            _layers[layer].activations.data(),
+            _layers[layer].activations.size(),
+            _layers[layer - 1].activations.size(),
+            _layers[layer].activation
+        );
+
+    }
+
+    return _layers.back().activations;
+
+}
\ No newline at end of file
@@ -1,63 +1,50 @@
-#include <cmath>
 #include "Neuron.h"
 #include "Network.h"
-#include "RNG.h"
-
-static double sigmoid(const double x) { return 1.0 / (1.0 + std::exp(-x)); }
-static double sigmoidDerivative(const double x) { return x * (1.0 - x); }
+#include "Layer.h"
+#include "Activation.h"
+#include "Loss.h"
 
 // ================================================================================================
 // Constructor
 // ================================================================================================
 Neuron::Neuron(
-    Network* const network
+    Network* const network,
+    Layer* const layer
 ):
     _network(network),
-    _id(_network->getNeuronCount()),
-    _bias(rng::range(-1.0, 1.0)),
-    _activation(0.0),
-    _delta(0.0)
+    _layer(layer),
+    _index(_layer->getNeuronCount()),
+    _id(_network->getNeuronCount())
 {}
 
 // ================================================================================================
-// Construct a neuron from disk
+// Connect this neuron to another neuron
 // ================================================================================================
-Neuron::Neuron(
-    Network* const network,
-    std::ifstream& file
-):
-    _network(network),
-    _id(_network->getNeuronCount()),
-    _bias([&file]{ double bias; file.read(reinterpret_cast<char*>(&bias), sizeof(bias)); return bias; }()),
-    _activation(0.0),
-    _delta(0.0)
-{
-
-    std::size_t connections;
-
-    file.read(reinterpret_cast<char*>(&connections), sizeof(connections));
-
-    for (std::size_t index = 0; index < connections; index++) {
+void Neuron::connect(Neuron* const neuron) {
 
-        Connection* const connection = _network->loadConnection(this, file);
+    Connection* const connection = _network->createConnection(this, neuron);
 
-        connection->getSource()->_inputs.push_back(connection);
-        connection->getTarget()->_outputs.push_back(connection);
+    this->_inputs.push_back(connection);
+    neuron->_outputs.push_back(connection);
 
-    }
+    this->_layer->addConnection();
+    neuron->_layer->addConnection();
 
 }
 
 // ================================================================================================
-// Connect this neuron to another neuron
+// Connect this neuron to another neuron with a known weight
 // ================================================================================================
-void Neuron::connect(Neuron* const neuron) {
+void Neuron::connect(Neuron* const neuron, const double weight) {
 
-    Connection* const connection = _network->createConnection(this, neuron);
+    Connection* const connection = _network->createConnection(this, neuron, weight);
 
     this->_inputs.push_back(connection);
     neuron->_outputs.push_back(connection);
 
+    this->_layer->addConnection();
+    neuron->_layer->addConnection();
+
 }
 
 // ================================================================================================
@@ -65,7 +52,7 @@ void Neuron::connect(Neuron* const neuron) {
 // ================================================================================================
 void Neuron::setActivation(const double activation) {
 
-    _activation = activation;
+    _layer->_activations[_index] = activation;
 
 }
 
@@ -74,15 +61,28 @@ void Neuron::setActivation(const double activation) {
 // ================================================================================================
 void Neuron::activate() {
 
-    _activation = _bias;
+    double activation = _layer->_biases[_index];
+
+    if (_layer->_inputs) {
+
+        const std::vector<double>& inputs = _layer->_inputs->_activations;
+        const double* const weights = _layer->_weights.data() + _index * inputs.size();
+
+        for (std::size_t input = 0; input < inputs.size(); input++) {
+
+            activation += inputs[input] * weights[input];
+
+        }
+
+    }
 
     for (auto& connection : _inputs) {
 
-        _activation += connection->getTarget()->_activation * connection->getWeight();
+        activation += connection->getTarget()->getActivation() * connection->getWeight();
 
     }
 
-    _activation = sigmoid(_activation);
+    _layer->_activations[_index] = activation::apply(_layer->_activation, activation);
 
 }
 
@@ -91,7 +91,7 @@ void Neuron::activate() {
 // ================================================================================================
 double Neuron::getActivation() {
 
-    return _activation;
+    return _layer->_activations[_index];
 
 }
 
@@ -100,9 +100,18 @@ double Neuron::getActivation() {
 // ================================================================================================
 void Neuron::setTarget(const double target) {
 
-    _delta = (target - _activation) * sigmoidDerivative(_activation);
+    const double activation = _layer->_activations[_index];
 
-    _bias += _network->getLearningRate() * _delta;
+    _layer->_deltas[_index] = target - activation;
+
+    // Cross-entropy cancels the derivative of the output function, squared error still needs it
+    if (_network->getLossFunction() == loss::SQUARED_ERROR) {
+
+        _layer->_deltas[_index] *= activation::derivative(_layer->_activation, activation);
+
+    }
+
+    _layer->_biases[_index] += _network->getLearningRate() * _layer->_deltas[_index];
 
 }
 
@@ -111,19 +120,42 @@ void Neuron::setTarget(const double target) {
 // ================================================================================================
 void Neuron::train() {
 
-    _delta = 0.0;
+    const double activation = _layer->_activations[_index];
+
+    double delta = 0.0;
+
+    if (_layer->_outputs) {
+
+        Layer* const layer = _layer->_outputs;
+
+        const std::size_t columns = _layer->_activations.size();
+
+        for (std::size_t output = 0; output < layer->_deltas.size(); output++) {
+
+            double& weight = layer->_weights[output * columns + _index];
+
+            delta += layer->_deltas[output] * weight;
+
+            weight += _network->getLearningRate() * activation * layer->_deltas[output];
+
+        }
+
+    }
 
     for (auto& connection : _outputs) {
 
-        _delta += connection->getSource()->_delta * connection->getWeight();
+        const double outputDelta = connection->getSource()->_layer->_deltas[connection->getSource()->_index];
+
+        delta += outputDelta * connection->getWeight();
 
-        connection->setWeight(connection->getWeight() + _network->getLearningRate() * _activation * connection->getSource()->_delta);
+        connection->setWeight(connection->getWeight() + _network->getLearningRate() * activation * outputDelta);
 
     }
 
-    _delta *= sigmoidDerivative(_activation);
+    delta *= activation::derivative(_layer->_activation, activation);
 
-    _bias += _network->getLearningRate() * _delta;
+    _layer->_deltas[_index] = delta;
+    _layer->_biases[_index] += _network->getLearningRate() * delta;
 
 }
 
@@ -136,16 +168,61 @@ std::size_t Neuron::getID() {
 
 }
 
+// ================================================================================================
+// Append the individual input connections of the neuron to the edges of its layer
+// ================================================================================================
+void Neuron::getEdges(format::Edges& edges) {
+
+    for (auto& connection : _inputs) {
+
+        edges.targets.push_back(connection->getTarget()->getID());
+        edges.weights.push_back(connection->getWeight());
+
+    }
+
+}
+
 // ================================================================================================
 // Save the neuron to disk
 // ================================================================================================
 void Neuron::save(std::ofstream& file) {
 
-    const std::size_t connections = _inputs.size();
+    const Layer* const inputs = _layer->_inputs;
 
-    file.write(reinterpret_cast<const char*>(&_bias), sizeof(_bias));
+    // A pruned layer lists only the weights it kept, which loads back as individual connections
+    const bool pruned = !_layer->_rows.empty();
+    const std::size_t kept = pruned ? _layer->_rows[_index + 1] - _layer->_rows[_index] : inputs ? inputs->_neurons.size() : 0;
+    const std::size_t connections = kept + _inputs.size();
+
+    file.write(reinterpret_cast<const char*>(&_layer->_biases[_index]), sizeof(_layer->_biases[_index]));
     file.write(reinterpret_cast<const char*>(&connections), sizeof(connections));
 
+    if (pruned) {
+
+        for (std::size_t entry = _layer->_rows[_index]; entry < _layer->_rows[_index + 1]; entry++) {
+
+            const std::size_t target = inputs->_neurons[_layer->_columns[entry]]->getID();
+
+            file.write(reinterpret_cast<const char*>(&target), sizeof(target));
+            file.write(reinterpret_cast<const char*>(&_layer->_weights[entry]), sizeof(_layer->_weights[entry]));
+
+        }
+
+    } else if (inputs) {
+
+        const double* const weights = _layer->_weights.data() + _index * inputs->_neurons.size();
+
+        for (std::size_t input = 0; input < inputs->_neurons.size(); input++) {
+
+            const std::size_t target = inputs->_neurons[input]->getID();
+
+            file.write(reinterpret_cast<const char*>(&target), sizeof(target));
+            file.write(reinterpret_cast<const char*>(&weights[input]), sizeof(weights[input]));
+
+        }
+
+    }
+
     for (auto& connection : _inputs) {
 
         connection->save(file);
@@ -0,0 +1,147 @@
+#include "Optimizer.h"
+#include <stdexcept>
+#include <cmath>
+#include <algorithm>
+
+static const char* const METHOD_NAMES[] = {"sgd", "momentum", "nesterov", "adam"};
+static const char* const SCHEDULE_NAMES[] = {"constant", "step", "cosine"};
+static const double PI = std::acos(-1.0);
+
+// ================================================================================================
+// Get the name of an optimizer method as used on the command line
+// ================================================================================================
+const char* optimizer::getName(const Method method) {
+
+    return method < METHOD_COUNT ? METHOD_NAMES[method] : "unknown";
+
+}
+
+// ================================================================================================
+// Get the name of a learning rate schedule as used on the command line
+// ================================================================================================
+const char* optimizer::getName(const Schedule schedule) {
+
+    return schedule < SCHEDULE_COUNT ? SCHEDULE_NAMES[schedule] : "unknown";
+
+}
+
+// ================================================================================================
+// Get an optimizer method by its name
+// ================================================================================================
+optimizer::Method optimizer::getMethod(const std::string& name) {
+
+    for (std::size_t method = 0; method < METHOD_COUNT; method++) {
+
+        if (name == METHOD_NAMES[method]) {
+
+            return static_cast<Method>(method);
+
+        }
+
+    }
+
+    throw std::invalid_argument("Unknown optimizer!");
+
+}
+
+// ================================================================================================
+// Get a learning rate schedule by its name
+// ================================================================================================
+optimizer::Schedule optimizer::getSchedule(const std::string& name) {
+
+    for (std::size_t schedule = 0; schedule < SCHEDULE_COUNT; schedule++) {
+
+        if (name == SCHEDULE_NAMES[schedule]) {
+
+            return static_cast<Schedule>(schedule);
+
+        }
+
+    }
+
+    throw std::invalid_argument("Unknown learning rate schedule!");
+
+}
+
+// ================================================================================================
+// Get the default settings of an optimizer method at a constant learning rate
+// ================================================================================================
+optimizer::Settings optimizer::getSettings(const Method method) {
+
+    return {method, CONSTANT, 0, 0, 0.1, 0.9, 0.9, 0.999, 1e-8};
+
+}
+
+// ================================================================================================
+// Check that a set of settings describes a usable optimizer and schedule
+// ================================================================================================
+// Every check is written so that NaN fails it, since settings can come from network files
+bool optimizer::isValid(const Settings& settings) {
+
+    if (settings.method >= METHOD_COUNT || settings.schedule >= SCHEDULE_COUNT) { return false; }
+
+    if (settings.schedule != CONSTANT && settings.period == 0) { return false; }
+
+    if (!(settings.decay > 0.0 && settings.decay <= 1.0) || !(settings.momentum >= 0.0 && settings.momentum < 1.0)) { return false; }
+
+    if (!(settings.beta1 >= 0.0 && settings.beta1 < 1.0) || !(settings.beta2 >= 0.0 && settings.beta2 < 1.0)) { return false; }
+
+    return settings.epsilon > 0.0 && std::isfinite(settings.epsilon);
+
+}
+
+// ================================================================================================
+// Get the number of state values an optimizer method keeps for every parameter
+// ================================================================================================
+std::size_t optimizer::getStateCount(const Method method) {
+
+    switch (method) {
+
+        case MOMENTUM: return 1;
+        case NESTEROV: return 1;
+        case ADAM: return 2;
+        default: return 0;
+
+    }
+
+}
+
+// ================================================================================================
+// Get the parameters of the update that follows a number of steps
+// ================================================================================================
+// A constant schedule without warmup scales the rate by exactly one, which leaves it unchanged
+optimizer::Step optimizer::getStep(const Settings& settings, const double rate, const std::uint64_t steps) {
+
+    double factor = 1.0;
+
+    if (steps < settings.warmup) {
+
+        factor = static_cast<double>(steps + 1) / settings.warmup;
+
+    } else if (settings.schedule == STEP) {
+
+        factor = std::pow(settings.decay, static_cast<double>((steps - settings.warmup) / settings.period));
+
+    } else if (settings.schedule == COSINE) {
+
+        const double progress = std::min(static_cast<double>(steps - settings.warmup) / settings.period, 1.0);
+
+        factor = 0.5 * (1.0 + std::cos(PI * progress));
+
+    }
+
+    // Adam corrects the bias of its moments towards their zero initialisation with the number of the update
+    const double update = static_cast<double>(steps + 1);
+
+    return {
+        settings.method,
+        rate * factor,
+        settings.momentum,
+        settings.beta1,
+        settings.beta2,
+        settings.epsilon,
+        1.0 - std::pow(settings.beta1, update),
+        1.0 - std::pow(settings.beta2, update)
+    };
+
+}
\ No newline at end of file
@@ -0,0 +1,248 @@
+#include "Profiler.h"
+#include <vector>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <stdexcept>
+#include <algorithm>
+
+#define PROFILER_EVENTS 1048576
+
+static const char* const PHASE_NAMES[] = {"forward", "output delta", "backward", "update", "io"};
+
+struct Counter {
+
+    std::uint64_t calls;
+    std::uint64_t total;
+    std::uint64_t maximum;
+
+};
+
+struct Event {
+
+    profiler::Phase phase;
+    std::size_t layer;
+    std::size_t thread;
+    std::uint64_t start;
+    std::uint64_t duration;
+
+};
+
+static std::atomic<bool> enabled(false);
+static std::atomic<std::size_t> threads(0);
+static std::mutex mutex;
+static std::vector<Counter> counters;
+static std::vector<Event> events;
+static std::size_t dropped = 0;
+static const std::chrono::steady_clock::time_point epoch = std::chrono::steady_clock::now();
+
+// ================================================================================================
+// Get a small number that identifies the calling thread in the trace
+// ================================================================================================
+static std::size_t getThread() {
+
+    static thread_local const std::size_t thread = threads.fetch_add(1);
+
+    return thread;
+
+}
+
+// ================================================================================================
+// Get the name of a layer as shown in the report and the trace
+// ================================================================================================
+static std::string getLayerName(const std::size_t layer) {
+
+    return layer == profiler::NO_LAYER ? "-" : std::to_string(layer);
+
+}
+
+// ================================================================================================
+// Start recording scopes, with room for the trace events reserved up front
+// ================================================================================================
+void profiler::enable() {
+
+    std::lock_guard<std::mutex> lock(mutex);
+
+    events.reserve(PROFILER_EVENTS);
+    enabled.store(true);
+
+}
+
+// ================================================================================================
+// Check if scopes are being recorded
+// ================================================================================================
+bool profiler::isEnabled() {
+
+    return enabled.load(std::memory_order_relaxed);
+
+}
+
+// ================================================================================================
+// Check if this build contains any scopes to record
+// ================================================================================================
+bool profiler::isAvailable() {
+
+#ifdef PROFILING
+    return true;
+#else
+    return false;
+#endif
+
+}
+
+// ================================================================================================
+// Get the nanoseconds since the start of the program, which are never zero
+// ================================================================================================
+std::uint64_t profiler::getTime() {
+
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - epoch).count() + 1;
+
+}
+
+// ================================================================================================
+// Add a finished scope to its counter and to the trace
+// ================================================================================================
+// Counters are indexed by layer and phase, scopes without a layer wrap around to the first row
+void profiler::record(const Phase phase, const std::size_t layer, const std::uint64_t start, const std::uint64_t end) {
+
+    const std::size_t index = (layer + 1) * PHASE_COUNT + phase;
+    const std::uint64_t duration = end - start;
+
+    std::lock_guard<std::mutex> lock(mutex);
+
+    if (index >= counters.size()) {
+
+        counters.resize(index + 1, {0, 0, 0});
+
+    }
+
+    Counter& counter = counters[index];
+
+    counter.calls++;
+    counter.total += duration;
+    counter.maximum = std::max(counter.maximum, duration);
+
+    // The trace keeps the first events only, the counters keep counting after it is full
+    if (events.size() < PROFILER_EVENTS) {
+
+        events.push_back({phase, layer, getThread(), start, duration});
+
+    } else {
+
+        dropped++;
+
+    }
+
+}
+
+// ================================================================================================
+// Print the time spent in every phase of every layer as a table
+// ================================================================================================
+void profiler::printReport(std::ostream& stream) {
+
+    std::lock_guard<std::mutex> lock(mutex);
+
+    std::uint64_t total = 0;
+
+    for (const auto& counter : counters) {
+
+        total += counter.total;
+
+    }
+
+    const std::ios::fmtflags flags = stream.flags();
+    const std::streamsize precision = stream.precision();
+
+    stream << std::left << std::setw(14) << "Phase" << std::setw(7) << "Layer" << std::right;
+    stream << std::setw(12) << "Calls" << std::setw(14) << "Total (ms)" << std::setw(12) << "Mean (us)";
+    stream << std::setw(12) << "Max (us)" << std::setw(10) << "Share" << std::endl;
+
+    stream << std::fixed;
+
+    for (std::size_t index = 0; index < counters.size(); index++) {
+
+        const Counter& counter = counters[index];
+
+        if (counter.calls == 0) { continue; }
+
+        const std::size_t layer = index / PHASE_COUNT - 1;
+
+        stream << std::left << std::setw(14) << PHASE_NAMES[index % PHASE_COUNT] << std::setw(7) << getLayerName(layer) << std::right;
+        stream << std::setw(12) << counter.calls;
+        stream << std::setw(14) << std::setprecision(2) << counter.total / 1000000.0;
+        stream << std::setw(12) << std::setprecision(3) << counter.total / 1000.0 / counter.calls;
+        stream << std::setw(12) << std::setprecision(3) << counter.maximum / 1000.0;
+        stream << std::setw(9) << std::setprecision(1) << 100.0 * counter.total / total << "%" << std::endl;
+
+    }
+
+    if (dropped > 0) {
+
+        stream << "The trace is missing the last " << dropped << " scopes" << std::endl;
+
+    }
+
+    stream.flags(flags);
+    stream.precision(precision);
+
+}
+
+// ================================================================================================
+// Save every recorded scope as a complete event in the Chrome trace event format
+// ================================================================================================
+void profiler::saveTrace(const std::string& path) {
+
+    std::lock_guard<std::mutex> lock(mutex);
+
+    std::ofstream file(path);
+
+    if (!file) {
+
+        throw std::invalid_argument("Trace file could not be opened!");
+
+    }
+
+    file << std::fixed << std::setprecision(3) << "{\"traceEvents\": [";
+
+    for (std::size_t index = 0; index < events.size(); index++) {
+
+        const Event& event = events[index];
+
+        file << (index == 0 ? "" : ",") << std::endl;
+        file << "{\"name\": \"" << PHASE_NAMES[event.phase] << " " << getLayerName(event.layer) << "\", ";
+        file << "\"cat\": \"" << PHASE_NAMES[event.phase] << "\", \"ph\": \"X\", ";
+        file << "\"ts\": " << event.start / 1000.0 << ", \"dur\": " << event.duration / 1000.0 << ", ";
+        file << "\"pid\": 0, \"tid\": " << event.thread << "}";
+
+    }
+
+    file << std::endl << "], \"displayTimeUnit\": \"ms\", \"otherData\": {\"dropped\": \"" << dropped << "\"}}" << std::endl;
+
+}
+
+// ================================================================================================
+// Constructor
+// ================================================================================================
+profiler::Scope::Scope(
+    const Phase phase,
+    const std::size_t layer
+):
+    _phase(phase),
+    _layer(layer),
+    _start(isEnabled() ? getTime() : 0)
+{}
+
+// ================================================================================================
+// Destructor
+// ================================================================================================
+profiler::Scope::~Scope() {
+
+    if (_start > 0) {
+
+        record(_phase, _layer, _start, getTime());
+
+    }
+
+}
\ No newline at end of file
@@ -0,0 +1,143 @@
+#include "RNG.h"
+#include <atomic>
+#include <random>
+
+// ================================================================================================
+// Draw a seed from the random device, so runs without a chosen seed differ from each other
+// ================================================================================================
+static std::uint64_t getRandomSeed() {
+
+    std::random_device device;
+
+    return (static_cast<std::uint64_t>(device()) << 32) | device();
+
+}
+
+// Seed of the process, with the number of times it was set so the generators of threads notice a new one
+// and the number of streams handed out to threads since
+static std::atomic<std::uint64_t> processSeed(getRandomSeed());
+static std::atomic<std::uint64_t> generation(0);
+static std::atomic<std::uint64_t> streams(0);
+
+// ================================================================================================
+// Constructor
+// ================================================================================================
+// Distinct streams of a seed start from distinct keys, since the SplitMix64 finalizer is a bijection
+rng::Generator::Generator(
+    const std::uint64_t seed,
+    const std::uint64_t stream
+):
+    _key(mix(mix(seed) + stream * GAMMA)),
+    _counter(0)
+{}
+
+// ================================================================================================
+// Skip a number of values, as if they were drawn
+// ================================================================================================
+void rng::Generator::jump(const std::uint64_t count) {
+
+    _counter += count;
+
+}
+
+// ================================================================================================
+// Get an independent generator for a stream of this one, without drawing from it
+// ================================================================================================
+rng::Generator rng::Generator::split(const std::uint64_t stream) const {
+
+    return Generator(_key, stream);
+
+}
+
+// ================================================================================================
+// Fill values with uniform numbers in [minimum, maximum), the same ones that drawing them one by one gives
+// ================================================================================================
+// Every value only depends on its own counter, so the loop has no dependency between iterations and is
+// vectorised by the compiler
+void rng::Generator::fill(double* const values, const std::size_t count, const double minimum, const double maximum) {
+
+    const std::uint64_t key = _key;
+    const std::uint64_t counter = _counter;
+    const double scale = (maximum - minimum) * 0x1.0p-53;
+
+    for (std::size_t index = 0; index < count; index++) {
+
+        values[index] = minimum + static_cast<double>(mix(key + (counter + index + 1) * GAMMA) >> 11) * scale;
+
+    }
+
+    _counter += count;
+
+}
+
+// ================================================================================================
+// Get a uniform number in [0, bound) without the bias of taking a remainder
+// ================================================================================================
+// The high half of the product of a value and the bound is the number, values whose low half falls below
+// the remainder of 2^64 by the bound would make some numbers more likely and are drawn again
+std::uint64_t rng::Generator::getBounded(const std::uint64_t bound) {
+
+    unsigned __int128 product = static_cast<unsigned __int128>(next()) * bound;
+    std::uint64_t low = static_cast<std::uint64_t>(product);
+
+    if (low < bound) {
+
+        const std::uint64_t threshold = (0 - bound) % bound;
+
+        while (low < threshold) {
+
+            product = static_cast<unsigned __int128>(next()) * bound;
+            low = static_cast<std::uint64_t>(product);
+
+        }
+
+    }
+
+    return static_cast<std::uint64_t>(product >> 64);
+
+}
+
+// ================================================================================================
+// Seed the generators of every thread, the calling thread gets the first stream of the seed
+// ================================================================================================
+void rng::setSeed(const std::uint64_t value) {
+
+    processSeed.store(value);
+    streams.store(0);
+    generation.fetch_add(1);
+
+    getGenerator();
+
+}
+
+// ================================================================================================
+// Get the seed of the process, which is random until one is set
+// ================================================================================================
+std::uint64_t rng::getSeed() {
+
+    return processSeed.load();
+
+}
+
+// ================================================================================================
+// Get the generator of the calling thread, reseeded with the next stream of the seed whenever it changed
+// ================================================================================================
+// Threads get their streams in the order they first draw after a seed is set, so only the values of the
+// thread that set it are reproducible. Work split across threads uses generators split off explicitly.
+rng::Generator& rng::getGenerator() {
+
+    thread_local Generator generator(0, 0);
+    thread_local std::uint64_t seeded = UINT64_MAX;
+
+    const std::uint64_t current = generation.load();
+
+    if (seeded != current) {
+
+        generator = Generator(processSeed.load(), streams.fetch_add(1));
+        seeded = current;
+
+    }
+
+    return generator;
+
+}
\ No newline at end of file
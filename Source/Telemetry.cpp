@@ -0,0 +1,200 @@
+#include "Telemetry.h"
+#include "Network.h"
+#include "Trainer.h"
+#include <stdexcept>
+#include <iomanip>
+#include <limits>
+#include <cmath>
+
+// Number of samples the moving average of the loss spans
+#define TELEMETRY_AVERAGE_SAMPLES 1000
+
+// ================================================================================================
+// Check if a path ends in a given extension
+// ================================================================================================
+static bool hasExtension(const std::string& path, const std::string& extension) {
+
+    return path.size() >= extension.size() && path.compare(path.size() - extension.size(), extension.size(), extension) == 0;
+
+}
+
+// ================================================================================================
+// Write a number to a record, JSON has no representation for infinities and NaN
+// ================================================================================================
+static void writeValue(std::ostream& stream, const double value, const bool csv) {
+
+    if (std::isfinite(value)) { stream << value; }
+    else if (!csv) { stream << "null"; }
+
+}
+
+// ================================================================================================
+// Constructor
+// ================================================================================================
+Telemetry::Telemetry(
+    Network* const network,
+    Trainer* const trainer,
+    const std::string& path,
+    const double interval
+):
+    _network(network),
+    _trainer(trainer),
+    _file(path),
+    _csv(hasExtension(path, ".csv")),
+    _interval(interval),
+    _start(std::chrono::steady_clock::now()),
+    _recorded(_start),
+    _steps(0),
+    _samples(network->getTrainingSamples()),
+    _loss(network->getTrainingLoss()),
+    _recordedSamples(_samples),
+    _recordedLoss(_loss),
+    _average(std::numeric_limits<double>::quiet_NaN())
+{
+
+    if (!_file) {
+
+        throw std::invalid_argument("Telemetry file could not be opened!");
+
+    }
+
+    _file << std::setprecision(10);
+
+    if (!_csv) { return; }
+
+    _file << "step,samples,time,samples_per_second,loss,loss_average";
+
+    for (std::size_t layer = 1; layer < _network->getLayerCount(); layer++) {
+
+        _file << ",weight_norm_" << layer;
+
+    }
+
+    for (std::size_t layer = 1; layer < _network->getLayerCount(); layer++) {
+
+        _file << ",gradient_norm_" << layer;
+
+    }
+
+    _file << std::endl;
+
+}
+
+// ================================================================================================
+// Account for a finished training step and write a record once the interval has passed
+// ================================================================================================
+// The loss of every step was already measured by its own forward pass, so this only has to read
+// the totals of the network and fold the new samples into the moving average
+void Telemetry::update() {
+
+    _steps++;
+
+    const std::size_t samples = _network->getTrainingSamples();
+    const double loss = _network->getTrainingLoss();
+
+    if (samples > _samples) {
+
+        const double mean = (loss - _loss) / (samples - _samples);
+        const double weight = 1.0 - std::pow(1.0 - 1.0 / TELEMETRY_AVERAGE_SAMPLES, samples - _samples);
+
+        _average = std::isnan(_average) ? mean : _average + weight * (mean - _average);
+        _samples = samples;
+        _loss = loss;
+
+    }
+
+    const std::chrono::duration<double> interval = std::chrono::steady_clock::now() - _recorded;
+
+    if (interval.count() >= _interval) {
+
+        write();
+
+    }
+
+}
+
+// ================================================================================================
+// Write a record of the training since the previous record
+// ================================================================================================
+void Telemetry::write() {
+
+    const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    const std::chrono::duration<double> time = now - _start;
+    const std::chrono::duration<double> interval = now - _recorded;
+
+    const std::size_t samples = _samples - _recordedSamples;
+    const double samplesPerSecond = samples / interval.count();
+    const double loss = samples > 0 ? (_loss - _recordedLoss) / samples : std::numeric_limits<double>::quiet_NaN();
+    const std::size_t layers = _network->getLayerCount();
+
+    if (_csv) {
+
+        _file << _steps << "," << _samples << "," << time.count() << ",";
+        writeValue(_file, samplesPerSecond, true);
+        _file << ",";
+        writeValue(_file, loss, true);
+        _file << ",";
+        writeValue(_file, _average, true);
+
+        for (std::size_t layer = 1; layer < layers; layer++) {
+
+            _file << ",";
+            writeValue(_file, _network->getWeightNorm(layer), true);
+
+        }
+
+        for (std::size_t layer = 1; layer < layers; layer++) {
+
+            _file << ",";
+            writeValue(_file, getGradientNorm(layer), true);
+
+        }
+
+    } else {
+
+        _file << "{\"step\": " << _steps << ", \"samples\": " << _samples << ", \"time\": " << time.count();
+        _file << ", \"samples_per_second\": ";
+        writeValue(_file, samplesPerSecond, false);
+        _file << ", \"loss\": ";
+        writeValue(_file, loss, false);
+        _file << ", \"loss_average\": ";
+        writeValue(_file, _average, false);
+        _file << ", \"weight_norms\": [";
+
+        for (std::size_t layer = 1; layer < layers; layer++) {
+
+            _file << (layer == 1 ? "" : ", ");
+            writeValue(_file, _network->getWeightNorm(layer), false);
+
+        }
+
+        _file << "], \"gradient_norms\": [";
+
+        for (std::size_t layer = 1; layer < layers; layer++) {
+
+            _file << (layer == 1 ? "" : ", ");
+            writeValue(_file, getGradientNorm(layer), false);
+
+        }
+
+        _file << "]}";
+
+    }
+
+    // Every record is flushed so the file can be followed while training is still running
+    _file << std::endl;
+
+    _recorded = now;
+    _recordedSamples = _samples;
+    _recordedLoss = _loss;
+
+}
+
+// ================================================================================================
+// Get the gradient norm of a layer from whichever trained the network
+// ================================================================================================
+double Telemetry::getGradientNorm(const std::size_t layer) {
+
+    return _trainer ? _trainer->getGradientNorm(layer) : _network->getGradientNorm(layer);
+
+}
\ No newline at end of file
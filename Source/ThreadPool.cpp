@@ -0,0 +1,114 @@
+#include "ThreadPool.h"
+
+// ================================================================================================
+// Constructor
+// ================================================================================================
+ThreadPool::ThreadPool(
+    const std::size_t threads
+):
+    _task(nullptr),
+    _generation(0),
+    _pending(0),
+    _stop(false)
+{
+
+    // The calling thread works as thread 0, so only the remaining threads are spawned
+    for (std::size_t thread = 1; thread < threads; thread++) {
+
+        _threads.emplace_back(&ThreadPool::work, this, thread);
+
+    }
+
+}
+
+// ================================================================================================
+// Destructor
+// ================================================================================================
+ThreadPool::~ThreadPool() {
+
+    {
+
+        std::lock_guard<std::mutex> lock(_mutex);
+        _stop = true;
+
+    }
+
+    _start.notify_all();
+
+    for (auto& thread : _threads) {
+
+        thread.join();
+
+    }
+
+}
+
+// ================================================================================================
+// Run a task once on every thread of the pool and wait for all of them to finish
+// ================================================================================================
+void ThreadPool::run(const std::function<void(const std::size_t thread)>& task) {
+
+    {
+
+        std::lock_guard<std::mutex> lock(_mutex);
+        _task = &task;
+        _pending = _threads.size();
+        _generation++;
+
+    }
+
+    _start.notify_all();
+
+    task(0);
+
+    std::unique_lock<std::mutex> lock(_mutex);
+    _finish.wait(lock, [this]{ return _pending == 0; });
+
+}
+
+// ================================================================================================
+// Get the number of threads in the pool including the calling thread
+// ================================================================================================
+std::size_t ThreadPool::getThreadCount() {
+
+    return _threads.size() + 1;
+
+}
+
+// ================================================================================================
+// Wait for tasks and run them until the pool is stopped
+// ================================================================================================
+void ThreadPool::work(const std::size_t thread) {
+
+    std::size_t generation = 0;
+
+    while (true) {
+
+        const std::function<void(const std::size_t thread)>* task;
+
+        {
+
+            std::unique_lock<std::mutex> lock(_mutex);
+            _start.wait(lock, [this, generation]{ return _stop || _generation != generation; });
+
+            if (_stop) { return; }
+
+            generation = _generation;
+            task = _task;
+
+        }
+
+        (*task)(thread);
+
+        {
+
+            std::lock_guard<std::mutex> lock(_mutex);
+            _pending--;
+
+        }
+
+        _finish.notify_one();
+
+    }
+
+}
\ No newline at end of file
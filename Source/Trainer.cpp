@@ -0,0 +1,511 @@
+#include "Trainer.h"
+#include "Network.h"
+#include "Kernels.h"
+#include "Profiler.h"
+#include <stdexcept>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+
+// ================================================================================================
+// Constructor
+// ================================================================================================
+Trainer::Trainer(
+    Network* const network,
+    const std::size_t threads
+):
+    _network(network),
+    _pool(threads),
+    _workers(_pool.getThreadCount()),
+    _samples(0)
+{
+
+    for (std::size_t layer = 1; layer < _network->getLayerCount(); layer++) {
+
+        if (!_network->getLayer(layer)->isDense()) {
+
+            throw std::logic_error("Parallel training requires densely connected layers!");
+
+        }
+
+    }
+
+    for (auto& worker : _workers) {
+
+        worker.activations.resize(_network->getLayerCount());
+        worker.deltas.resize(_network->getLayerCount());
+        worker.weightGradients.resize(_network->getLayerCount());
+        worker.biasGradients.resize(_network->getLayerCount());
+        worker.loss = 0.0;
+
+        for (std::size_t layer = 1; layer < _network->getLayerCount(); layer++) {
+
+            const std::size_t rows = _network->getLayer(layer)->getNeuronCount();
+            const std::size_t columns = _network->getLayer(layer - 1)->getNeuronCount();
+
+            worker.weightGradients[layer].resize(rows * columns);
+            worker.biasGradients[layer].resize(rows);
+
+        }
+
+    }
+
+}
+
+// ================================================================================================
+// Train the network on a single batch split evenly across all threads
+// ================================================================================================
+void Trainer::train(const Dataset& inputs, const Dataset& targets, const std::size_t offset, const std::size_t batchSize) {
+
+    const std::size_t samples = getSampleCount(inputs, targets, offset, batchSize);
+    const std::size_t threads = _workers.size();
+
+    // Every thread works on its own slice of the batch against the same unchanged weights
+    _pool.run([&](const std::size_t thread) {
+
+        computeGradients(
+            _workers[thread],
+            inputs,
+            targets,
+            offset + samples * thread / threads,
+            offset + samples * (thread + 1) / threads
+        );
+
+    });
+
+    // Sum the gradients pairwise in a fixed order so results only depend on the thread count
+    for (std::size_t stride = 1; stride < threads; stride *= 2) {
+
+        _pool.run([&](const std::size_t thread) {
+
+            if (thread % (2 * stride) == 0 && thread + stride < threads) {
+
+                reduceGradients(_workers[thread], _workers[thread + stride]);
+
+            }
+
+        });
+
+    }
+
+    const optimizer::Step& step = _network->getStep();
+
+    _pool.run([&](const std::size_t thread) {
+
+        applyGradients(_workers.front(), thread, samples, step);
+
+    });
+
+    _network->addSteps(1);
+
+    double loss = 0.0;
+
+    for (const auto& worker : _workers) {
+
+        loss += worker.loss;
+
+    }
+
+    _network->addTrainingLoss(loss, samples);
+    _samples = samples;
+
+}
+
+// ================================================================================================
+// Train the network on a range of samples with lock-free asynchronous updates (Hogwild)
+// ================================================================================================
+void Trainer::trainAsync(const Dataset& inputs, const Dataset& targets, const std::size_t offset, const std::size_t count) {
+
+    const std::size_t samples = getSampleCount(inputs, targets, offset, count);
+
+    // Threads race on the weights by design, but state updates that race would corrupt the optimizer
+    if (_network->getStep().method != optimizer::SGD) {
+
+        throw std::logic_error("Asynchronous training requires plain SGD!");
+
+    }
+
+    std::atomic<std::size_t> next(offset);
+
+    for (auto& worker : _workers) {
+
+        worker.loss = 0.0;
+
+    }
+
+    // Threads only share the weights and biases, activations and deltas are per thread scratch
+    _pool.run([&](const std::size_t thread) {
+
+        for (std::size_t sample = next++; sample < offset + samples; sample = next++) {
+
+            trainSample(_workers[thread], inputs, targets, sample);
+
+        }
+
+    });
+
+    double loss = 0.0;
+
+    for (const auto& worker : _workers) {
+
+        loss += worker.loss;
+
+    }
+
+    _network->addTrainingLoss(loss, samples);
+    _network->addSteps(samples);
+    _samples = 0;
+
+}
+
+// ================================================================================================
+// Get the number of threads used for training
+// ================================================================================================
+std::size_t Trainer::getThreadCount() {
+
+    return _workers.size();
+
+}
+
+// ================================================================================================
+// Get the L2 norm of the weight gradient of a layer from the last training step of the trainer
+// ================================================================================================
+// Batches keep their summed gradients until the next batch, asynchronous training only keeps the
+// deltas and activations of the last sample of every thread, of which the first thread is used
+double Trainer::getGradientNorm(const std::size_t layer) {
+
+    const Worker& worker = _workers.front();
+
+    if (_samples > 0) {
+
+        const std::vector<double>& gradients = worker.weightGradients[layer];
+
+        return std::sqrt(kernels::dot(gradients.data(), gradients.data(), gradients.size())) / _samples;
+
+    }
+
+    if (worker.deltas[layer].empty()) { return 0.0; }
+
+    const std::vector<double>& deltas = worker.deltas[layer];
+    const std::vector<double>& inputs = worker.activations[layer - 1];
+
+    return std::sqrt(kernels::dot(deltas.data(), deltas.data(), deltas.size()) * kernels::dot(inputs.data(), inputs.data(), inputs.size()));
+
+}
+
+// ================================================================================================
+// Validate a range of samples and get the number of samples in it
+// ================================================================================================
+std::size_t Trainer::getSampleCount(const Dataset& inputs, const Dataset& targets, const std::size_t offset, const std::size_t count) {
+
+    if (inputs.getSize() != targets.getSize()) {
+
+        throw std::invalid_argument("Number of inputs and targets do not match!");
+
+    }
+
+    if (offset >= inputs.getSize() || count == 0) {
+
+        throw std::invalid_argument("Invalid batch range!");
+
+    }
+
+    if (inputs.getPoints() != _network->getLayer(0)->getNeuronCount()) {
+
+        throw std::invalid_argument("Invalid number of activations!");
+
+    }
+
+    if (targets.getPoints() != _network->getLayer(_network->getLayerCount() - 1)->getNeuronCount()) {
+
+        throw std::invalid_argument("Invalid number of targets!");
+
+    }
+
+    return std::min(count, inputs.getSize() - offset);
+
+}
+
+// ================================================================================================
+// Train the shared network on a single sample using the scratch buffers of a worker
+// ================================================================================================
+void Trainer::trainSample(Worker& worker, const Dataset& inputs, const Dataset& targets, const std::size_t sample) {
+
+    const std::size_t layers = _network->getLayerCount();
+    const double rate = _network->getLearningRate();
+
+    worker.activations[0].resize(inputs.getPoints());
+    worker.targets.resize(targets.getPoints());
+
+    inputs.getSample(sample, worker.activations[0].data());
+    targets.getSample(sample, worker.targets.data());
+
+    for (std::size_t layer = 1; layer < layers; layer++) {
+
+        PROFILE_SCOPE(PHASE_FORWARD, layer);
+
+        Layer* const current = _network->getLayer(layer);
+
+        worker.activations[layer].resize(current->getNeuronCount());
+        worker.deltas[layer].resize(current->getNeuronCount());
+
+        kernels::forward(
+            current->getWeights(),
+            current->getBiases(),
+            worker.activations[layer - 1].data(),
+            worker.activations[layer].data(),
+            current->getNeuronCount(),
+            worker.activations[layer - 1].size(),
+            current->getActivation()
+        );
+
+    }
+
+    Layer* const output = _network->getLayer(layers - 1);
+
+    worker.loss += kernels::error(
+        worker.activations[layers - 1].data(),
+        worker.targets.data(),
+        worker.deltas[layers - 1].data(),
+        output->getNeuronCount(),
+        output->getActivation(),
+        _network->getLossFunction()
+    );
+
+    kernels::update(output->getBiases(), worker.deltas[layers - 1].data(), output->getNeuronCount(), rate);
+
+    for (std::size_t layer = layers - 1; layer > 0; layer--) {
+
+        PROFILE_SCOPE(PHASE_BACKWARD, layer - 1);
+
+        Layer* const current = _network->getLayer(layer);
+        Layer* const previous = _network->getLayer(layer - 1);
+
+        const std::size_t rows = current->getNeuronCount();
+        const std::size_t columns = previous->getNeuronCount();
+
+        // The deltas of the input layer are never used, so only the weights are updated
+        double* const inputDeltas = layer > 1 ? worker.deltas[layer - 1].data() : nullptr;
+
+        if (inputDeltas) { std::fill(inputDeltas, inputDeltas + columns, 0.0); }
+
+        kernels::backward(
+            current->getWeights(),
+            worker.activations[layer - 1].data(),
+            worker.deltas[layer].data(),
+            inputDeltas,
+            rows,
+            columns,
+            rate
+        );
+
+        if (inputDeltas) {
+
+            kernels::derivative(worker.activations[layer - 1].data(), inputDeltas, columns, previous->getActivation());
+            kernels::update(previous->getBiases(), inputDeltas, columns, rate);
+
+        }
+
+    }
+
+}
+
+// ================================================================================================
+// Calculate the summed gradients of a range of samples without modifying the network
+// ================================================================================================
+void Trainer::computeGradients(Worker& worker, const Dataset& inputs, const Dataset& targets, const std::size_t first, const std::size_t last) {
+
+    const std::size_t layers = _network->getLayerCount();
+    const std::size_t samples = last - first;
+
+    for (std::size_t layer = 1; layer < layers; layer++) {
+
+        std::fill(worker.weightGradients[layer].begin(), worker.weightGradients[layer].end(), 0.0);
+        std::fill(worker.biasGradients[layer].begin(), worker.biasGradients[layer].end(), 0.0);
+
+    }
+
+    worker.loss = 0.0;
+
+    if (samples == 0) { return; }
+
+    worker.activations[0].resize(samples * inputs.getPoints());
+
+    inputs.getSamples(first, samples, worker.activations[0].data());
+
+    for (std::size_t layer = 1; layer < layers; layer++) {
+
+        PROFILE_SCOPE(PHASE_FORWARD, layer);
+
+        Layer* const current = _network->getLayer(layer);
+
+        const std::size_t rows = current->getNeuronCount();
+        const std::size_t columns = _network->getLayer(layer - 1)->getNeuronCount();
+
+        worker.activations[layer].resize(samples * rows);
+
+        kernels::forwardBatch(
+            current->getWeights(),
+            current->getBiases(),
+            worker.activations[layer - 1].data(),
+            worker.activations[layer].data(),
+            samples,
+            rows,
+            columns,
+            current->getActivation()
+        );
+
+    }
+
+    Layer* const output = _network->getLayer(layers - 1);
+
+    const std::size_t outputCount = output->getNeuronCount();
+
+    worker.targets.resize(samples * outputCount);
+    worker.deltas[layers - 1].resize(samples * outputCount);
+
+    targets.getSamples(first, samples, worker.targets.data());
+
+    // The error kernel works on one sample at a time, since softmax deltas depend on the whole sample
+    for (std::size_t sample = 0; sample < samples; sample++) {
+
+        worker.loss += kernels::error(
+            worker.activations[layers - 1].data() + sample * outputCount,
+            worker.targets.data() + sample * outputCount,
+            worker.deltas[layers - 1].data() + sample * outputCount,
+            outputCount,
+            output->getActivation(),
+            _network->getLossFunction()
+        );
+
+    }
+
+    for (std::size_t layer = layers - 1; layer > 0; layer--) {
+
+        PROFILE_SCOPE(PHASE_BACKWARD, layer - 1);
+
+        Layer* const current = _network->getLayer(layer);
+
+        const std::size_t rows = current->getNeuronCount();
+        const std::size_t columns = _network->getLayer(layer - 1)->getNeuronCount();
+
+        kernels::accumulateBatch(
+            worker.weightGradients[layer].data(),
+            worker.activations[layer - 1].data(),
+            worker.deltas[layer].data(),
+            samples,
+            rows,
+            columns,
+            1.0
+        );
+
+        kernels::updateBatch(worker.biasGradients[layer].data(), worker.deltas[layer].data(), samples, rows, 1.0);
+
+        if (layer > 1) {
+
+            worker.deltas[layer - 1].resize(samples * columns);
+
+            kernels::backwardBatch(
+                current->getWeights(),
+                worker.deltas[layer].data(),
+                worker.deltas[layer - 1].data(),
+                samples,
+                rows,
+                columns
+            );
+
+            kernels::derivative(
+                worker.activations[layer - 1].data(),
+                worker.deltas[layer - 1].data(),
+                samples * columns,
+                _network->getLayer(layer - 1)->getActivation()
+            );
+
+        }
+
+    }
+
+}
+
+// ================================================================================================
+// Add the gradients of another worker to the gradients of a worker
+// ================================================================================================
+void Trainer::reduceGradients(Worker& worker, const Worker& other) {
+
+    for (std::size_t layer = 1; layer < worker.weightGradients.size(); layer++) {
+
+        PROFILE_SCOPE(PHASE_UPDATE, layer - 1);
+
+        kernels::update(worker.weightGradients[layer].data(), other.weightGradients[layer].data(), worker.weightGradients[layer].size(), 1.0);
+        kernels::update(worker.biasGradients[layer].data(), other.biasGradients[layer].data(), worker.biasGradients[layer].size(), 1.0);
+
+    }
+
+}
+
+// ================================================================================================
+// Apply this thread's share of the summed gradients of a number of samples to the network
+// ================================================================================================
+// Threads own disjoint rows, so every one of them also updates the optimizer state of its own rows
+void Trainer::applyGradients(const Worker& worker, const std::size_t thread, const std::size_t samples, const optimizer::Step& step) {
+
+    const std::size_t threads = _workers.size();
+    const double rate = step.rate / samples;
+
+    for (std::size_t layer = 1; layer < worker.weightGradients.size(); layer++) {
+
+        PROFILE_SCOPE(PHASE_UPDATE, layer - 1);
+
+        Layer* const current = _network->getLayer(layer);
+
+        const std::size_t rows = current->getNeuronCount();
+
+        if (rows == 0) { continue; }
+
+        const std::size_t first = rows * thread / threads;
+        const std::size_t last = rows * (thread + 1) / threads;
+        const std::size_t columns = worker.weightGradients[layer].size() / rows;
+
+        if (step.method == optimizer::SGD) {
+
+            kernels::update(
+                current->getWeights() + first * columns,
+                worker.weightGradients[layer].data() + first * columns,
+                (last - first) * columns,
+                rate
+            );
+
+            kernels::update(
+                current->getBiases() + first,
+                worker.biasGradients[layer].data() + first,
+                last - first,
+                rate
+            );
+
+            continue;
+
+        }
+
+        kernels::optimize(
+            current->getWeights() + first * columns,
+            worker.weightGradients[layer].data() + first * columns,
+            current->getWeightState() + first * columns,
+            rows * columns,
+            (last - first) * columns,
+            1.0 / samples,
+            step
+        );
+
+        kernels::optimize(
+            current->getBiases() + first,
+            worker.biasGradients[layer].data() + first,
+            current->getBiasState() + first,
+            rows,
+            last - first,
+            1.0 / samples,
+            step
+        );
+
+    }
+
+}
\ No newline at end of file
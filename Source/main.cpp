@@ -5,8 +5,28 @@
 #include <fstream>
 #include <vector>
 #include "Network.h"
+#include "Trainer.h"
+#include "Evaluator.h"
+#include "Kernels.h"
+#include "NetworkF32.h"
+#include "NetworkInt8.h"
+#include "NetworkMapped.h"
+#include "Dataset.h"
+#include "DatasetStream.h"
+#include "Profiler.h"
+#include "Telemetry.h"
+#include "Checkpoint.h"
+#include "RNG.h"
+#include <memory>
 #include <chrono>
 #include <cmath>
+#include <algorithm>
+#include <stdexcept>
+#include <cstdint>
+#include <limits>
+
+#define QUANTIZATION_SAMPLES 1000
+#define EVALUATION_BATCH 64
 
 struct Arguments {
 
@@ -15,15 +35,97 @@ struct Arguments {
     std::string labels;
     std::size_t train;
     double rate;
+    std::size_t batch;
+    std::size_t threads;
+    bool async;
+    bool single;
+    std::string quantize;
+    std::size_t stream;
+    bool shuffle;
+    double prune;
+    std::size_t pruneSteps;
+    bool pruneGlobal;
+    std::string profile;
+    std::string telemetry;
+    double telemetryInterval;
+    std::vector<activation::Function> activations;
+    loss::Function objective;
+    optimizer::Settings optimizer;
+    bool optimized;
+    std::size_t checkpointSamples;
+    double checkpointInterval;
+    bool resume;
+    std::uint64_t seed;
+    bool seeded;
 
 };
 
+// ================================================================================================
+// Get the activation functions of a comma separated list of names
+// ================================================================================================
+std::vector<activation::Function> getActivations(const std::string& list) {
+
+    std::vector<activation::Function> activations;
+
+    std::size_t start = 0;
+
+    while (start <= list.size()) {
+
+        const std::size_t end = std::min(list.find(',', start), list.size());
+
+        try {
+
+            activations.push_back(activation::getFunction(list.substr(start, end - start)));
+
+        } catch (const std::invalid_argument& exception) {
+
+            std::cerr << exception.what() << std::endl;
+            std::exit(1);
+
+        }
+
+        start = end + 1;
+
+    }
+
+    return activations;
+
+}
+
+// ================================================================================================
+// Look up a loss function, optimizer or schedule by its name and exit on unknown names
+// ================================================================================================
+template <typename Value>
+Value getNamed(const std::string& name, Value (*lookup)(const std::string&)) {
+
+    try {
+
+        return lookup(name);
+
+    } catch (const std::invalid_argument& exception) {
+
+        std::cerr << exception.what() << std::endl;
+        std::exit(1);
+
+    }
+
+}
+
+// ================================================================================================
+// Get the label of the mean loss of a loss function
+// ================================================================================================
+const char* getLossLabel(const loss::Function objective) {
+
+    return objective == loss::CROSS_ENTROPY ? "Mean cross-entropy" : "Mean square error";
+
+}
+
 // ================================================================================================
 // Get launch arguments
 // ================================================================================================
 Arguments getArguments(int argc, char* argv[]) {
 
-    Arguments arguments = {"", "", "", 0, 0.1};
+    Arguments arguments = {"", "", "", 0, 0.1, 1, 1, false, false, "", 0, false, 0.0, 1, false, "", "", 15.0, {}, loss::SQUARED_ERROR, optimizer::getSettings(optimizer::SGD), false, 0, 0.0, false, 0, false};
 
     for (int i = 1; i < argc; i++) {
 
@@ -34,6 +136,31 @@ Arguments getArguments(int argc, char* argv[]) {
         if (argument == "--labels") { arguments.labels = argv[++i]; }
         if (argument == "--train") { arguments.train = std::stoull(argv[++i]); }
         if (argument == "--rate") { arguments.rate = std::stod(argv[++i]); }
+        if (argument == "--batch") { arguments.batch = std::stoull(argv[++i]); }
+        if (argument == "--threads") { arguments.threads = std::stoull(argv[++i]); }
+        if (argument == "--async") { arguments.async = true; }
+        if (argument == "--float") { arguments.single = true; }
+        if (argument == "--quantize") { arguments.quantize = argv[++i]; }
+        if (argument == "--stream") { arguments.stream = std::stoull(argv[++i]); }
+        if (argument == "--shuffle") { arguments.shuffle = true; }
+        if (argument == "--prune") { arguments.prune = std::stod(argv[++i]); }
+        if (argument == "--prune-steps") { arguments.pruneSteps = std::stoull(argv[++i]); }
+        if (argument == "--prune-global") { arguments.pruneGlobal = true; }
+        if (argument == "--profile") { arguments.profile = argv[++i]; }
+        if (argument == "--telemetry") { arguments.telemetry = argv[++i]; }
+        if (argument == "--telemetry-interval") { arguments.telemetryInterval = std::stod(argv[++i]); }
+        if (argument == "--activations") { arguments.activations = getActivations(argv[++i]); }
+        if (argument == "--loss") { arguments.objective = getNamed(argv[++i], loss::getFunction); }
+        if (argument == "--optimizer") { arguments.optimizer.method = getNamed(argv[++i], optimizer::getMethod); arguments.optimized = true; }
+        if (argument == "--momentum") { arguments.optimizer.momentum = std::stod(argv[++i]); arguments.optimized = true; }
+        if (argument == "--schedule") { arguments.optimizer.schedule = getNamed(argv[++i], optimizer::getSchedule); arguments.optimized = true; }
+        if (argument == "--warmup") { arguments.optimizer.warmup = std::stoull(argv[++i]); arguments.optimized = true; }
+        if (argument == "--period") { arguments.optimizer.period = std::stoull(argv[++i]); arguments.optimized = true; }
+        if (argument == "--decay") { arguments.optimizer.decay = std::stod(argv[++i]); arguments.optimized = true; }
+        if (argument == "--checkpoint-samples") { arguments.checkpointSamples = std::stoull(argv[++i]); }
+        if (argument == "--checkpoint-interval") { arguments.checkpointInterval = std::stod(argv[++i]); }
+        if (argument == "--resume") { arguments.resume = true; }
+        if (argument == "--seed") { arguments.seed = std::stoull(argv[++i]); arguments.seeded = true; }
 
     }
 
@@ -44,131 +171,357 @@ Arguments getArguments(int argc, char* argv[]) {
 
     }
 
+    if (arguments.batch == 0) {
+
+        std::cerr << "Invalid batch size!" << std::endl;
+        std::exit(1);
+
+    }
+
+    if (arguments.threads == 0) {
+
+        std::cerr << "Invalid thread count!" << std::endl;
+        std::exit(1);
+
+    }
+
+    if (arguments.train && arguments.threads > 1 && arguments.batch == 1) {
+
+        std::cerr << "Multithreaded training requires a batch size greater than one!" << std::endl;
+        std::exit(1);
+
+    }
+
+    if (arguments.single && arguments.train) {
+
+        std::cerr << "Single precision is only supported for testing!" << std::endl;
+        std::exit(1);
+
+    }
+
+    if (!arguments.quantize.empty() && arguments.train) {
+
+        std::cerr << "Quantisation is only supported for testing!" << std::endl;
+        std::exit(1);
+
+    }
+
+    if (arguments.stream % arguments.batch != 0) {
+
+        std::cerr << "Stream chunk size must be a multiple of the batch size!" << std::endl;
+        std::exit(1);
+
+    }
+
+    if (arguments.shuffle && arguments.stream == 0) {
+
+        std::cerr << "Shuffling requires a stream chunk size!" << std::endl;
+        std::exit(1);
+
+    }
+
+    if (arguments.prune < 0.0 || arguments.prune >= 1.0 || arguments.pruneSteps == 0) {
+
+        std::cerr << "Invalid sparsity!" << std::endl;
+        std::exit(1);
+
+    }
+
+    if (!optimizer::isValid(arguments.optimizer)) {
+
+        std::cerr << "Invalid optimizer settings!" << std::endl;
+        std::exit(1);
+
+    }
+
+    if (optimizer::getStateCount(arguments.optimizer.method) > 0 && (arguments.async || arguments.prune > 0.0)) {
+
+        std::cerr << "Asynchronous training and pruning require plain SGD!" << std::endl;
+        std::exit(1);
+
+    }
+
+    if (arguments.prune > 0.0 && (arguments.batch > 1 || arguments.threads > 1 || arguments.async)) {
+
+        std::cerr << "Pruned networks are only fine-tuned one sample at a time!" << std::endl;
+        std::exit(1);
+
+    }
+
+    if (arguments.prune > 0.0 && (arguments.single || !arguments.quantize.empty())) {
+
+        std::cerr << "Pruned networks can not be converted!" << std::endl;
+        std::exit(1);
+
+    }
+
+    if (!arguments.profile.empty() && !profiler::isAvailable()) {
+
+        std::cerr << "Profiling requires a build with make profile!" << std::endl;
+        std::exit(1);
+
+    }
+
+    if (!arguments.telemetry.empty() && !arguments.train) {
+
+        std::cerr << "Telemetry requires training!" << std::endl;
+        std::exit(1);
+
+    }
+
+    if (!(arguments.telemetryInterval >= 0.0)) {
+
+        std::cerr << "Invalid telemetry interval!" << std::endl;
+        std::exit(1);
+
+    }
+
+    if (!(arguments.checkpointInterval >= 0.0)) {
+
+        std::cerr << "Invalid checkpoint interval!" << std::endl;
+        std::exit(1);
+
+    }
+
+    if (arguments.resume && !arguments.train) {
+
+        std::cerr << "Resuming requires training!" << std::endl;
+        std::exit(1);
+
+    }
+
+    // A resumed run continues with the shuffle order its checkpoint was trained with
+    if (arguments.resume && arguments.seeded) {
+
+        std::cerr << "Seeds can only be chosen for runs that are not resumed!" << std::endl;
+        std::exit(1);
+
+    }
+
+    if (arguments.prune > 0.0 && (arguments.resume || arguments.checkpointSamples > 0 || arguments.checkpointInterval > 0.0)) {
+
+        std::cerr << "Pruning does not support checkpoints!" << std::endl;
+        std::exit(1);
+
+    }
+
+    if (!arguments.activations.empty() && std::find(arguments.activations.begin(), arguments.activations.end() - 1, activation::SOFTMAX) != arguments.activations.end() - 1) {
+
+        std::cerr << "Softmax is only supported in the output layer!" << std::endl;
+        std::exit(1);
+
+    }
+
     return arguments;
 
 }
 
 // ================================================================================================
-// Get data from file
+// Map a data file into memory
 // ================================================================================================
-std::vector<std::vector<double>> getData(std::ifstream& file) {
-
-    std::vector<std::vector<double>> data;
+std::unique_ptr<Dataset> getData(const std::string& path) {
 
-    std::size_t entries;
-    std::size_t points;
+    try {
 
-    file.read(reinterpret_cast<char*>(&entries), sizeof(entries));
-    file.read(reinterpret_cast<char*>(&points), sizeof(points));
+        return std::make_unique<Dataset>(path);
 
-    for (std::size_t entry = 0; entry < entries; entry++) {
+    } catch (const std::invalid_argument& exception) {
 
-        std::vector<double> values;
-
-        for (std::size_t point = 0; point < points; point++) {
+        std::cerr << exception.what() << std::endl;
+        std::exit(1);
 
-            double value;
+    }
 
-            file.read(reinterpret_cast<char*>(&value), sizeof(value));
+}
 
-            values.push_back(value);
+// ================================================================================================
+// Get the points of a sample in place, or expanded into a buffer if the dataset is compact
+// ================================================================================================
+const double* readSample(const Dataset& dataset, const std::size_t index, std::vector<double>& buffer) {
 
-        }
+    const double* const data = dataset.getData(index);
 
-        data.push_back(values);
+    if (data) { return data; }
 
-    }
+    dataset.getSample(index, buffer.data());
 
-    return data;
+    return buffer.data();
 
 }
 
 // ================================================================================================
-// Train the network and periodically log training stats
+// Train the network on every chunk of a stream from a sample of an iteration and periodically log training stats
 // ================================================================================================
-void trainNetwork(Network& network, const std::vector<std::vector<double>>& inputs, const std::vector<std::vector<double>>& targets) {
+void trainNetwork(Network& network, DatasetStream& stream, const std::size_t batch, Trainer* const trainer, const bool async, Telemetry* const telemetry, Checkpoint* const checkpoint, const std::size_t iteration, const std::size_t sample) {
 
     /* Messy code! */
 
+    std::size_t trained = sample;
+    std::size_t updateSamples = network.getTrainingSamples();
+    double updateLoss = network.getTrainingLoss();
+
     std::chrono::high_resolution_clock::time_point startTimestamp = std::chrono::high_resolution_clock::now();
     std::chrono::high_resolution_clock::time_point updateTimestamp = startTimestamp;
 
-    for (std::size_t index = 0; index < inputs.size(); index++) {
+    stream.reset(iteration, sample);
 
-        network.train(inputs[index], targets[index]);
+    while (stream.next()) {
 
-        std::chrono::duration<double> intervalSeconds = std::chrono::high_resolution_clock::now() - updateTimestamp;
+        const Dataset& inputs = stream.getInputs();
+        const Dataset& targets = stream.getTargets();
 
-        if (intervalSeconds.count() >= 15) {
+        // Only the chunk a resumed iteration starts in has samples that were already trained on
+        const std::size_t offset = stream.getOffset();
+        const std::size_t first = trained - offset;
+
+        std::vector<double> input(inputs.getPoints());
+        std::vector<double> target(targets.getPoints());
+
+        for (std::size_t index = offset; index < inputs.getSize(); index += batch) {
+
+            if (trainer && async) {
 
-            std::size_t meanSquareSamples = 100;
-            double meanSquareError = 0.0;
+                trainer->trainAsync(inputs, targets, index, batch);
 
-            for (std::size_t sample = 0; sample < meanSquareSamples; sample++) {
+            } else if (trainer) {
 
-                meanSquareError += network.getLoss(inputs[sample], targets[sample]);
+                trainer->train(inputs, targets, index, batch);
+
+            } else if (batch > 1) {
+
+                network.trainBatch(inputs, targets, index, batch);
+
+            } else {
+
+                network.train(readSample(inputs, index, input), input.size(), readSample(targets, index, target), target.size());
 
             }
 
-            meanSquareError /= meanSquareSamples;
-            std::chrono::duration<double> durationSeconds = std::chrono::high_resolution_clock::now() - startTimestamp;
-            double iterationsPerSecond = index / durationSeconds.count();
-            std::size_t remainingSamples = inputs.size() - index;
-            double timeRemainingMinutes = remainingSamples / iterationsPerSecond / 60;
-            double completedPercentage = 100.0 / inputs.size() * index;
-            timeRemainingMinutes = std::round(timeRemainingMinutes * 100.0) / 100.0;
-            completedPercentage = std::round(completedPercentage * 100.0) / 100.0;
+            if (telemetry) { telemetry->update(); }
+            if (checkpoint) { checkpoint->update(iteration, first + std::min(index + batch, inputs.getSize())); }
 
-            std::cout << "Trained on " << index << " out of " << inputs.size() << " (" << completedPercentage << " %) samples" << std::endl;
-            std::cout << "Remaining training time: " << timeRemainingMinutes << " minutes" << std::endl;
-            std::cout << "Mean square error over the first " << meanSquareSamples << " samples: " << meanSquareError << std::endl;
+            std::chrono::duration<double> intervalSeconds = std::chrono::high_resolution_clock::now() - updateTimestamp;
 
-            updateTimestamp = std::chrono::high_resolution_clock::now();
+            if (intervalSeconds.count() >= 15) {
+
+                // The loss of every trained sample was measured by the forward pass of its training step
+                const std::size_t lossSamples = network.getTrainingSamples() - updateSamples;
+                const double meanLoss = (network.getTrainingLoss() - updateLoss) / lossSamples;
+                const std::size_t completed = first + index;
+
+                std::chrono::duration<double> durationSeconds = std::chrono::high_resolution_clock::now() - startTimestamp;
+                double iterationsPerSecond = (completed - sample) / durationSeconds.count();
+                std::size_t remainingSamples = stream.getSize() - completed;
+                double timeRemainingMinutes = remainingSamples / iterationsPerSecond / 60;
+                double completedPercentage = 100.0 / stream.getSize() * completed;
+                timeRemainingMinutes = std::round(timeRemainingMinutes * 100.0) / 100.0;
+                completedPercentage = std::round(completedPercentage * 100.0) / 100.0;
+
+                std::cout << "Trained on " << completed << " out of " << stream.getSize() << " (" << completedPercentage << " %) samples" << std::endl;
+                std::cout << "Remaining training time: " << timeRemainingMinutes << " minutes" << std::endl;
+                std::cout << getLossLabel(network.getLossFunction()) << " over the last " << lossSamples << " trained samples: " << meanLoss << std::endl;
+
+                updateTimestamp = std::chrono::high_resolution_clock::now();
+                updateSamples = network.getTrainingSamples();
+                updateLoss = network.getTrainingLoss();
+
+            }
 
         }
 
+        trained = first + inputs.getSize();
+
     }
 
 }
 
 // ================================================================================================
-// Test the network and periodically log training stats
+// Print the accuracy, mean loss and confusion matrix of an evaluation
 // ================================================================================================
-void testNetwork(Network& network, const std::vector<std::vector<double>>& inputs, const std::vector<std::vector<double>>& targets) {
+void printEvaluation(const Evaluation& evaluation, const loss::Function objective) {
 
-    /* Messy code! */
+    const std::size_t classes = static_cast<std::size_t>(std::sqrt(evaluation.confusion.size()));
 
-    std::size_t correct = 0;
+    double accuracy = 100.0 / evaluation.samples * evaluation.correct;
+    accuracy = std::round(accuracy * 100.0) / 100.0;
 
-    std::chrono::high_resolution_clock::time_point startTimestamp = std::chrono::high_resolution_clock::now();
-    std::chrono::high_resolution_clock::time_point updateTimestamp = startTimestamp;
+    std::cout << "Network accuracy: " << accuracy << " %" << std::endl;
+    std::cout << getLossLabel(objective) << ": " << evaluation.loss / evaluation.samples << std::endl;
+    std::cout << "Confusion matrix (rows are targets, columns are predictions):" << std::endl;
 
-    for (std::size_t input = 0; input < inputs.size(); input++) {
+    for (std::size_t target = 0; target < classes; target++) {
 
-        std::vector<double> outputs = network.getOutputs(inputs[input]);
+        std::cout << target << ":";
 
-        std::size_t target = 0;
-        std::size_t guess = 0;
-        double probability = 0.0;
+        for (std::size_t guess = 0; guess < classes; guess++) {
 
-        for (std::size_t index = 0; index < outputs.size(); index++) {
+            std::cout << " " << evaluation.confusion[target * classes + guess];
 
-            if (targets[input][index] == 1) {
+        }
 
-                target = index;
+        std::cout << std::endl;
 
-            }
+    }
 
-            if (outputs[index] > probability) {
+}
 
-                guess = index;
-                probability = outputs[index];
+// ================================================================================================
+// Print the outputs of the network for the first sample
+// ================================================================================================
+template <typename Model>
+void printOutputs(Model& network, const Dataset& inputs) {
 
-            }
+    std::vector<double> sample(inputs.getPoints());
+    inputs.getSample(0, sample.data());
 
-        }
+    const auto& outputs = network.getOutputs(sample.data(), sample.size());
 
-        if (guess == target) { correct++; }
+    std::cout << "Output of the first sample:" << std::endl;
+
+    for (std::size_t index = 0; index < outputs.size(); index++) {
+
+        double output = std::round(outputs[index] * 10000.0) / 100.0;
+
+        std::cout << index << " = " <<  output << " %" << std::endl;
+
+    }
+
+}
+
+// ================================================================================================
+// Test the network one sample at a time and periodically log test stats
+// ================================================================================================
+// Networks the evaluator can not run are scored the same way it does, so every test reports the same
+template <typename Model>
+void testNetwork(Model& network, const Dataset& inputs, const Dataset& targets, const activation::Function function, const loss::Function objective) {
+
+    /* Messy code! */
+
+    const std::size_t classes = targets.getPoints();
+
+    Evaluation evaluation = {inputs.getSize(), 0, 0.0, std::vector<std::size_t>(classes * classes, 0)};
+    std::vector<double> sample(inputs.getPoints());
+    std::vector<double> expected(classes);
+    std::vector<double> output(classes);
+
+    std::chrono::high_resolution_clock::time_point startTimestamp = std::chrono::high_resolution_clock::now();
+    std::chrono::high_resolution_clock::time_point updateTimestamp = startTimestamp;
+
+    for (std::size_t input = 0; input < inputs.getSize(); input++) {
+
+        const double* const labels = readSample(targets, input, expected);
+        const auto& outputs = network.getOutputs(readSample(inputs, input, sample), sample.size());
+
+        // Reduced precision outputs are widened, so the loss is computed like that of the other networks
+        std::copy(outputs.begin(), outputs.end(), output.begin());
+
+        const std::size_t guess = std::max_element(output.begin(), output.end()) - output.begin();
+        const std::size_t target = std::max_element(labels, labels + classes) - labels;
+
+        evaluation.loss += kernels::loss(output.data(), labels, classes, function, objective);
+        evaluation.confusion[target * classes + guess]++;
+
+        if (guess == target) { evaluation.correct++; }
 
         std::chrono::duration<double> intervalSeconds = std::chrono::high_resolution_clock::now() - updateTimestamp;
 
@@ -176,13 +529,13 @@ void testNetwork(Network& network, const std::vector<std::vector<double>>& input
 
             std::chrono::duration<double> durationSeconds = std::chrono::high_resolution_clock::now() - startTimestamp;
             double iterationsPerSecond = input / durationSeconds.count();
-            std::size_t remainingSamples = inputs.size() - input;
+            std::size_t remainingSamples = inputs.getSize() - input;
             double timeRemainingMinutes = remainingSamples / iterationsPerSecond / 60;
-            double completedPercentage = 100.0 / inputs.size() * input;
+            double completedPercentage = 100.0 / inputs.getSize() * input;
             timeRemainingMinutes = std::round(timeRemainingMinutes * 100.0) / 100.0;
             completedPercentage = std::round(completedPercentage * 100.0) / 100.0;
 
-            std::cout << "Tested " << input << " out of " << inputs.size() << " (" << completedPercentage << " %) samples" << std::endl;
+            std::cout << "Tested " << input << " out of " << inputs.getSize() << " (" << completedPercentage << " %) samples" << std::endl;
             std::cout << "Remaining test time: " << timeRemainingMinutes << " minutes" << std::endl;
 
             updateTimestamp = std::chrono::high_resolution_clock::now();
@@ -191,20 +544,36 @@ void testNetwork(Network& network, const std::vector<std::vector<double>>& input
 
     }
 
-    double accuracy = 100.0 / inputs.size() * correct;
-    accuracy = std::round(accuracy * 100.0) / 100.0;
-    std::vector<double> outputs = network.getOutputs(inputs[0]);
+    printEvaluation(evaluation, objective);
+    printOutputs(network, inputs);
 
-    std::cout << "Network accuracy: " << accuracy << " %" << std::endl;
-    std::cout << "Output of the first sample:" << std::endl;
+}
 
-    for (std::size_t index = 0; index < outputs.size(); index++) {
+// ================================================================================================
+// Evaluate the loss, accuracy and confusion matrix of the network in batches across threads
+// ================================================================================================
+void evaluateNetwork(Network& network, const Dataset& inputs, const Dataset& targets, const std::size_t threads) {
 
-        double output = std::round(outputs[index] * 10000.0) / 100.0;
+    Evaluator evaluator(&network, threads, EVALUATION_BATCH);
 
-        std::cout << index << " = " <<  output << " %" << std::endl;
+    printEvaluation(evaluator.evaluate(inputs, targets), network.getLossFunction());
+    printOutputs(network, inputs);
 
-    }
+}
+
+// ================================================================================================
+// Print the time spent in every phase and layer and save the trace of a profiled run
+// ================================================================================================
+void saveProfile(const std::string& path) {
+
+    if (path.empty()) { return; }
+
+    std::cout << "Profile:" << std::endl;
+
+    profiler::printReport(std::cout);
+    profiler::saveTrace(path);
+
+    std::cout << "Saved trace event file to " << path << std::endl;
 
 }
 
@@ -215,56 +584,309 @@ int main(int argc, char* argv[]) {
 
     Arguments arguments = getArguments(argc, argv);
 
+    if (!arguments.profile.empty()) {
+
+        profiler::enable();
+
+    }
+
     std::cout << "Loading input files..." << std::endl;
 
     std::ifstream networkFile(arguments.network, std::ios::binary);
-    std::ifstream imagesFile(arguments.images, std::ios::binary);
-    std::ifstream labelsFile(arguments.labels, std::ios::binary);
 
-    if (!imagesFile || !labelsFile) {
+    const std::unique_ptr<Dataset> inputs = getData(arguments.images);
+    const std::unique_ptr<Dataset> targets = getData(arguments.labels);
+
+    if (inputs->getSize() != targets->getSize()) {
 
-        std::cerr << "An input file could not be loaded!" << std::endl;
+        std::cerr << "Number of inputs and targets do not match!" << std::endl;
         std::exit(1);
 
     }
 
-    std::vector<std::vector<double>> inputs = getData(imagesFile);
-    std::vector<std::vector<double>> targets = getData(labelsFile);
+    if (networkFile && !arguments.activations.empty()) {
 
-    if (inputs.size() != targets.size()) {
+        std::cerr << "Activations can only be chosen for new networks!" << std::endl;
+        std::exit(1);
 
-        std::cerr << "Number of inputs and targets do not match!" << std::endl;
+    }
+
+    // Saved networks resume with the optimizer, state and schedule position they were saved with
+    if (networkFile && arguments.optimized) {
+
+        std::cerr << "Optimizers can only be chosen for new networks!" << std::endl;
+        std::exit(1);
+
+    }
+
+    // New weights and shuffle orders repeat themselves with the same seed
+    if (arguments.seeded) {
+
+        rng::setSeed(arguments.seed);
+
+    }
+
+    if (arguments.train && !arguments.resume) {
+
+        std::cout << "Random seed: " << rng::getSeed() << std::endl;
+
+    }
+
+    // Without a checkpoint, training starts at the first sample of a new shuffle order
+    format::ProgressEntry progress = {0, 0, rng::range<std::uint64_t>(0, std::numeric_limits<std::uint64_t>::max()), 0, 0.0, {}, 0};
+
+    if (arguments.resume && !(networkFile && Checkpoint::getProgress(networkFile, progress))) {
+
+        std::cerr << "No checkpoint to resume from!" << std::endl;
+        std::exit(1);
+
+    }
+
+    if (networkFile && NetworkInt8::isQuantized(networkFile)) {
+
+        if (arguments.train) {
+
+            std::cerr << "Quantised networks can not be trained!" << std::endl;
+            std::exit(1);
+
+        }
+
+        NetworkInt8 quantizedNetwork(networkFile);
+
+        std::cout << "Starting quantised network test..." << std::endl;
+
+        // Only sigmoid networks can be quantised
+        testNetwork(quantizedNetwork, *inputs, *targets, activation::SIGMOID, arguments.objective);
+
+        saveProfile(arguments.profile);
+
+        return 0;
+
+    }
+
+    // Plain tests of a mappable network are evaluated on the file in place without building the network
+    if (networkFile && !arguments.train && !arguments.single && arguments.quantize.empty() && arguments.prune == 0.0 && NetworkMapped::isMappable(networkFile)) {
+
+        NetworkMapped mappedNetwork(arguments.network);
+
+        if (!loss::isSupported(arguments.objective, mappedNetwork.getActivation(mappedNetwork.getLayerCount() - 1))) {
+
+            std::cerr << "Cross-entropy requires a sigmoid or softmax output layer!" << std::endl;
+            std::exit(1);
+
+        }
+
+        std::cout << "Starting network test..." << std::endl;
+
+        Evaluator evaluator(&mappedNetwork, arguments.objective, arguments.threads, EVALUATION_BATCH);
+
+        printEvaluation(evaluator.evaluate(*inputs, *targets), arguments.objective);
+        printOutputs(mappedNetwork, *inputs);
+
+        saveProfile(arguments.profile);
+
+        return 0;
+
+    }
+
+    const std::vector<std::size_t> topology = {inputs->getPoints(), 128, 64, targets->getPoints()};
+
+    if (arguments.activations.empty()) {
+
+        arguments.activations.assign(topology.size() - 1, activation::SIGMOID);
+
+    }
+
+    if (arguments.activations.size() != topology.size() - 1) {
+
+        std::cerr << "Invalid number of activation functions!" << std::endl;
         std::exit(1);
 
     }
 
     Network network = networkFile ?
                       Network(networkFile, arguments.rate) :
-                      Network({inputs[0].size(), 128, 64, targets[0].size()}, arguments.rate);
+                      Network(topology, arguments.activations, arguments.rate);
+
+    // The loss function is a training setting like the learning rate, so it is not kept in network files
+    try {
+
+        network.setLossFunction(arguments.objective);
+
+        if (arguments.optimized) { network.setOptimizer(arguments.optimizer); }
+
+    } catch (const std::logic_error& exception) {
 
-    if (arguments.train) {
+        std::cerr << exception.what() << std::endl;
+        std::exit(1);
+
+    }
+
+    // The optimizer state of a resumed run is part of the network, its training loss is kept with the progress
+    if (arguments.resume) {
+
+        network.addTrainingLoss(progress.loss, progress.samples);
+
+    }
+
+    if (arguments.prune > 0.0) {
+
+        DatasetStream stream(*inputs, *targets, arguments.stream, arguments.shuffle, progress.seed);
+        std::unique_ptr<Telemetry> telemetry;
 
-        for (std::size_t iteration = 0; iteration < arguments.train; iteration++) {
+        if (!arguments.telemetry.empty()) {
+
+            telemetry = std::make_unique<Telemetry>(&network, nullptr, arguments.telemetry, arguments.telemetryInterval);
+
+        }
 
-            std::cout << "Starting network training iteration " << iteration + 1 << " out of " << arguments.train << "..." << std::endl;
+        // Each step removes another share of the weights and fine-tunes the remaining ones
+        for (std::size_t step = 1; step <= arguments.pruneSteps; step++) {
 
-            trainNetwork(network, inputs, targets);
+            network.prune(arguments.prune * step / arguments.pruneSteps, arguments.pruneGlobal);
+
+            std::cout << "Pruned network to " << network.getSparsity() * 100.0 << " % sparsity (step " << step << " out of " << arguments.pruneSteps << ")" << std::endl;
+
+            for (std::size_t iteration = 0; iteration < arguments.train; iteration++) {
+
+                std::cout << "Starting fine-tuning iteration " << iteration + 1 << " out of " << arguments.train << "..." << std::endl;
+
+                trainNetwork(network, stream, 1, nullptr, false, telemetry.get(), nullptr, (step - 1) * arguments.train + iteration, 0);
+
+                if (telemetry) { telemetry->write(); }
+
+            }
 
             std::cout << "Saving network binary file..." << std::endl;
 
-            std::ofstream outputFile(arguments.network, std::ios::binary);
-            network.save(outputFile);
+            // The network was loaded from this file, so it is only replaced once the new one is complete
+            try {
+
+                Checkpoint::replace(&network, arguments.network);
+
+            } catch (const std::invalid_argument& exception) {
+
+                std::cerr << exception.what() << std::endl;
+                std::exit(1);
+
+            }
+
+        }
+
+        std::cout << "Starting network test..." << std::endl;
+
+        evaluateNetwork(network, *inputs, *targets, arguments.threads);
+
+    } else if (arguments.train) {
+
+        std::unique_ptr<Trainer> trainer;
+
+        // Without a chunk size the stream trains on the mapped files in place
+        DatasetStream stream(*inputs, *targets, arguments.stream, arguments.shuffle, progress.seed);
+
+        if (arguments.threads > 1 || arguments.async) {
+
+            trainer = std::make_unique<Trainer>(&network, arguments.threads);
+
+        }
+
+        std::unique_ptr<Telemetry> telemetry;
+
+        if (!arguments.telemetry.empty()) {
+
+            telemetry = std::make_unique<Telemetry>(&network, trainer.get(), arguments.telemetry, arguments.telemetryInterval);
+
+        }
+
+        // Every iteration ends with a checkpoint, which only has to wait for the disk at the end of training
+        Checkpoint checkpoint(&network, arguments.network, arguments.checkpointSamples, arguments.checkpointInterval, progress.seed);
+
+        try {
+
+            for (std::size_t iteration = progress.iteration; iteration < arguments.train; iteration++) {
+
+                const std::size_t sample = iteration == progress.iteration ? progress.sample : 0;
+
+                if (sample > 0) {
+
+                    std::cout << "Resuming network training iteration " << iteration + 1 << " out of " << arguments.train << " at sample " << sample << "..." << std::endl;
+
+                } else {
+
+                    std::cout << "Starting network training iteration " << iteration + 1 << " out of " << arguments.train << "..." << std::endl;
+
+                }
+
+                trainNetwork(network, stream, arguments.batch, trainer.get(), arguments.async, telemetry.get(), &checkpoint, iteration, sample);
+
+                // Every iteration ends with a record, so short runs get at least one
+                if (telemetry) { telemetry->write(); }
+
+                std::cout << "Saving network binary file..." << std::endl;
+
+                checkpoint.save(iteration + 1, 0);
+
+            }
+
+            checkpoint.wait();
+
+        } catch (const std::invalid_argument& exception) {
+
+            std::cerr << exception.what() << std::endl;
+            std::exit(1);
 
         }
 
     } else {
 
+        const activation::Function output = network.getLayer(network.getLayerCount() - 1)->getActivation();
+
         std::cout << "Starting network test..." << std::endl;
 
-        testNetwork(network, inputs, targets);
+        if (!arguments.quantize.empty()) {
+
+            const std::size_t samples = std::min<std::size_t>(QUANTIZATION_SAMPLES, inputs->getSize());
+
+            std::cout << "Quantising network on " << samples << " calibration samples..." << std::endl;
+
+            std::unique_ptr<NetworkInt8> quantizedNetwork;
+
+            try {
+
+                quantizedNetwork = std::make_unique<NetworkInt8>(&network, *inputs, samples);
+
+            } catch (const std::logic_error& exception) {
+
+                std::cerr << exception.what() << std::endl;
+                std::exit(1);
+
+            }
+
+            std::ofstream quantizedFile(arguments.quantize, std::ios::binary);
+            quantizedNetwork->save(quantizedFile);
+
+            testNetwork(*quantizedNetwork, *inputs, *targets, output, network.getLossFunction());
+
+        } else if (arguments.single) {
+
+            NetworkF32 singlePrecisionNetwork(&network);
+
+            testNetwork(singlePrecisionNetwork, *inputs, *targets, output, network.getLossFunction());
+
+        } else if (Evaluator::isSupported(&network)) {
+
+            evaluateNetwork(network, *inputs, *targets, arguments.threads);
+
+        } else {
+
+            testNetwork(network, *inputs, *targets, output, network.getLossFunction());
+
+        }
 
     }
 
+    saveProfile(arguments.profile);
+
     return 0;
 
 }
\ No newline at end of file
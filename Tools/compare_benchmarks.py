@@ -0,0 +1,61 @@
+import argparse
+import json
+import sys
+
+# Units where a larger value is better, every other unit is a time or a count where less is better
+HIGHER_IS_BETTER = {"samples/s"}
+
+# =================================================================================================
+# Read the results of a JSON benchmark report keyed by name and parameters
+# =================================================================================================
+def read_report(file_path):
+
+    with open(file_path, "r") as file:
+
+        report = json.load(file)
+
+    return {(result["name"], result["parameters"]): result for result in report["benchmarks"]}
+
+# =================================================================================================
+# Get the relative change of a result, positive when the result got better
+# =================================================================================================
+def get_improvement(baseline, current, unit):
+
+    if baseline is None or current is None or baseline == 0: return 0.0
+
+    change = (current - baseline) / abs(baseline)
+
+    return change if unit in HIGHER_IS_BETTER else 0.0 - change
+
+# =================================================================================================
+# Main
+# =================================================================================================
+if __name__ == "__main__":
+
+    parser = argparse.ArgumentParser(description="A script for comparing two JSON reports of the spaghetti neurons benchmark and flagging regressions.")
+
+    parser.add_argument("--baseline", type=str, required=True, help="File path to the report of the earlier commit")
+    parser.add_argument("--current", type=str, required=True, help="File path to the report of the later commit")
+    parser.add_argument("--threshold", type=float, default=0.1, help="Relative change that counts as a regression")
+
+    arguments = parser.parse_args()
+
+    baseline = read_report(arguments.baseline)
+    current = read_report(arguments.current)
+
+    regressions = 0
+
+    for key, result in current.items():
+
+        if key not in baseline: continue
+
+        improvement = get_improvement(baseline[key]["value"], result["value"], result["unit"])
+        regression = improvement < -arguments.threshold
+
+        if regression: regressions += 1
+
+        name = f"{key[0]} ({key[1]})" if key[1] else key[0]
+
+        print(f"{'REGRESSION ' if regression else ''}{name}: {baseline[key]['value']} -> {result['value']} {result['unit']} ({improvement * 100.0:+.1f}%)")
+
+    sys.exit(1 if regressions > 0 else 0)
\ No newline at end of file
@@ -6,7 +6,7 @@ import numpy
 # =================================================================================================
 # Convert the images from the EMNIST handwritten digits dataset binary
 # =================================================================================================
-def convert_images(file_path):
+def convert_images(file_path, legacy):
 
     with open(file_path, "rb") as file:
 
@@ -16,7 +16,7 @@ def convert_images(file_path):
         if magic != 2051: raise ValueError("Invalid magic number for the images file!")
 
         data = numpy.frombuffer(file.read(), dtype=numpy.uint8)
-        data = data.astype(numpy.float64) / 255.0
+        if legacy: data = data.astype(numpy.float64) / 255.0
         data = data.reshape(count, height, width)
         data = data.transpose(0, 2, 1)
         data = data.flatten()
@@ -26,7 +26,7 @@ def convert_images(file_path):
 # =================================================================================================
 # Convert the labels from the EMNIST handwritten digits dataset binary
 # =================================================================================================
-def convert_labels(file_path):
+def convert_labels(file_path, legacy):
 
     with open(file_path, "rb") as file:
 
@@ -35,9 +35,12 @@ def convert_labels(file_path):
 
         if magic != 2049: raise ValueError("Invalid magic number for the labels file!")
 
-        data = numpy.zeros(count * size, dtype=numpy.float64)
         buffer = numpy.frombuffer(file.read(), dtype=numpy.uint8)
 
+        if not legacy: return count, size, buffer
+
+        data = numpy.zeros(count * size, dtype=numpy.float64)
+
         for index in range(count):
 
             offset = buffer[index] + 10 * index
@@ -48,21 +51,26 @@ def convert_labels(file_path):
 # =================================================================================================
 # Write the converted images data to a binary file
 # =================================================================================================
-def write_images(file_path, images_count, images_size, images_data):
+def write_images(file_path, images_count, images_size, images_data, legacy):
 
     with open(file_path, "wb") as file:
 
+        # The compact format stores the raw pixels and the scale that maps them to [0, 1]
+        if not legacy: file.write(b"SNU8")
         file.write(struct.pack("<Q", images_count))
         file.write(struct.pack("<Q", images_size))
+        if not legacy: file.write(struct.pack("<d", 1.0 / 255.0))
         file.write(images_data)
 
 # =================================================================================================
 # Write the converted labels data to a binary file
 # =================================================================================================
-def write_labels(file_path, labels_count, labels_size, labels_data):
+def write_labels(file_path, labels_count, labels_size, labels_data, legacy):
 
     with open(file_path, "wb") as file:
 
+        # The compact format stores one class index per sample instead of a one-hot vector
+        if not legacy: file.write(b"SNCL")
         file.write(struct.pack("<Q", labels_count))
         file.write(struct.pack("<Q", labels_size))
         file.write(labels_data)
@@ -72,12 +80,13 @@ def write_labels(file_path, labels_count, labels_size, labels_data):
 # =================================================================================================
 if __name__ == "__main__":
 
-    parser = argparse.ArgumentParser(description="A script for converting the EMNIST handwritten digit dataset binary files into a format that can be used by the neural network as an input. This will increase the file size significantly!")
+    parser = argparse.ArgumentParser(description="A script for converting the EMNIST handwritten digit dataset binary files into a format that can be used by the neural network as an input. By default pixels are stored as bytes and labels as class indices, use --legacy for the larger double precision format.")
 
     parser.add_argument("--images", type=str, required=True, help="File path to the input EMNIST images binary")
     parser.add_argument("--labels", type=str, required=True, help="File path to the input EMNIST labels binary")
     parser.add_argument("--images-output", type=str, required=False, help="File path to the output images binary")
     parser.add_argument("--labels-output", type=str, required=False, help="File path to the output labels binary")
+    parser.add_argument("--legacy", action="store_true", help="Write double precision images and one-hot labels")
 
     arguments = parser.parse_args()
 
@@ -90,10 +99,10 @@ if __name__ == "__main__":
     arguments.images_output = Path(arguments.images_output)
     arguments.labels_output = Path(arguments.labels_output)
 
-    images_count, images_size, images_data = convert_images(arguments.images)
-    labels_count, labels_size, labels_data = convert_labels(arguments.labels)
+    images_count, images_size, images_data = convert_images(arguments.images, arguments.legacy)
+    labels_count, labels_size, labels_data = convert_labels(arguments.labels, arguments.legacy)
 
     if images_count != labels_count: raise ValueError("Number of images and labels do not match!")
 
-    write_images(arguments.images_output, images_count, images_size, images_data)
-    write_labels(arguments.labels_output, labels_count, labels_size, labels_data)
\ No newline at end of file
+    write_images(arguments.images_output, images_count, images_size, images_data, arguments.legacy)
+    write_labels(arguments.labels_output, labels_count, labels_size, labels_data, arguments.legacy)
\ No newline at end of file
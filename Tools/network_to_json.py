@@ -27,38 +27,143 @@ if __name__ == "__main__":
 
     with open(arguments.input, "rb") as file:
 
-        layers = struct.unpack("<Q", file.read(8))[0]
-        inputs = struct.unpack("<Q", file.read(8))[0]
+        # Version 2 files store dense weight blocks whose connection targets follow from the neuron order,
+        # pruned layers store the input index of each remaining weight and only connections outside of the
+        # weight blocks are stored with their targets
+        if file.read(4) == b"SNV2":
+
+            version, byte_order, flags, layers = struct.unpack("<IIIQ", file.read(20))
+
+            if version != 2 or byte_order != 0x01020304 or flags & ~15: raise ValueError("Unsupported network file!")
+
+            entries = [struct.unpack("<QQQ", file.read(24)) for l in range(layers)]
+            edges = [struct.unpack("<QQ", file.read(16)) for l in range(layers)] if flags & 1 else [(0, 0)] * layers
+            sparse = [struct.unpack("<QQ", file.read(16)) for l in range(layers)] if flags & 2 else [(0, 0)] * layers
+            functions = [struct.unpack("<Q", file.read(8))[0] for l in range(layers)] if flags & 4 else [0] * layers
+
+            # The optimizer state is only needed to resume training, so only the settings are converted
+            if flags & 8:
+
+                method, schedule, warmup, period, steps, decay, momentum, beta1, beta2, epsilon = struct.unpack("<QQQQQddddd", file.read(80))
+
+                network["optimizer"] = {
+                    "method": ["sgd", "momentum", "nesterov", "adam"][method],
+                    "schedule": ["constant", "step", "cosine"][schedule],
+                    "warmup": warmup,
+                    "period": period,
+                    "steps": steps,
+                    "decay": decay,
+                    "momentum": momentum,
+                    "beta1": beta1,
+                    "beta2": beta2,
+                    "epsilon": epsilon
+                }
+
+            # Checkpoints end with the training progress a resumed run continues from
+            file.seek(0, 2)
+
+            if file.tell() >= 72:
+
+                file.seek(-48, 2)
+
+                iteration, sample, seed, samples, loss, magic, version = struct.unpack("<QQQQd4sI", file.read(48))
+
+                if magic == b"SNCP" and version == 2:
+
+                    network["progress"] = {
+                        "iteration": iteration,
+                        "sample": sample,
+                        "seed": seed,
+                        "samples": samples,
+                        "loss": loss
+                    }
+
+            network["layers"].append({
+                "neurons": [{"bias": None, "connections": []}] * entries[0][0]
+            })
+
+            first = 0
+
+            for l in range(1, layers):
+
+                neurons, weights_offset, biases_offset = entries[l]
+                edge_count, edges_offset = edges[l]
+                columns = entries[l - 1][0] if weights_offset else 0
+
+                file.seek(weights_offset)
+                weights = struct.unpack(f"<{neurons * columns}d", file.read(8 * neurons * columns))
+                file.seek(biases_offset)
+                biases = struct.unpack(f"<{neurons}d", file.read(8 * neurons))
+                nonzeros, sparse_offset = sparse[l]
 
-        network["layers"].append({
-            "neurons": [{"bias": None, "connections": []}] * inputs
-        })
+                if sparse_offset:
 
-        for l in range(1, layers):
+                    file.seek(sparse_offset)
+                    sparse_rows = struct.unpack(f"<{neurons + 1}Q", file.read(8 * (neurons + 1)))
+                    sparse_weights = struct.unpack(f"<{nonzeros}d", file.read(8 * nonzeros))
+                    sparse_columns = struct.unpack(f"<{nonzeros}I", file.read(4 * nonzeros))
 
-            layer = {
-                "neurons": []
-            }
+                else:
 
-            for n in range(struct.unpack("<Q", file.read(8))[0]):
+                    sparse_rows, sparse_weights, sparse_columns = [0] * (neurons + 1), [], []
 
-                neuron = {
-                    "bias": struct.unpack("<d", file.read(8))[0],
-                    "connections": []
+                file.seek(edges_offset)
+                rows = struct.unpack(f"<{neurons + 1}Q", file.read(8 * (neurons + 1))) if edge_count else [0] * (neurons + 1)
+                targets = struct.unpack(f"<{edge_count}Q", file.read(8 * edge_count))
+                edge_weights = struct.unpack(f"<{edge_count}d", file.read(8 * edge_count))
+
+                layer = {
+                    "neurons": [{
+                        "bias": biases[n],
+                        "connections": [{"target": first + c, "weight": weights[n * columns + c]} for c in range(columns)] +
+                                       [{"target": first + sparse_columns[e], "weight": sparse_weights[e]} for e in range(sparse_rows[n], sparse_rows[n + 1])] +
+                                       [{"target": targets[e], "weight": edge_weights[e]} for e in range(rows[n], rows[n + 1])]
+                    } for n in range(neurons)]
                 }
 
-                for c in range(struct.unpack("<Q", file.read(8))[0]):
+                # Networks of sigmoid layers leave out the activation table, so only the others are named
+                if flags & 4: layer["activation"] = ["sigmoid", "relu", "leaky-relu", "tanh", "softmax"][functions[l]]
+
+                network["layers"].append(layer)
+
+                first += entries[l - 1][0]
+
+        else:
+
+            file.seek(0)
+
+            layers = struct.unpack("<Q", file.read(8))[0]
+            inputs = struct.unpack("<Q", file.read(8))[0]
+
+            network["layers"].append({
+                "neurons": [{"bias": None, "connections": []}] * inputs
+            })
 
-                    connection = {
-                        "target": struct.unpack("<Q", file.read(8))[0],
-                        "weight": struct.unpack("<d", file.read(8))[0]
+            for l in range(1, layers):
+
+                layer = {
+                    "neurons": []
+                }
+
+                for n in range(struct.unpack("<Q", file.read(8))[0]):
+
+                    neuron = {
+                        "bias": struct.unpack("<d", file.read(8))[0],
+                        "connections": []
                     }
 
-                    neuron["connections"].append(connection)
+                    for c in range(struct.unpack("<Q", file.read(8))[0]):
+
+                        connection = {
+                            "target": struct.unpack("<Q", file.read(8))[0],
+                            "weight": struct.unpack("<d", file.read(8))[0]
+                        }
+
+                        neuron["connections"].append(connection)
 
-                layer["neurons"].append(neuron)
+                    layer["neurons"].append(neuron)
 
-            network["layers"].append(layer)
+                network["layers"].append(layer)
 
     with open(arguments.output, "w") as file:
 
@@ -0,0 +1,140 @@
+import argparse
+from pathlib import Path
+import struct
+import array
+
+MAGIC = b"SNV2"
+VERSION = 2
+BYTE_ORDER = 0x01020304
+ALIGNMENT = 64
+
+# =================================================================================================
+# Round an offset up to the alignment of the weight and bias blocks
+# =================================================================================================
+def align(offset):
+
+    return (offset + ALIGNMENT - 1) // ALIGNMENT * ALIGNMENT
+
+# =================================================================================================
+# Read a network from the legacy binary file format, keeping the connections of sparse layers
+# =================================================================================================
+def read_legacy(file_path):
+
+    with open(file_path, "rb") as file:
+
+        if file.read(4) == MAGIC: raise ValueError("The network file is already in the version 2 format!")
+
+        file.seek(0)
+
+        layers = struct.unpack("<Q", file.read(8))[0]
+        topology = [struct.unpack("<Q", file.read(8))[0]]
+        weights = [None]
+        biases = [None]
+        edges = [None]
+        first = 0
+
+        for l in range(1, layers):
+
+            neurons = struct.unpack("<Q", file.read(8))[0]
+            columns = topology[-1]
+            rows = array.array("Q", [0])
+            targets = array.array("Q")
+            layer_weights = array.array("d")
+            layer_biases = array.array("d")
+            dense = True
+
+            for n in range(neurons):
+
+                bias, connections = struct.unpack("<dQ", file.read(16))
+
+                # Like the network loader, a layer is dense if every neuron, including ones without any
+                # connection, is connected to every input in order
+                dense = dense and connections == columns
+
+                for c, (target, weight) in enumerate(struct.iter_unpack("<Qd", file.read(16 * connections))):
+
+                    dense = dense and target == first + c
+
+                    targets.append(target)
+                    layer_weights.append(weight)
+
+                rows.append(len(targets))
+                layer_biases.append(bias)
+
+            topology.append(neurons)
+            weights.append(layer_weights if dense else None)
+            biases.append(layer_biases)
+            edges.append(None if dense else (rows, targets, layer_weights))
+            first += columns
+
+    return topology, weights, biases, edges
+
+# =================================================================================================
+# Write a network in the version 2 format with aligned contiguous weight, bias and edge blocks
+# =================================================================================================
+def write_v2(file_path, topology, weights, biases, edges):
+
+    sparse = any(edges[l] is not None for l in range(1, len(topology)))
+    offset = 24 + 24 * len(topology) + (16 * len(topology) if sparse else 0)
+    entries = [(topology[0], 0, 0)]
+    edge_entries = [(0, 0)]
+
+    for l in range(1, len(topology)):
+
+        weights_offset = align(offset) if edges[l] is None else 0
+        offset = weights_offset + 8 * len(weights[l]) if edges[l] is None else offset
+        biases_offset = align(offset)
+        offset = biases_offset + 8 * len(biases[l])
+        edge_count = 0 if edges[l] is None else len(edges[l][1])
+        edges_offset = align(offset) if edge_count else 0
+        offset = edges_offset + 8 * (topology[l] + 1) + 16 * edge_count if edge_count else offset
+        entries.append((topology[l], weights_offset, biases_offset))
+        edge_entries.append((edge_count, edges_offset))
+
+    with open(file_path, "wb") as file:
+
+        file.write(MAGIC + struct.pack("<IIIQ", VERSION, BYTE_ORDER, 1 if sparse else 0, len(topology)))
+
+        for entry in entries: file.write(struct.pack("<QQQ", *entry))
+
+        if sparse:
+
+            for entry in edge_entries: file.write(struct.pack("<QQ", *entry))
+
+        for l in range(1, len(topology)):
+
+            if entries[l][1]:
+
+                file.write(b"\0" * (entries[l][1] - file.tell()))
+                file.write(weights[l].tobytes())
+
+            file.write(b"\0" * (entries[l][2] - file.tell()))
+            file.write(biases[l].tobytes())
+
+            if edge_entries[l][0]:
+
+                file.write(b"\0" * (edge_entries[l][1] - file.tell()))
+
+                for block in edges[l]: file.write(block.tobytes())
+
+# =================================================================================================
+# Main
+# =================================================================================================
+if __name__ == "__main__":
+
+    parser = argparse.ArgumentParser(description="A script for converting a legacy spaghetti neurons binary file (.sn) to the memory mappable version 2 format.")
+
+    parser.add_argument("--input", type=str, required=True, help="File path to the input legacy binary file")
+    parser.add_argument("--output", type=str, required=False, help="File path to the output version 2 binary file")
+
+    arguments = parser.parse_args()
+
+    arguments.input = Path(arguments.input)
+
+    if arguments.output is None: arguments.output = f"{arguments.input.stem}_v2.sn"
+
+    arguments.output = Path(arguments.output)
+
+    topology, weights, biases, edges = read_legacy(arguments.input)
+
+    write_v2(arguments.output, topology, weights, biases, edges)
\ No newline at end of file